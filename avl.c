@@ -4,16 +4,26 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <stdalign.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "counters.h"
 #include "layout.h"
 #include "math.h"
+#include "task.h"
 #include "traits/assign.h"
+#include "traits/augment.h"
+#include "traits/compare.h"
 #include "traits/destroy.h"
+#include "traits/reduce.h"
+
+
+/// @brief The depth down to which parallel traversals split the tree into tasks (at most 2^depth leaf tasks).
+#define HLC_AVL_PARALLEL_DEPTH 10
 
 
 struct hlc_AVL {
@@ -30,28 +40,45 @@ struct hlc_AVL {
 )
 
 
+static size_t hlc_avl_element_offset(hlc_Layout element_layout) {
+  hlc_Layout node_layout = {.size = offsetof(hlc_AVL, balance) + sizeof(signed char), .alignment = alignof(hlc_AVL)};
+  return hlc_layout_add(&node_layout, element_layout);
+}
+
+
+hlc_Layout hlc_avl_layout(hlc_Layout element_layout) {
+  hlc_Layout node_layout = {.size = offsetof(hlc_AVL, balance) + sizeof(signed char), .alignment = alignof(hlc_AVL)};
+  hlc_layout_add(&node_layout, element_layout);
+  hlc_layout_pad(&node_layout);
+  return node_layout;
+}
+
+
 hlc_AVL* hlc_avl_new(
   const void* element,
   hlc_Layout element_layout,
   hlc_Assign_instance element_assign_instance
 ) {
-  hlc_Layout node_layout = {.size = offsetof(hlc_AVL, balance) + sizeof(signed char), .alignment = alignof(hlc_AVL)};
-  size_t element_offset = hlc_layout_add(&node_layout, element_layout);
-  hlc_layout_pad(&node_layout);
+  hlc_Layout node_layout = hlc_avl_layout(element_layout);
+  size_t element_offset = hlc_avl_element_offset(element_layout);
 
   hlc_AVL* node = malloc(node_layout.size);
 
   if (node != NULL) {
+    HLC_COUNT_CURRENT(allocations);
     HLC_AVL_LINKS(node)[-1] = NULL;
     HLC_AVL_LINKS(node)[+1] = NULL;
     HLC_AVL_LINKS(node)[0] = NULL;
     node->direction = -1;
     node->balance = 0;
 
-    if (hlc_assign((char*)node + element_offset, element, element_assign_instance)) {
+    HLC_COUNT_CURRENT(assigns);
+
+    if (hlc_assign_sized((char*)node + element_offset, element, element_layout.size, element_assign_instance)) {
       return node;
     } else {
       free(node);
+      HLC_COUNT_CURRENT(frees);
     }
   }
 
@@ -65,7 +92,51 @@ size_t hlc_avl_count(const hlc_AVL* root) {
 
 
 size_t hlc_avl_height(const hlc_AVL* root) {
-  return root == NULL ? 0 : HLC_MAX(hlc_avl_height(HLC_AVL_LINKS(root)[-1]), hlc_avl_height(HLC_AVL_LINKS(root)[+1])) + 1;
+  size_t height = 0;
+
+  while (root != NULL) {
+    height += 1;
+    root = HLC_AVL_LINKS(root)[root->balance > 0 ? +1 : -1];
+  }
+
+  return height;
+}
+
+
+size_t hlc_avl_depth_sum(const hlc_AVL* root) {
+  if (root == NULL)
+    return 0;
+
+  // Depth-first, pushing right children below left ones: the stack never holds more than one node per level.
+
+  struct {
+    const hlc_AVL* node;
+    size_t depth;
+  } stack[HLC_AVL_MAX_HEIGHT + 1];
+
+  size_t stack_count = 1;
+  size_t depth_sum = 0;
+
+  stack[0].node = root;
+  stack[0].depth = 1;
+
+  while (stack_count > 0) {
+    stack_count -= 1;
+    const hlc_AVL* node = stack[stack_count].node;
+    size_t depth = stack[stack_count].depth;
+    depth_sum += depth;
+
+    for (signed char direction = +1; direction >= -1; direction -= 2) {
+      if (HLC_AVL_LINKS(node)[direction] != NULL) {
+        assert(stack_count <= HLC_AVL_MAX_HEIGHT);
+        stack[stack_count].node = HLC_AVL_LINKS(node)[direction];
+        stack[stack_count].depth = depth + 1;
+        stack_count += 1;
+      }
+    }
+  }
+
+  return depth_sum;
 }
 
 
@@ -79,11 +150,13 @@ hlc_AVL* (hlc_avl_link)(const hlc_AVL* node, signed char direction) {
 
 void* (hlc_avl_element)(const hlc_AVL* node, hlc_Layout element_layout) {
   assert(node != NULL);
+  return (char*)node + hlc_avl_element_offset(element_layout);
+}
 
-  hlc_Layout node_layout = {.size = offsetof(hlc_AVL, balance) + sizeof(signed char), .alignment = alignof(hlc_AVL)};
-  size_t element_offset = hlc_layout_add(&node_layout, element_layout);
 
-  return (char*)node + element_offset;
+hlc_AVL* (hlc_avl_node)(const void* element, hlc_Layout element_layout) {
+  assert(element != NULL);
+  return (hlc_AVL*)((char*)element - hlc_avl_element_offset(element_layout));
 }
 
 
@@ -125,6 +198,496 @@ hlc_AVL* (hlc_avl_xcessor)(const hlc_AVL* node, signed char direction) {
 }
 
 
+hlc_AVL* (hlc_avl_search)(
+  const hlc_AVL* root,
+  hlc_Layout element_layout,
+  const void* key,
+  size_t key_offset,
+  hlc_Compare_instance key_compare_instance,
+  signed char* ordering
+) {
+  assert(ordering != NULL);
+
+  key_offset += hlc_avl_element_offset(element_layout);
+  *ordering = 0;
+
+  while (root != NULL) {
+    *ordering = hlc_compare(key, (const char*)root + key_offset, key_compare_instance);
+
+    if (*ordering == 0 || HLC_AVL_LINKS(root)[*ordering] == NULL)
+      return (hlc_AVL*)root;
+
+    root = HLC_AVL_LINKS(root)[*ordering];
+  }
+
+  return NULL;
+}
+
+
+/// @brief Copies a node and its children, but not its descendants.
+/// @return The copy, or NULL on insufficient memory.
+static hlc_AVL* hlc_avl_clone_node(
+  const hlc_AVL* node,
+  size_t element_offset,
+  hlc_Layout element_layout,
+  hlc_Assign_instance element_assign_instance
+) {
+  hlc_AVL* clone = hlc_avl_new((const char*)node + element_offset, element_layout, element_assign_instance);
+
+  if (clone != NULL) {
+    clone->direction = node->direction;
+    clone->balance = node->balance;
+  }
+
+  return clone;
+}
+
+
+/// @brief Attaches a subtree as the left/right child of a node.
+static void hlc_avl_attach(hlc_AVL* node, signed char direction, hlc_AVL* child) {
+  HLC_AVL_LINKS(node)[direction] = child;
+
+  if (child != NULL) {
+    HLC_AVL_LINKS(child)[0] = node;
+    child->direction = direction;
+  }
+}
+
+
+static hlc_AVL* hlc_avl_clone_subtree(
+  const hlc_AVL* node,
+  size_t element_offset,
+  hlc_Layout element_layout,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Destroy_instance element_destroy_instance
+) {
+  hlc_AVL* clone = hlc_avl_clone_node(node, element_offset, element_layout, element_assign_instance);
+
+  if (clone == NULL)
+    return NULL;
+
+  for (signed char direction = -1; direction <= +1; direction += 2) {
+    const hlc_AVL* child = HLC_AVL_LINKS(node)[direction];
+
+    if (child != NULL) {
+      hlc_AVL* child_clone = hlc_avl_clone_subtree(
+        child,
+        element_offset,
+        element_layout,
+        element_assign_instance,
+        element_destroy_instance
+      );
+
+      if (child_clone == NULL) {
+        hlc_avl_delete(clone, element_layout, element_destroy_instance);
+        return NULL;
+      }
+
+      hlc_avl_attach(clone, direction, child_clone);
+    }
+  }
+
+  return clone;
+}
+
+
+bool hlc_avl_clone(
+  const hlc_AVL* root,
+  hlc_AVL** clone,
+  hlc_Layout element_layout,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Destroy_instance element_destroy_instance
+) {
+  assert(clone != NULL);
+
+  if (root == NULL) {
+    *clone = NULL;
+    return true;
+  }
+
+  size_t element_offset = hlc_avl_element_offset(element_layout);
+  *clone = hlc_avl_clone_subtree(
+    root,
+    element_offset,
+    element_layout,
+    element_assign_instance,
+    element_destroy_instance
+  );
+
+  if (*clone == NULL)
+    return false;
+
+  HLC_AVL_LINKS(*clone)[0] = NULL;
+  (*clone)->direction = -1;
+  return true;
+}
+
+
+typedef struct hlc_AVL_parallel_clone_context {
+  hlc_Layout element_layout;
+  size_t element_offset;
+  hlc_Assign_instance element_assign_instance;
+  hlc_Destroy_instance element_destroy_instance;
+} hlc_AVL_parallel_clone_context;
+
+
+typedef struct hlc_AVL_parallel_clone_task {
+  const hlc_AVL* root;
+  size_t depth;
+  bool success;
+  hlc_AVL* clone;
+  const hlc_AVL_parallel_clone_context* context;
+} hlc_AVL_parallel_clone_task;
+
+
+static void hlc_avl_parallel_clone_run(hlc_Task_worker* worker, void* _task) {
+  hlc_AVL_parallel_clone_task* task = _task;
+  const hlc_AVL_parallel_clone_context* context = task->context;
+  const hlc_AVL* root = task->root;
+
+  if (root == NULL) {
+    task->clone = NULL;
+    task->success = true;
+    return;
+  }
+
+  if (task->depth >= HLC_AVL_PARALLEL_DEPTH) {
+    task->clone = hlc_avl_clone_subtree(
+      root,
+      context->element_offset,
+      context->element_layout,
+      context->element_assign_instance,
+      context->element_destroy_instance
+    );
+
+    task->success = task->clone != NULL;
+    return;
+  }
+
+  hlc_AVL_parallel_clone_task left = {.root = HLC_AVL_LINKS(root)[-1], .depth = task->depth + 1, .context = context};
+  hlc_AVL_parallel_clone_task right = {.root = HLC_AVL_LINKS(root)[+1], .depth = task->depth + 1, .context = context};
+  hlc_task_join(worker, hlc_avl_parallel_clone_run, &left, hlc_avl_parallel_clone_run, &right);
+
+  task->clone = NULL;
+
+  if (left.success && right.success) {
+    task->clone = hlc_avl_clone_node(
+      root,
+      context->element_offset,
+      context->element_layout,
+      context->element_assign_instance
+    );
+  }
+
+  if (task->clone == NULL) {
+    hlc_avl_delete(left.success ? left.clone : NULL, context->element_layout, context->element_destroy_instance);
+    hlc_avl_delete(right.success ? right.clone : NULL, context->element_layout, context->element_destroy_instance);
+    task->success = false;
+    return;
+  }
+
+  hlc_avl_attach(task->clone, -1, left.clone);
+  hlc_avl_attach(task->clone, +1, right.clone);
+  task->success = true;
+}
+
+
+bool hlc_avl_parallel_clone(
+  const hlc_AVL* root,
+  hlc_AVL** clone,
+  hlc_Layout element_layout,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Destroy_instance element_destroy_instance,
+  hlc_Task_pool* pool
+) {
+  assert(clone != NULL);
+  assert(pool != NULL);
+
+  hlc_AVL_parallel_clone_context clone_context = {
+    .element_layout = element_layout,
+    .element_offset = hlc_avl_element_offset(element_layout),
+    .element_assign_instance = element_assign_instance,
+    .element_destroy_instance = element_destroy_instance,
+  };
+
+  hlc_AVL_parallel_clone_task task = {.root = root, .depth = 0, .context = &clone_context};
+  hlc_task_pool_run(pool, hlc_avl_parallel_clone_run, &task);
+
+  if (!task.success) {
+    *clone = NULL;
+    return false;
+  }
+
+  if (task.clone != NULL) {
+    HLC_AVL_LINKS(task.clone)[0] = NULL;
+    task.clone->direction = -1;
+  }
+
+  *clone = task.clone;
+  return true;
+}
+
+
+bool hlc_avl_for_each(
+  const hlc_AVL* root,
+  hlc_Layout element_layout,
+  bool (*visit)(const void* element, void* context),
+  void* context
+) {
+  assert(visit != NULL);
+
+  size_t element_offset = hlc_avl_element_offset(element_layout);
+  const hlc_AVL* path[HLC_AVL_MAX_HEIGHT];
+  size_t depth = 0;
+  const hlc_AVL* node = root;
+
+  while (true) {
+    while (node != NULL) {
+      assert(depth < HLC_AVL_MAX_HEIGHT);
+      path[depth++] = node;
+      node = HLC_AVL_LINKS(node)[-1];
+    }
+
+    if (depth == 0)
+      return true;
+
+    node = path[--depth];
+
+    if (!visit((const char*)node + element_offset, context))
+      return false;
+
+    node = HLC_AVL_LINKS(node)[+1];
+  }
+}
+
+
+typedef struct hlc_AVL_parallel_for_each_context {
+  hlc_Layout element_layout;
+  size_t element_offset;
+  bool (*visit)(const void* element, void* context);
+  void* context;
+  atomic_bool stopped;
+} hlc_AVL_parallel_for_each_context;
+
+
+typedef struct hlc_AVL_parallel_for_each_task {
+  const hlc_AVL* root;
+  size_t depth;
+  hlc_AVL_parallel_for_each_context* context;
+} hlc_AVL_parallel_for_each_task;
+
+
+static bool hlc_avl_parallel_visit(const void* element, void* _context) {
+  hlc_AVL_parallel_for_each_context* context = _context;
+
+  if (atomic_load_explicit(&context->stopped, memory_order_relaxed))
+    return false;
+
+  if (!context->visit(element, context->context)) {
+    atomic_store_explicit(&context->stopped, true, memory_order_relaxed);
+    return false;
+  }
+
+  return true;
+}
+
+
+static void hlc_avl_parallel_for_each_run(hlc_Task_worker* worker, void* _task) {
+  const hlc_AVL_parallel_for_each_task* task = _task;
+  hlc_AVL_parallel_for_each_context* context = task->context;
+  const hlc_AVL* root = task->root;
+
+  if (root == NULL || task->depth >= HLC_AVL_PARALLEL_DEPTH) {
+    hlc_avl_for_each(root, context->element_layout, hlc_avl_parallel_visit, context);
+    return;
+  }
+
+  if (!hlc_avl_parallel_visit((const char*)root + context->element_offset, context))
+    return;
+
+  size_t depth = task->depth + 1;
+  hlc_AVL_parallel_for_each_task left = {.root = HLC_AVL_LINKS(root)[-1], .depth = depth, .context = context};
+  hlc_AVL_parallel_for_each_task right = {.root = HLC_AVL_LINKS(root)[+1], .depth = depth, .context = context};
+  hlc_task_join(worker, hlc_avl_parallel_for_each_run, &left, hlc_avl_parallel_for_each_run, &right);
+}
+
+
+bool hlc_avl_parallel_for_each(
+  const hlc_AVL* root,
+  hlc_Layout element_layout,
+  hlc_Task_pool* pool,
+  bool (*visit)(const void* element, void* context),
+  void* context
+) {
+  assert(pool != NULL);
+  assert(visit != NULL);
+
+  hlc_AVL_parallel_for_each_context for_each_context = {
+    .element_layout = element_layout,
+    .element_offset = hlc_avl_element_offset(element_layout),
+    .visit = visit,
+    .context = context,
+  };
+
+  atomic_init(&for_each_context.stopped, false);
+
+  hlc_AVL_parallel_for_each_task task = {.root = root, .depth = 0, .context = &for_each_context};
+  hlc_task_pool_run(pool, hlc_avl_parallel_for_each_run, &task);
+  return !atomic_load(&for_each_context.stopped);
+}
+
+
+typedef struct hlc_AVL_parallel_reduce_context {
+  hlc_Layout element_layout;
+  size_t element_offset;
+  hlc_Layout accumulator_layout;
+  hlc_Reduce_instance reduce_instance;
+} hlc_AVL_parallel_reduce_context;
+
+
+typedef struct hlc_AVL_parallel_reduce_task {
+  const hlc_AVL* root;
+  size_t depth;
+  void* accumulator;
+  const hlc_AVL_parallel_reduce_context* context;
+} hlc_AVL_parallel_reduce_task;
+
+
+static bool hlc_avl_reduce_visit(const void* element, void* _task) {
+  const hlc_AVL_parallel_reduce_task* task = _task;
+  hlc_reduce_accumulate(task->accumulator, element, task->context->reduce_instance);
+  return true;
+}
+
+
+static void hlc_avl_parallel_reduce_run(hlc_Task_worker* worker, void* _task) {
+  const hlc_AVL_parallel_reduce_task* task = _task;
+  const hlc_AVL_parallel_reduce_context* context = task->context;
+  const hlc_AVL* root = task->root;
+
+  if (root == NULL || task->depth >= HLC_AVL_PARALLEL_DEPTH) {
+    hlc_avl_for_each(root, context->element_layout, hlc_avl_reduce_visit, (void*)task);
+    return;
+  }
+
+  // The left subtree is reduced into the accumulator of this task, and the right subtree into a new one. If the new
+  // accumulator can't be created, the whole subtree is reduced sequentially, which gives the same result as long as
+  // the reduction is associative.
+
+  void* other = malloc(context->accumulator_layout.size);
+
+  if (other == NULL || !hlc_reduce_initialize(other, context->reduce_instance)) {
+    free(other);
+    hlc_avl_for_each(root, context->element_layout, hlc_avl_reduce_visit, (void*)task);
+    return;
+  }
+
+  hlc_AVL_parallel_reduce_task left = {
+    .root = HLC_AVL_LINKS(root)[-1],
+    .depth = task->depth + 1,
+    .accumulator = task->accumulator,
+    .context = context,
+  };
+
+  hlc_AVL_parallel_reduce_task right = {
+    .root = HLC_AVL_LINKS(root)[+1],
+    .depth = task->depth + 1,
+    .accumulator = other,
+    .context = context,
+  };
+
+  hlc_task_join(worker, hlc_avl_parallel_reduce_run, &left, hlc_avl_parallel_reduce_run, &right);
+
+  hlc_reduce_accumulate(task->accumulator, (const char*)root + context->element_offset, context->reduce_instance);
+  hlc_reduce_combine(task->accumulator, other, context->reduce_instance);
+  free(other);
+}
+
+
+bool hlc_avl_parallel_reduce(
+  const hlc_AVL* root,
+  hlc_Layout element_layout,
+  hlc_Task_pool* pool,
+  void* accumulator,
+  hlc_Layout accumulator_layout,
+  hlc_Reduce_instance reduce_instance
+) {
+  assert(pool != NULL);
+  assert(accumulator != NULL);
+
+  if (!hlc_reduce_initialize(accumulator, reduce_instance))
+    return false;
+
+  hlc_AVL_parallel_reduce_context reduce_context = {
+    .element_layout = element_layout,
+    .element_offset = hlc_avl_element_offset(element_layout),
+    .accumulator_layout = accumulator_layout,
+    .reduce_instance = reduce_instance,
+  };
+
+  hlc_AVL_parallel_reduce_task task = {
+    .root = root,
+    .depth = 0,
+    .accumulator = accumulator,
+    .context = &reduce_context,
+  };
+  hlc_task_pool_run(pool, hlc_avl_parallel_reduce_run, &task);
+  return true;
+}
+
+
+/// @brief The augmentation kept current by a structural change, with the offset of the elements in the nodes.
+typedef struct hlc_AVL_augment {
+  size_t element_offset;
+  hlc_Augment_instance instance;
+} hlc_AVL_augment;
+
+
+/// @brief Updates the augmented data of a node from its children.
+/// @return true if the data changed, false if it was already current.
+static bool hlc_avl_augment_node(hlc_AVL* node, const hlc_AVL_augment* augment) {
+  assert(node != NULL);
+  assert(augment != NULL);
+
+  const hlc_AVL* node_left = HLC_AVL_LINKS(node)[-1];
+  const hlc_AVL* node_right = HLC_AVL_LINKS(node)[+1];
+
+  return hlc_augment_update(
+    (char*)node + augment->element_offset,
+    node_left != NULL ? (const char*)node_left + augment->element_offset : NULL,
+    node_right != NULL ? (const char*)node_right + augment->element_offset : NULL,
+    augment->instance
+  );
+}
+
+
+/// @brief Updates the augmented data of the nodes from node up to the root, before rebalancing.
+/// @details The data of a node which was created or moved has no meaning yet, so every node up to top is updated.
+/// Above it, nodes kept their place and only their subtrees changed, so the climb stops at the first node whose data
+/// is already current.
+/// @param top The topmost node which was created or moved, which must be node or one of its ancestors, or NULL.
+static void hlc_avl_augment_path(hlc_AVL* node, const hlc_AVL* top, const hlc_AVL_augment* augment) {
+  if (augment == NULL)
+    return;
+
+  bool top_passed = top == NULL;
+
+  while (node != NULL) {
+    bool changed = hlc_avl_augment_node(node, augment);
+
+    if (top_passed && !changed)
+      break;
+
+    top_passed |= node == top;
+    node = HLC_AVL_LINKS(node)[0];
+  }
+}
+
+
+#ifndef NDEBUG
+
+/// @brief Checks the balance factors and links of a subtree, in O(n) time, for assertions.
+/// @return The height of the subtree.
 static size_t hlc_avl_check(const hlc_AVL* node) {
   if (node != NULL) {
     const hlc_AVL* node_left = HLC_AVL_LINKS(node)[-1];
@@ -143,9 +706,12 @@ static size_t hlc_avl_check(const hlc_AVL* node) {
   }
 }
 
+#endif
 
-static hlc_AVL* hlc_avl_rotate_left(hlc_AVL* x) {
+
+static hlc_AVL* hlc_avl_rotate_left(hlc_AVL* x, const hlc_AVL_augment* augment) {
   assert(x != NULL && HLC_AVL_LINKS(x)[+1] != NULL);
+  HLC_COUNT_CURRENT(rotations);
 
   //   X              Y
   //  / \            / \
@@ -196,12 +762,21 @@ static hlc_AVL* hlc_avl_rotate_left(hlc_AVL* x) {
   y->direction = x_direction;
   y->balance = y_balance - HLC_MAX(1 - x->balance, 1);
 
+  // Subtrees a, b and c are unchanged, so X is updated from them first, and Y from X, while the ancestors of Y still
+  // cover the same elements:
+
+  if (augment != NULL) {
+    hlc_avl_augment_node(x, augment);
+    hlc_avl_augment_node(y, augment);
+  }
+
   return y;
 }
 
 
-static hlc_AVL* hlc_avl_rotate_right(hlc_AVL* y) {
+static hlc_AVL* hlc_avl_rotate_right(hlc_AVL* y, const hlc_AVL_augment* augment) {
   assert(y != NULL && HLC_AVL_LINKS(y)[-1] != NULL);
+  HLC_COUNT_CURRENT(rotations);
 
   //     Y          X
   //    / \        / \
@@ -252,11 +827,16 @@ static hlc_AVL* hlc_avl_rotate_right(hlc_AVL* y) {
   x->direction = y_direction;
   x->balance = x_balance + HLC_MAX(1, 1 + y->balance);
 
+  if (augment != NULL) {
+    hlc_avl_augment_node(y, augment);
+    hlc_avl_augment_node(x, augment);
+  }
+
   return x;
 }
 
 
-static hlc_AVL* hlc_avl_rebalance(hlc_AVL* node) {
+static hlc_AVL* hlc_avl_rebalance(hlc_AVL* node, const hlc_AVL_augment* augment) {
   assert(node != NULL);
 
   if (node->balance < -1) {
@@ -269,7 +849,7 @@ static hlc_AVL* hlc_avl_rebalance(hlc_AVL* node) {
       //  \        /
       //   Y      X
 
-      HLC_AVL_LINKS(node)[-1] = hlc_avl_rotate_left(HLC_AVL_LINKS(node)[-1]);
+      HLC_AVL_LINKS(node)[-1] = hlc_avl_rotate_left(HLC_AVL_LINKS(node)[-1], augment);
     }
 
     //     N
@@ -278,7 +858,7 @@ static hlc_AVL* hlc_avl_rebalance(hlc_AVL* node) {
     //  /         X   N
     // X
 
-    node = hlc_avl_rotate_right(node);
+    node = hlc_avl_rotate_right(node, augment);
 
     if (HLC_AVL_LINKS(node)[0] != NULL) {
       assert(node->direction == -1 || node->direction == +1);
@@ -294,7 +874,7 @@ static hlc_AVL* hlc_avl_rebalance(hlc_AVL* node) {
       //  /          \
       // X            Y
 
-      HLC_AVL_LINKS(node)[+1] = hlc_avl_rotate_right(HLC_AVL_LINKS(node)[+1]);
+      HLC_AVL_LINKS(node)[+1] = hlc_avl_rotate_right(HLC_AVL_LINKS(node)[+1], augment);
     }
 
     // N
@@ -303,7 +883,7 @@ static hlc_AVL* hlc_avl_rebalance(hlc_AVL* node) {
     //    \       N   Y
     //     Y
 
-    node = hlc_avl_rotate_left(node);
+    node = hlc_avl_rotate_left(node, augment);
 
     if (HLC_AVL_LINKS(node)[0] != NULL) {
       assert(node->direction == -1 || node->direction == +1);
@@ -311,22 +891,23 @@ static hlc_AVL* hlc_avl_rebalance(hlc_AVL* node) {
     }
   }
 
-  hlc_avl_check(node);
   return node;
 }
 
 
 /// @param node The node which was inserted.
 /// @return The new root of the subtree where the node was inserted, after rebalancing.
-static hlc_AVL* hlc_avl_update_after_insertion(hlc_AVL* node) {
+static hlc_AVL* hlc_avl_update_after_insertion(hlc_AVL* node, const hlc_AVL_augment* augment) {
   assert(node != NULL);
 
   while (HLC_AVL_LINKS(node)[0] != NULL) {
+    HLC_COUNT_CURRENT(rebalance_iterations);
     assert(node->direction == -1 || node->direction == +1);
     HLC_AVL_LINKS(node)[0]->balance += node->direction;
 
     node = HLC_AVL_LINKS(node)[0];
-    node = hlc_avl_rebalance(node);
+    node = hlc_avl_rebalance(node, augment);
+    assert(hlc_avl_check(node) <= HLC_AVL_MAX_HEIGHT);
 
     if (node->balance == 0)
       break;
@@ -340,15 +921,21 @@ static hlc_AVL* hlc_avl_update_after_insertion(hlc_AVL* node) {
 /// @param node The parent of the node which was removed. The balance of said parent must already have been updated.
 /// @param root The ancestor to be returned if this function returns early.
 /// @return The new root of the subtree where the node was removed, after rebalancing.
-static hlc_AVL* hlc_avl_update_after_removal(hlc_AVL* node, hlc_AVL* ancestor) {
+static hlc_AVL* hlc_avl_update_after_removal(
+  hlc_AVL* node,
+  hlc_AVL* ancestor,
+  const hlc_AVL_augment* augment
+) {
   assert(node != NULL);
   assert(ancestor != NULL);
 
   bool ancestor_found = false;
 
   while (true) {
+    HLC_COUNT_CURRENT(rebalance_iterations);
     ancestor_found |= node == ancestor;
-    node = hlc_avl_rebalance(node);
+    node = hlc_avl_rebalance(node, augment);
+    assert(hlc_avl_check(node) <= HLC_AVL_MAX_HEIGHT);
 
     if (node->balance != 0 || HLC_AVL_LINKS(node)[0] == NULL)
       break;
@@ -364,12 +951,13 @@ static hlc_AVL* hlc_avl_update_after_removal(hlc_AVL* node, hlc_AVL* ancestor) {
 }
 
 
-hlc_AVL* hlc_avl_insert(
+static hlc_AVL* hlc_avl_insert_augmenting(
   hlc_AVL* node,
   signed char direction,
   const void* element,
   hlc_Layout element_layout,
-  hlc_Assign_instance element_assign_instance
+  hlc_Assign_instance element_assign_instance,
+  const hlc_AVL_augment* augment
 ) {
   assert(node != NULL);
   assert(direction == -1 || direction == +1);
@@ -381,17 +969,47 @@ hlc_AVL* hlc_avl_insert(
     HLC_AVL_LINKS(node)[direction] = new;
     HLC_AVL_LINKS(new)[0] = node;
     new->direction = direction;
-    return hlc_avl_update_after_insertion(new);
+    hlc_avl_augment_path(new, new, augment);
+    return hlc_avl_update_after_insertion(new, augment);
   } else {
     return NULL;
   }
 }
 
 
-hlc_AVL* hlc_avl_remove(
+hlc_AVL* hlc_avl_insert(
   hlc_AVL* node,
+  signed char direction,
+  const void* element,
   hlc_Layout element_layout,
-  hlc_Destroy_instance element_destroy_instance
+  hlc_Assign_instance element_assign_instance
+) {
+  return hlc_avl_insert_augmenting(node, direction, element, element_layout, element_assign_instance, NULL);
+}
+
+
+hlc_AVL* hlc_avl_insert_augmented(
+  hlc_AVL* node,
+  signed char direction,
+  const void* element,
+  hlc_Layout element_layout,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Augment_instance augment_instance
+) {
+  hlc_AVL_augment augment = {
+    .element_offset = hlc_avl_element_offset(element_layout),
+    .instance = augment_instance,
+  };
+
+  return hlc_avl_insert_augmenting(node, direction, element, element_layout, element_assign_instance, &augment);
+}
+
+
+static hlc_AVL* hlc_avl_remove_augmenting(
+  hlc_AVL* node,
+  hlc_Layout element_layout,
+  hlc_Destroy_instance element_destroy_instance,
+  const hlc_AVL_augment* augment
 ) {
   assert(node != NULL);
 
@@ -405,6 +1023,7 @@ hlc_AVL* hlc_avl_remove(
     signed char node_direction = node->direction;
     hlc_destroy(hlc_avl_element(node, element_layout), element_destroy_instance);
     free(node);
+    HLC_COUNT_CURRENT(frees);
 
     if (a != NULL) {
       HLC_AVL_LINKS(a)[0] = node_parent;
@@ -415,7 +1034,8 @@ hlc_AVL* hlc_avl_remove(
       assert(node_direction == -1 || node_direction == +1);
       HLC_AVL_LINKS(node_parent)[node_direction] = a;
       node_parent->balance -= node_direction;
-      return hlc_avl_update_after_removal(node_parent, node_parent);
+      hlc_avl_augment_path(node_parent, NULL, augment);
+      return hlc_avl_update_after_removal(node_parent, node_parent, augment);
     } else {
       assert(a == NULL || (a->balance >= -1 && a->balance <= +1));
       return a;
@@ -430,6 +1050,7 @@ hlc_AVL* hlc_avl_remove(
     signed char node_direction = node->direction;
     hlc_destroy(hlc_avl_element(node, element_layout), element_destroy_instance);
     free(node);
+    HLC_COUNT_CURRENT(frees);
 
     if (a != NULL) {
       HLC_AVL_LINKS(a)[0] = node_parent;
@@ -440,7 +1061,8 @@ hlc_AVL* hlc_avl_remove(
       assert(node_direction == -1 || node_direction == +1);
       HLC_AVL_LINKS(node_parent)[node_direction] = a;
       node_parent->balance -= node_direction;
-      return hlc_avl_update_after_removal(node_parent, node_parent);
+      hlc_avl_augment_path(node_parent, NULL, augment);
+      return hlc_avl_update_after_removal(node_parent, node_parent, augment);
     } else {
       assert(a == NULL || (a->balance >= -1 && a->balance <= +1));
       return a;
@@ -459,6 +1081,7 @@ hlc_AVL* hlc_avl_remove(
     signed char node_balance = node->balance;
     hlc_destroy(hlc_avl_element(node, element_layout), element_destroy_instance);
     free(node);
+    HLC_COUNT_CURRENT(frees);
 
     HLC_AVL_LINKS(a)[0] = x;
 
@@ -482,7 +1105,8 @@ hlc_AVL* hlc_avl_remove(
       HLC_AVL_LINKS(node_parent)[node_direction] = x;
     }
 
-    return hlc_avl_update_after_removal(x, x);
+    hlc_avl_augment_path(x, x, augment);
+    return hlc_avl_update_after_removal(x, x, augment);
   } else {
     //   N            X
     //  / \          / \           X
@@ -501,6 +1125,7 @@ hlc_AVL* hlc_avl_remove(
     hlc_avl_swap(node, x);
     hlc_destroy(hlc_avl_element(node, element_layout), element_destroy_instance);
     free(node);
+    HLC_COUNT_CURRENT(frees);
 
     if (b != NULL) {
       HLC_AVL_LINKS(b)[0] = y;
@@ -510,11 +1135,36 @@ hlc_AVL* hlc_avl_remove(
     HLC_AVL_LINKS(y)[-1] = b;
     y->balance += 1;
 
-    return hlc_avl_update_after_removal(y, x);
+    hlc_avl_augment_path(y, x, augment);
+    return hlc_avl_update_after_removal(y, x, augment);
   }
 }
 
 
+hlc_AVL* hlc_avl_remove(
+  hlc_AVL* node,
+  hlc_Layout element_layout,
+  hlc_Destroy_instance element_destroy_instance
+) {
+  return hlc_avl_remove_augmenting(node, element_layout, element_destroy_instance, NULL);
+}
+
+
+hlc_AVL* hlc_avl_remove_augmented(
+  hlc_AVL* node,
+  hlc_Layout element_layout,
+  hlc_Destroy_instance element_destroy_instance,
+  hlc_Augment_instance augment_instance
+) {
+  hlc_AVL_augment augment = {
+    .element_offset = hlc_avl_element_offset(element_layout),
+    .instance = augment_instance,
+  };
+
+  return hlc_avl_remove_augmenting(node, element_layout, element_destroy_instance, &augment);
+}
+
+
 void hlc_avl_swap(hlc_AVL* node1, hlc_AVL* node2) {
   assert(node1 != NULL);
   assert(node2 != NULL);
@@ -565,16 +1215,234 @@ void hlc_avl_swap(hlc_AVL* node1, hlc_AVL* node2) {
 }
 
 
-void hlc_avl_delete(
+/// @return The number of nodes deleted.
+static size_t hlc_avl_delete_counting(
   hlc_AVL* root,
   hlc_Layout element_layout,
   hlc_Destroy_instance element_destroy_instance
 ) {
   if (root != NULL) {
-    hlc_avl_delete(HLC_AVL_LINKS(root)[-1], element_layout, element_destroy_instance);
-    hlc_avl_delete(HLC_AVL_LINKS(root)[+1], element_layout, element_destroy_instance);
+    size_t count = hlc_avl_delete_counting(HLC_AVL_LINKS(root)[-1], element_layout, element_destroy_instance)
+      + hlc_avl_delete_counting(HLC_AVL_LINKS(root)[+1], element_layout, element_destroy_instance);
 
     hlc_destroy(hlc_avl_element(root, element_layout), element_destroy_instance);
     free(root);
+    HLC_COUNT_CURRENT(frees);
+    return count + 1;
+  } else {
+    return 0;
+  }
+}
+
+
+void hlc_avl_delete(
+  hlc_AVL* root,
+  hlc_Layout element_layout,
+  hlc_Destroy_instance element_destroy_instance
+) {
+  hlc_avl_delete_counting(root, element_layout, element_destroy_instance);
+}
+
+
+/// @brief Makes a subtree a tree of its own.
+static inline void hlc_avl_detach(hlc_AVL* root) {
+  if (root != NULL) {
+    HLC_AVL_LINKS(root)[0] = NULL;
+    root->direction = -1;
+  }
+}
+
+
+/// @brief Joins two trees with a node which goes between them in-order, in O(|left_height - right_height|) time.
+/// @param height Receives the height of the joined tree.
+/// @return The root of the joined tree.
+static hlc_AVL* hlc_avl_join(
+  hlc_AVL* left,
+  size_t left_height,
+  hlc_AVL* middle,
+  hlc_AVL* right,
+  size_t right_height,
+  size_t* height
+) {
+  assert(middle != NULL);
+  assert(height != NULL);
+
+  hlc_avl_detach(left);
+  hlc_avl_detach(right);
+
+  if (left_height <= right_height + 1 && right_height <= left_height + 1) {
+    HLC_AVL_LINKS(middle)[-1] = left;
+    HLC_AVL_LINKS(middle)[+1] = right;
+    HLC_AVL_LINKS(middle)[0] = NULL;
+    middle->direction = -1;
+    middle->balance = (signed char)((ptrdiff_t)right_height - (ptrdiff_t)left_height);
+
+    if (left != NULL) {
+      HLC_AVL_LINKS(left)[0] = middle;
+      left->direction = -1;
+    }
+
+    if (right != NULL) {
+      HLC_AVL_LINKS(right)[0] = middle;
+      right->direction = +1;
+    }
+
+    *height = HLC_MAX(left_height, right_height) + 1;
+    return middle;
+  }
+
+  // The middle node goes down the inner side of the taller tree, until a subtree at most one level taller than the
+  // shorter tree, which it takes in its place, along with the shorter tree on the other side:
+
+  signed char direction = left_height > right_height ? +1 : -1;
+  hlc_AVL* tall = direction > 0 ? left : right;
+  size_t tall_height = direction > 0 ? left_height : right_height;
+  hlc_AVL* other = direction > 0 ? right : left;
+  size_t other_height = direction > 0 ? right_height : left_height;
+
+  hlc_AVL* parent = NULL;
+  hlc_AVL* node = tall;
+  size_t node_height = tall_height;
+
+  while (node_height > other_height + 1) {
+    node_height -= node->balance == -direction ? 2 : 1;
+    parent = node;
+    node = HLC_AVL_LINKS(node)[direction];
+  }
+
+  assert(parent != NULL);
+
+  HLC_AVL_LINKS(middle)[-direction] = node;
+  HLC_AVL_LINKS(middle)[direction] = other;
+  HLC_AVL_LINKS(middle)[0] = parent;
+  middle->direction = direction;
+  middle->balance = (signed char)(direction * ((ptrdiff_t)other_height - (ptrdiff_t)node_height));
+  HLC_AVL_LINKS(parent)[direction] = middle;
+
+  if (node != NULL) {
+    HLC_AVL_LINKS(node)[0] = middle;
+    node->direction = -direction;
+  }
+
+  if (other != NULL) {
+    HLC_AVL_LINKS(other)[0] = middle;
+    other->direction = direction;
+  }
+
+  // The subtree of the middle node is one level taller than the one it replaced, as after an insertion, except that
+  // it may be balanced: the height then keeps growing for as long as subtrees end up unbalanced.
+
+  bool grown = true;
+  node = middle;
+
+  while (HLC_AVL_LINKS(node)[0] != NULL) {
+    HLC_COUNT_CURRENT(rebalance_iterations);
+    assert(node->direction == -1 || node->direction == +1);
+    HLC_AVL_LINKS(node)[0]->balance += node->direction;
+
+    node = HLC_AVL_LINKS(node)[0];
+    node = hlc_avl_rebalance(node, NULL);
+
+    if (node->balance == 0) {
+      grown = false;
+      break;
+    }
+  }
+
+  *height = tall_height + grown;
+  return HLC_AVL_LINKS(node)[0] == NULL ? node : tall;
+}
+
+
+/// @brief Splits the tree of a node into the trees of the nodes before and after it, leaving the node detached.
+/// @details Climbing from the node, each ancestor is joined, along with its other subtree, to the tree of the side the
+/// node is on. These trees only grow taller, so that the costs of the joins add up to O(log n).
+static void hlc_avl_split(
+  hlc_AVL* node,
+  hlc_AVL** left,
+  size_t* left_height,
+  hlc_AVL** right,
+  size_t* right_height
+) {
+  assert(node != NULL);
+
+  size_t node_height = hlc_avl_height(node);
+  hlc_AVL* ancestor = HLC_AVL_LINKS(node)[0];
+  signed char direction = node->direction;
+
+  *left = HLC_AVL_LINKS(node)[-1];
+  *left_height = node_height - (node->balance > 0 ? 2 : 1);
+  *right = HLC_AVL_LINKS(node)[+1];
+  *right_height = node_height - (node->balance < 0 ? 2 : 1);
+
+  hlc_avl_detach(*left);
+  hlc_avl_detach(*right);
+
+  while (ancestor != NULL) {
+    hlc_AVL* ancestor_parent = HLC_AVL_LINKS(ancestor)[0];
+    signed char ancestor_direction = ancestor->direction;
+
+    // node_height is the height of the subtree the node was in, from which the balance gives that of its sibling:
+    hlc_AVL* sibling = HLC_AVL_LINKS(ancestor)[-direction];
+    size_t sibling_height = (size_t)((ptrdiff_t)node_height - direction * ancestor->balance);
+    node_height = HLC_MAX(node_height, sibling_height) + 1;
+
+    if (direction > 0) {
+      *left = hlc_avl_join(sibling, sibling_height, ancestor, *left, *left_height, left_height);
+    } else {
+      *right = hlc_avl_join(*right, *right_height, ancestor, sibling, sibling_height, right_height);
+    }
+
+    ancestor = ancestor_parent;
+    direction = ancestor_direction;
+  }
+}
+
+
+hlc_AVL* hlc_avl_remove_range(
+  hlc_AVL* first,
+  hlc_AVL* last,
+  hlc_Layout element_layout,
+  hlc_Destroy_instance element_destroy_instance,
+  size_t* removed_count
+) {
+  assert(first != NULL);
+  assert(last != NULL);
+
+  // The node following the range is found before the tree is taken apart, and then joins what precedes and follows
+  // the range back together:
+  hlc_AVL* next = hlc_avl_xcessor(last, +1);
+
+  hlc_AVL* before;
+  size_t before_height;
+  hlc_AVL* range;
+  size_t range_height;
+  hlc_AVL* after = NULL;
+  size_t after_height = 0;
+
+  hlc_avl_split(first, &before, &before_height, &range, &range_height);
+
+  if (next != NULL) {
+    hlc_avl_split(next, &range, &range_height, &after, &after_height);
+  }
+
+  hlc_destroy(hlc_avl_element(first, element_layout), element_destroy_instance);
+  free(first);
+  HLC_COUNT_CURRENT(frees);
+
+  size_t count = hlc_avl_delete_counting(range, element_layout, element_destroy_instance) + 1;
+
+  if (removed_count != NULL) {
+    *removed_count = count;
+  }
+
+  if (next != NULL) {
+    size_t height;
+    hlc_AVL* root = hlc_avl_join(before, before_height, next, after, after_height, &height);
+    assert(hlc_avl_check(root) == height);
+    return root;
+  } else {
+    assert(hlc_avl_check(before) == before_height);
+    return before;
   }
 }
@@ -1,19 +1,28 @@
 #ifndef HLC_AVL_H
 #define HLC_AVL_H
 
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 
 #include "api.h"
 #include "layout.h"
+#include "task.h"
 #include "traits/assign.h"
+#include "traits/augment.h"
+#include "traits/compare.h"
 #include "traits/destroy.h"
+#include "traits/reduce.h"
 
 HLC_DECLARATIONS_BEGIN
 
 typedef struct hlc_AVL hlc_AVL;
 
+/// @relates hlc_AVL
+/// @brief An upper bound on the height of any AVL tree which fits in memory.
+#define HLC_AVL_MAX_HEIGHT (sizeof(size_t) * CHAR_BIT * 3 / 2)
+
 /// @memberof hlc_AVL
 /// @brief Creates a new AVL node.
 /// @return The new AVL node, or NULL on insufficient memory.
@@ -23,14 +32,23 @@ HLC_API hlc_AVL* hlc_avl_new(
   hlc_Assign_instance element_assign_instance
 );
 
+/// @memberof hlc_AVL
+/// @brief Returns the layout of a node storing an element of the given layout, including header and padding.
+HLC_API hlc_Layout hlc_avl_layout(hlc_Layout element_layout);
+
 /// @memberof hlc_AVL
 /// @brief Computes the number of nodes of this subtree.
 HLC_API size_t hlc_avl_count(const hlc_AVL* root);
 
 /// @memberof hlc_AVL
 /// @brief Computes the height of this subtree.
+/// @details Only the path to the deepest node is visited, which the balance factors lead to.
 HLC_API size_t hlc_avl_height(const hlc_AVL* root);
 
+/// @memberof hlc_AVL
+/// @brief Computes the sum of the depths of the nodes of this subtree, counting the root as depth 1.
+HLC_API size_t hlc_avl_depth_sum(const hlc_AVL* root);
+
 /// @memberof hlc_AVL
 /// @brief Gets the left/right child or the parent of this node.
 /// @param direction -1 for the left child, 0 for the parent, +1 for the right child.
@@ -61,6 +79,20 @@ HLC_API void* hlc_avl_element(const hlc_AVL* node, hlc_Layout element_layout);
   const void*: (const void*)hlc_avl_element((node), (element_layout)) \
 )
 
+/// @memberof hlc_AVL
+/// @brief Returns the node storing an element, given a reference to it as returned by hlc_avl_element.
+/// @pre element != NULL
+HLC_API hlc_AVL* hlc_avl_node(const void* element, hlc_Layout element_layout);
+
+/// @memberof hlc_AVL
+/// @brief Returns the node storing an element, given a reference to it as returned by hlc_avl_element.
+/// @pre element != NULL
+#define hlc_avl_node(element, element_layout) _Generic(                  \
+  true ? (element) : (void*)(element),                                   \
+  void*: hlc_avl_node((element), (element_layout)),                      \
+  const void*: (const hlc_AVL*)hlc_avl_node((element), (element_layout)) \
+)
+
 /// @memberof hlc_AVL
 /// @brief Gets to the leftmost/topmost/rightmost node of this subtree.
 /// @param direction -1 for the leftmost node, 0 for the topmost node, +1 for the rightmost node.
@@ -93,6 +125,99 @@ HLC_API hlc_AVL* hlc_avl_xcessor(const hlc_AVL* node, signed char direction);
   const void*: (const hlc_AVL*)hlc_avl_xcessor((node), (direction)) \
 )
 
+/// @memberof hlc_AVL
+/// @brief Searches this subtree for a key, compared with the part of each element at the given offset.
+/// @param ordering Receives 0 if the key was found, or else the side of the returned node where it would be inserted.
+/// @return The node holding the key if it was found, else the last node visited, or NULL if the subtree is empty.
+/// @pre ordering != NULL
+HLC_API hlc_AVL* hlc_avl_search(
+  const hlc_AVL* root,
+  hlc_Layout element_layout,
+  const void* key,
+  size_t key_offset,
+  hlc_Compare_instance key_compare_instance,
+  signed char* ordering
+);
+
+/// @memberof hlc_AVL
+/// @brief Searches this subtree for a key, compared with the part of each element at the given offset.
+/// @param ordering Receives 0 if the key was found, or else the side of the returned node where it would be inserted.
+/// @return The node holding the key if it was found, else the last node visited, or NULL if the subtree is empty.
+/// @pre ordering != NULL
+#define hlc_avl_search(root, layout, key, offset, compare_instance, ordering) _Generic(                          \
+  true ? (root) : (void*)(root),                                                                                 \
+  void*: hlc_avl_search((root), (layout), (key), (offset), (compare_instance), (ordering)),                      \
+  const void*: (const hlc_AVL*)hlc_avl_search((root), (layout), (key), (offset), (compare_instance), (ordering)) \
+)
+
+/// @memberof hlc_AVL
+/// @brief Copies this subtree node by node, preserving its shape.
+/// @param clone Receives the root of the copy, whose parent is NULL.
+/// @return true on success, false on insufficient memory.
+/// @pre clone != NULL
+HLC_API bool hlc_avl_clone(
+  const hlc_AVL* root,
+  hlc_AVL** clone,
+  hlc_Layout element_layout,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Destroy_instance element_destroy_instance
+);
+
+/// @memberof hlc_AVL
+/// @brief Copies this subtree node by node, preserving its shape, copying sibling subtrees in parallel.
+/// @details The assign instance may be called concurrently from several threads.
+/// @param clone Receives the root of the copy, whose parent is NULL.
+/// @return true on success, false on insufficient memory.
+/// @pre clone != NULL && pool != NULL
+HLC_API bool hlc_avl_parallel_clone(
+  const hlc_AVL* root,
+  hlc_AVL** clone,
+  hlc_Layout element_layout,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Destroy_instance element_destroy_instance,
+  hlc_Task_pool* pool
+);
+
+/// @memberof hlc_AVL
+/// @brief Visits the elements of this subtree in-order, until the visitor returns false.
+/// @details The traversal keeps the path to the current node on a stack, rather than climbing parent links.
+/// @return true if all elements were visited, false if the visitor stopped the traversal.
+HLC_API bool hlc_avl_for_each(
+  const hlc_AVL* root,
+  hlc_Layout element_layout,
+  bool (*visit)(const void* element, void* context),
+  void* context
+);
+
+/// @memberof hlc_AVL
+/// @brief Visits the elements of this subtree in parallel, in no particular order, until a visitor returns false.
+/// @details The visitor may be called concurrently from several threads. Once it returns false, no new visits start.
+/// @return true if all elements were visited, false if the visitor stopped the traversal.
+/// @pre pool != NULL && visit != NULL
+HLC_API bool hlc_avl_parallel_for_each(
+  const hlc_AVL* root,
+  hlc_Layout element_layout,
+  hlc_Task_pool* pool,
+  bool (*visit)(const void* element, void* context),
+  void* context
+);
+
+/// @memberof hlc_AVL
+/// @brief Reduces the elements of this subtree in parallel.
+/// @details The subtree is split at fixed depths regardless of the number of threads, and partial results are always
+/// combined in-order, so that the result doesn't depend on scheduling.
+/// @param accumulator Uninitialized memory for an accumulator, which receives the result.
+/// @return true on success, false if the accumulator couldn't be initialized.
+/// @pre pool != NULL && accumulator != NULL
+HLC_API bool hlc_avl_parallel_reduce(
+  const hlc_AVL* root,
+  hlc_Layout element_layout,
+  hlc_Task_pool* pool,
+  void* accumulator,
+  hlc_Layout accumulator_layout,
+  hlc_Reduce_instance reduce_instance
+);
+
 /// @memberof hlc_AVL
 /// @brief Inserts a new node to the left/right of this node.
 /// @param direction -1 to insert to the left, +1 to insert to the right.
@@ -116,6 +241,50 @@ HLC_API hlc_AVL* hlc_avl_remove(
   hlc_Destroy_instance element_destroy_instance
 );
 
+/// @memberof hlc_AVL
+/// @brief Inserts a new node to the left/right of this node, keeping the augmented data of the elements current.
+/// @details The data of the new node, its ancestors and the nodes moved by rotations is updated with the augment
+/// instance, which assumes that the data of every other node of the tree is current.
+/// @param direction -1 to insert to the left, +1 to insert to the right.
+/// @return The new root of the subtree where the node was inserted (after rebalancing), or NULL on insufficient memory.
+/// @pre node != NULL && hlc_avl_link(node, direction) == NULL
+HLC_API hlc_AVL* hlc_avl_insert_augmented(
+  hlc_AVL* node,
+  signed char direction,
+  const void* element,
+  hlc_Layout element_layout,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Augment_instance augment_instance
+);
+
+/// @memberof hlc_AVL
+/// @brief Removes this node from its tree, keeping the augmented data of the remaining elements current.
+/// @details The data of the ancestors of the node and of the nodes moved by rotations is updated with the augment
+/// instance, which assumes that the data of every other node of the tree is current.
+/// @return The new root of the subtree where the node was removed (after rebalancing).
+/// @pre node != NULL
+HLC_API hlc_AVL* hlc_avl_remove_augmented(
+  hlc_AVL* node,
+  hlc_Layout element_layout,
+  hlc_Destroy_instance element_destroy_instance,
+  hlc_Augment_instance augment_instance
+);
+
+/// @memberof hlc_AVL
+/// @brief Removes the nodes from first to last, in-order, from their tree, without any comparison.
+/// @details The tree is split around the range, and what precedes and follows it is joined back together, in O(log n)
+/// time besides destroying the k removed nodes, instead of k removals each rebalancing on its own.
+/// @param removed_count Receives the number of removed nodes, unless it's NULL.
+/// @return The new root of the tree, or NULL if it was left empty.
+/// @pre first != NULL && last != NULL, both in the same tree, with first not following last
+HLC_API hlc_AVL* hlc_avl_remove_range(
+  hlc_AVL* first,
+  hlc_AVL* last,
+  hlc_Layout element_layout,
+  hlc_Destroy_instance element_destroy_instance,
+  size_t* removed_count
+);
+
 /// @memberof hlc_AVL
 /// @brief Swaps two nodes.
 /// @pre node1 != NULL && node2 != NULL
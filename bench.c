@@ -0,0 +1,722 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __has_include
+  #if __has_include(<sys/resource.h>)
+    #include <sys/resource.h>
+  #elif __has_include(<windows.h>) && __has_include(<psapi.h>)
+    #include <windows.h>
+    #include <psapi.h>
+  #endif
+#endif
+
+#include "layout.h"
+#include "map.h"
+#include "radix.h"
+#include "random.h"
+#include "set.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+
+/// @brief The number of operations whose inputs are prepared ahead of each timed run, so that key generation and
+/// formatting are not measured.
+#define BENCH_CHUNK 4096
+
+#define BENCH_STRING_SIZE 32
+#define BENCH_LARGE_VALUE_SIZE 256
+#define BENCH_ZIPF_EXPONENT 0.99
+
+
+typedef enum Bench_container {
+  BENCH_SET,
+  BENCH_MAP,
+  BENCH_MAP_OUT_OF_LINE,
+  BENCH_RADIX,
+} Bench_container;
+
+typedef enum Bench_key {
+  BENCH_U64,
+  BENCH_STRING,
+} Bench_key;
+
+typedef enum Bench_distribution {
+  BENCH_SEQUENTIAL,
+  BENCH_RANDOM,
+  BENCH_ZIPF,
+} Bench_distribution;
+
+typedef enum Bench_workload {
+  BENCH_INSERT,
+  BENCH_LOOKUP,
+  BENCH_READ_MOSTLY,
+  BENCH_READ_WRITE,
+  BENCH_SCAN,
+  BENCH_REMOVE,
+} Bench_workload;
+
+static const char* const bench_container_names[] = {"set", "map", "map_out_of_line", "radix"};
+static const char* const bench_key_names[] = {"u64", "string"};
+static const char* const bench_distribution_names[] = {"sequential", "random", "zipf"};
+static const char* const bench_workload_names[] = {"insert", "lookup", "read_90", "read_50", "scan", "remove"};
+
+/// @brief The percentage of reads for each workload. Writes alternate between removals and insertions.
+static const unsigned bench_workload_reads[] = {0, 100, 90, 50, 100, 0};
+
+
+typedef struct Bench_string {
+  char bytes[BENCH_STRING_SIZE];
+} Bench_string;
+
+typedef struct Bench_large_value {
+  unsigned char bytes[BENCH_LARGE_VALUE_SIZE];
+} Bench_large_value;
+
+typedef union Bench_key_buffer {
+  unsigned long long u64;
+  Bench_string string;
+} Bench_key_buffer;
+
+typedef union Bench_value_buffer {
+  unsigned long long u64;
+  Bench_large_value large;
+} Bench_value_buffer;
+
+
+typedef struct Bench_config {
+  Bench_container container;
+  Bench_key key;
+  size_t value_size;
+  Bench_distribution distribution;
+} Bench_config;
+
+static const Bench_config bench_configs[] = {
+  {BENCH_SET, BENCH_U64, 0, BENCH_SEQUENTIAL},
+  {BENCH_SET, BENCH_U64, 0, BENCH_RANDOM},
+  {BENCH_SET, BENCH_U64, 0, BENCH_ZIPF},
+  {BENCH_SET, BENCH_STRING, 0, BENCH_SEQUENTIAL},
+  {BENCH_SET, BENCH_STRING, 0, BENCH_RANDOM},
+  {BENCH_SET, BENCH_STRING, 0, BENCH_ZIPF},
+  {BENCH_MAP, BENCH_U64, sizeof(unsigned long long), BENCH_SEQUENTIAL},
+  {BENCH_MAP, BENCH_U64, sizeof(unsigned long long), BENCH_RANDOM},
+  {BENCH_MAP, BENCH_U64, sizeof(unsigned long long), BENCH_ZIPF},
+  {BENCH_MAP, BENCH_U64, BENCH_LARGE_VALUE_SIZE, BENCH_RANDOM},
+  {BENCH_MAP, BENCH_U64, BENCH_LARGE_VALUE_SIZE, BENCH_ZIPF},
+  {BENCH_MAP_OUT_OF_LINE, BENCH_U64, BENCH_LARGE_VALUE_SIZE, BENCH_RANDOM},
+  {BENCH_MAP_OUT_OF_LINE, BENCH_U64, BENCH_LARGE_VALUE_SIZE, BENCH_ZIPF},
+  {BENCH_MAP, BENCH_STRING, sizeof(unsigned long long), BENCH_RANDOM},
+  {BENCH_MAP, BENCH_STRING, sizeof(unsigned long long), BENCH_ZIPF},
+  {BENCH_MAP, BENCH_STRING, BENCH_LARGE_VALUE_SIZE, BENCH_RANDOM},
+  {BENCH_RADIX, BENCH_U64, sizeof(unsigned long long), BENCH_SEQUENTIAL},
+  {BENCH_RADIX, BENCH_U64, sizeof(unsigned long long), BENCH_RANDOM},
+  {BENCH_RADIX, BENCH_U64, sizeof(unsigned long long), BENCH_ZIPF},
+  {BENCH_RADIX, BENCH_STRING, sizeof(unsigned long long), BENCH_RANDOM},
+  {BENCH_RADIX, BENCH_STRING, sizeof(unsigned long long), BENCH_ZIPF},
+};
+
+
+typedef struct Bench_options {
+  bool json;
+  size_t min_count;
+  size_t max_count;
+  size_t operations;
+  unsigned long seed;
+  const char* filter;
+} Bench_options;
+
+
+static signed char bench_string_compare(const void* x, const void* y, const hlc_Compare_trait* trait, void* context) {
+  (void)trait;
+  (void)context;
+  int ordering = strcmp(((const Bench_string*)x)->bytes, ((const Bench_string*)y)->bytes);
+  return ordering < 0 ? -1 : ordering > 0 ? +1 : 0;
+}
+
+static const hlc_Compare_trait bench_string_compare_trait = {
+  .compare = bench_string_compare,
+};
+
+
+static bool bench_string_assign(void* target, const void* source, const hlc_Assign_trait* trait, void* context) {
+  (void)trait;
+  (void)context;
+  *(Bench_string*)target = *(const Bench_string*)source;
+  return true;
+}
+
+static const hlc_Assign_trait bench_string_assign_trait = {
+  .assign = bench_string_assign,
+  .reassign = bench_string_assign,
+  .trivial = true,
+};
+
+
+static bool bench_large_value_assign(void* target, const void* source, const hlc_Assign_trait* trait, void* context) {
+  (void)trait;
+  (void)context;
+  *(Bench_large_value*)target = *(const Bench_large_value*)source;
+  return true;
+}
+
+static const hlc_Assign_trait bench_large_value_assign_trait = {
+  .assign = bench_large_value_assign,
+  .reassign = bench_large_value_assign,
+  .trivial = true,
+};
+
+
+/// @brief Mixes the bits of a 64-bit integer (the splitmix64 finalizer). This is a bijection.
+static unsigned long long bench_mix(unsigned long long x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return x;
+}
+
+
+/// @brief A pseudorandom permutation of [0, count), built from a Feistel network over the smallest even number of bits
+/// covering count. Indices falling outside the range are encrypted again until they fall inside (cycle walking).
+typedef struct Bench_permutation {
+  size_t count;
+  unsigned half_bits;
+  unsigned long long keys[4];
+} Bench_permutation;
+
+
+static void bench_permutation_create(Bench_permutation* permutation, size_t count, hlc_Random* random) {
+  permutation->count = count;
+  permutation->half_bits = 1;
+
+  while (permutation->half_bits < 32 && (1ULL << (2 * permutation->half_bits)) < count) {
+    permutation->half_bits += 1;
+  }
+
+  for (size_t i = 0; i < 4; ++i) {
+    permutation->keys[i] = hlc_random_ullong_in(random, 0, ULLONG_MAX);
+  }
+}
+
+
+static size_t bench_permutation_get(const Bench_permutation* permutation, size_t index) {
+  assert(index < permutation->count);
+
+  unsigned long long mask = (1ULL << permutation->half_bits) - 1;
+  unsigned long long x = index;
+
+  do {
+    unsigned long long left = x >> permutation->half_bits;
+    unsigned long long right = x & mask;
+
+    for (size_t i = 0; i < 4; ++i) {
+      unsigned long long t = left ^ (bench_mix(right ^ permutation->keys[i]) & mask);
+      left = right;
+      right = t;
+    }
+
+    x = (left << permutation->half_bits) | right;
+  } while (x >= permutation->count);
+
+  return (size_t)x;
+}
+
+
+typedef struct Bench {
+  Bench_config config;
+  size_t count;
+
+  hlc_Random* random;
+  Bench_permutation permutation;
+  hlc_Random_zipf* zipf;
+
+  hlc_Layout key_layout;
+  hlc_Compare_instance key_compare_instance;
+  hlc_Assign_instance key_assign_instance;
+  hlc_Layout value_layout;
+  hlc_Assign_instance value_assign_instance;
+
+  hlc_Set* set;
+  hlc_Map* map;
+  hlc_Radix_map* radix;
+
+  size_t indices[BENCH_CHUNK];
+  Bench_key_buffer keys[BENCH_CHUNK];
+  Bench_value_buffer value;
+  size_t writes;
+  size_t sink;
+} Bench;
+
+
+/// @brief Returns the index of the key used by the i-th operation of a workload.
+static size_t bench_index(Bench* bench, Bench_workload workload, size_t i) {
+  bool ordered = workload == BENCH_INSERT || workload == BENCH_REMOVE;
+
+  switch (bench->config.distribution) {
+    case BENCH_SEQUENTIAL:
+      return i % bench->count;
+    case BENCH_RANDOM:
+      return ordered
+        ? bench_permutation_get(&bench->permutation, i)
+        : hlc_random_size_in(bench->random, 0, bench->count - 1);
+    case BENCH_ZIPF:
+      // Spread the popular ranks over the key space, so that they do not share a single path down the tree.
+      return ordered
+        ? bench_permutation_get(&bench->permutation, i)
+        : (size_t)(bench_mix(hlc_random_zipf_next(bench->zipf, bench->random)) % bench->count);
+  }
+
+  return 0;
+}
+
+
+/// @brief Builds the key of an index. Keys compare in the same order as their indices.
+static void bench_key(const Bench* bench, size_t index, Bench_key_buffer* key) {
+  if (bench->config.key == BENCH_U64) {
+    key->u64 = index;
+  } else {
+    snprintf(key->string.bytes, sizeof(key->string.bytes), "user:%020zu", index);
+  }
+}
+
+
+/// @brief Encodes a key into bytes for the radix map, which compare in the same order.
+/// @return The size of the encoded key.
+static size_t bench_radix_key(
+  const Bench* bench,
+  const void* key,
+  unsigned char bytes[static sizeof(Bench_key_buffer)]
+) {
+  if (bench->config.key == BENCH_U64) {
+    hlc_radix_encode_ullong(*(const unsigned long long*)key, bytes);
+    return 8;
+  }
+
+  size_t size = strlen(((const Bench_string*)key)->bytes);
+  memcpy(bytes, key, size);
+  return size;
+}
+
+
+static bool bench_insert(Bench* bench, const void* key) {
+  if (bench->config.container == BENCH_SET) {
+    return hlc_set_insert(bench->set, key, bench->key_assign_instance);
+  }
+
+  bench->value.u64 += 1;
+
+  if (bench->config.container == BENCH_RADIX) {
+    unsigned char bytes[sizeof(Bench_key_buffer)];
+    size_t size = bench_radix_key(bench, key, bytes);
+    return hlc_radix_map_insert(bench->radix, bytes, size, &bench->value, bench->value_assign_instance);
+  }
+
+  return hlc_map_insert(bench->map, key, &bench->value, bench->key_assign_instance, bench->value_assign_instance);
+}
+
+
+static bool bench_remove(Bench* bench, const void* key) {
+  if (bench->config.container == BENCH_RADIX) {
+    unsigned char bytes[sizeof(Bench_key_buffer)];
+    size_t size = bench_radix_key(bench, key, bytes);
+    return hlc_radix_map_remove(bench->radix, bytes, size);
+  }
+
+  return bench->config.container == BENCH_SET ? hlc_set_remove(bench->set, key) : hlc_map_remove(bench->map, key);
+}
+
+
+static bool bench_lookup(Bench* bench, const void* key) {
+  if (bench->config.container == BENCH_SET) {
+    return hlc_set_contains(bench->set, key);
+  }
+
+  const unsigned long long* value;
+
+  if (bench->config.container == BENCH_RADIX) {
+    unsigned char bytes[sizeof(Bench_key_buffer)];
+    size_t size = bench_radix_key(bench, key, bytes);
+    value = hlc_radix_map_lookup(bench->radix, bytes, size);
+  } else {
+    value = hlc_map_lookup(bench->map, key);
+  }
+
+  return value != NULL && *value != 0;
+}
+
+
+static bool bench_scan_radix(hlc_Radix_map_kv_ref kv_ref, void* context) {
+  *(size_t*)context += *(const unsigned long long*)kv_ref.value != 0;
+  return true;
+}
+
+
+static size_t bench_scan(Bench* bench) {
+  size_t count = 0;
+
+  if (bench->config.container == BENCH_RADIX) {
+    hlc_radix_map_for_each(bench->radix, bench_scan_radix, &count);
+  } else if (bench->config.container == BENCH_SET) {
+    hlc_Set_iterator* iterator = malloc(hlc_set_iterator_layout.size);
+    assert(iterator != NULL);
+    hlc_set_iterator(bench->set, iterator);
+
+    for (const void* element; (element = hlc_set_iterator_next(iterator)) != NULL; ) {
+      count += *(const unsigned char*)element != 0;
+    }
+
+    free(iterator);
+  } else {
+    hlc_Map_iterator* iterator = malloc(hlc_map_iterator_layout.size);
+    assert(iterator != NULL);
+    hlc_map_iterator(bench->map, iterator);
+
+    for (hlc_Map_kv_ref kv_ref; (kv_ref = hlc_map_iterator_next(iterator)).key != NULL; ) {
+      count += *(const unsigned long long*)kv_ref.value != 0;
+    }
+
+    free(iterator);
+  }
+
+  return count;
+}
+
+
+static double bench_seconds(void) {
+  struct timespec t;
+  timespec_get(&t, TIME_UTC);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+
+/// @brief Returns the peak resident set size of the process in KiB, or 0 if it is unknown.
+static size_t bench_peak_rss(void) {
+  #if defined(RUSAGE_SELF)
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+      return 0;
+    }
+
+    #ifdef __APPLE__
+      return (size_t)usage.ru_maxrss / 1024;
+    #else
+      return (size_t)usage.ru_maxrss;
+    #endif
+  #elif defined(_WIN32) && defined(PSAPI_VERSION)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+      return 0;
+    }
+
+    return counters.PeakWorkingSetSize / 1024;
+  #else
+    return 0;
+  #endif
+}
+
+
+/// @brief Runs a workload and returns the time it took in seconds.
+static double bench_run(Bench* bench, Bench_workload workload, size_t operations) {
+  if (workload == BENCH_SCAN) {
+    double start = bench_seconds();
+    bench->sink += bench_scan(bench);
+    return bench_seconds() - start;
+  }
+
+  unsigned reads = bench_workload_reads[workload];
+  double elapsed = 0;
+
+  for (size_t i = 0; i < operations; i += BENCH_CHUNK) {
+    size_t chunk = operations - i < BENCH_CHUNK ? operations - i : BENCH_CHUNK;
+
+    for (size_t j = 0; j < chunk; ++j) {
+      bench->indices[j] = bench_index(bench, workload, i + j);
+      bench_key(bench, bench->indices[j], &bench->keys[j]);
+
+      // Mark the writes of mixed workloads with an out of range index.
+      if (reads != 0 && reads != 100 && hlc_random_uint_in(bench->random, 0, 99) >= reads) {
+        bench->indices[j] = SIZE_MAX;
+      }
+    }
+
+    double start = bench_seconds();
+
+    for (size_t j = 0; j < chunk; ++j) {
+      const void* key = &bench->keys[j];
+
+      if (workload == BENCH_INSERT) {
+        bool ok = bench_insert(bench, key);
+        assert(ok);
+        (void)ok;
+      } else if (workload == BENCH_REMOVE) {
+        bench->sink += bench_remove(bench, key);
+      } else if (bench->indices[j] != SIZE_MAX) {
+        bench->sink += bench_lookup(bench, key);
+      } else if (bench->writes++ % 2 == 0) {
+        bench->sink += bench_remove(bench, key);
+      } else {
+        bench->sink += bench_insert(bench, key);
+      }
+    }
+
+    elapsed += bench_seconds() - start;
+  }
+
+  return elapsed;
+}
+
+
+static void bench_report(
+  const Bench_options* options,
+  const Bench* bench,
+  Bench_workload workload,
+  size_t operations,
+  double seconds,
+  bool first
+) {
+  double ns_per_op = operations != 0 ? seconds * 1e9 / (double)operations : 0;
+  double ops_per_s = seconds > 0 ? (double)operations / seconds : 0;
+  const Bench_config* config = &bench->config;
+
+  if (options->json) {
+    printf(
+      "%s\n  {\"container\": \"%s\", \"key\": \"%s\", \"value_size\": %zu, \"distribution\": \"%s\", "
+      "\"workload\": \"%s\", \"count\": %zu, \"operations\": %zu, \"ns_per_op\": %.2f, \"ops_per_s\": %.0f, "
+      "\"peak_rss_kib\": %zu}",
+      first ? "" : ",",
+      bench_container_names[config->container],
+      bench_key_names[config->key],
+      config->value_size,
+      bench_distribution_names[config->distribution],
+      bench_workload_names[workload],
+      bench->count,
+      operations,
+      ns_per_op,
+      ops_per_s,
+      bench_peak_rss()
+    );
+  } else {
+    printf(
+      "%s,%s,%zu,%s,%s,%zu,%zu,%.2f,%.0f,%zu\n",
+      bench_container_names[config->container],
+      bench_key_names[config->key],
+      config->value_size,
+      bench_distribution_names[config->distribution],
+      bench_workload_names[workload],
+      bench->count,
+      operations,
+      ns_per_op,
+      ops_per_s,
+      bench_peak_rss()
+    );
+  }
+
+  fflush(stdout);
+}
+
+
+/// @brief Returns whether a benchmark matches the filter, a substring of "container/key/value_size/distribution".
+static bool bench_matches(const Bench_options* options, const Bench_config* config) {
+  if (options->filter == NULL) {
+    return true;
+  }
+
+  char name[128];
+  snprintf(
+    name,
+    sizeof(name),
+    "%s/%s/%zu/%s",
+    bench_container_names[config->container],
+    bench_key_names[config->key],
+    config->value_size,
+    bench_distribution_names[config->distribution]
+  );
+
+  return strstr(name, options->filter) != NULL;
+}
+
+
+static bool bench_parse_size(const char* argument, const char* name, size_t* value) {
+  size_t length = strlen(name);
+
+  if (strncmp(argument, name, length) != 0 || argument[length] != '=') {
+    return false;
+  }
+
+  // Accept scientific notation, so that 1e8 can be written instead of 100000000.
+  *value = (size_t)strtod(argument + length + 1, NULL);
+  return true;
+}
+
+
+static bool bench_parse(int argc, char** argv, Bench_options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* argument = argv[i];
+    size_t seed;
+
+    if (strcmp(argument, "--csv") == 0) {
+      options->json = false;
+    } else if (strcmp(argument, "--json") == 0) {
+      options->json = true;
+    } else if (bench_parse_size(argument, "--min", &options->min_count)) {
+    } else if (bench_parse_size(argument, "--max", &options->max_count)) {
+    } else if (bench_parse_size(argument, "--operations", &options->operations)) {
+    } else if (bench_parse_size(argument, "--seed", &seed)) {
+      options->seed = (unsigned long)seed;
+    } else if (strncmp(argument, "--filter=", 9) == 0) {
+      options->filter = argument + 9;
+    } else {
+      return false;
+    }
+  }
+
+  return options->min_count >= 1 && options->min_count <= options->max_count && options->operations >= 1;
+}
+
+
+int main(int argc, char** argv) {
+  Bench_options options = {
+    .json = false,
+    .min_count = 1000,
+    .max_count = 1000000,
+    .operations = 1000000,
+    .seed = 5489,
+    .filter = NULL,
+  };
+
+  if (!bench_parse(argc, argv, &options)) {
+    fprintf(
+      stderr,
+      "Usage: %s [--csv | --json] [--min=COUNT] [--max=COUNT] [--operations=COUNT] [--seed=SEED] [--filter=TEXT]\n"
+      "Runs each benchmark with 10^k elements, for all powers of ten between --min and --max.\n"
+      "TEXT selects benchmarks by a substring of container/key/value_size/distribution, e.g. map/string.\n",
+      argv[0]
+    );
+    return EXIT_FAILURE;
+  }
+
+  Bench* bench = malloc(sizeof(Bench));
+  hlc_Random* random = malloc(hlc_random_layout.size);
+  hlc_Set* set = malloc(hlc_set_layout.size);
+  hlc_Map* map = malloc(hlc_map_layout.size);
+  hlc_Radix_map* radix = malloc(hlc_radix_map_layout.size);
+  hlc_Random_zipf* zipf = malloc(hlc_random_zipf_layout.size);
+
+  if (bench == NULL || random == NULL || set == NULL || map == NULL || radix == NULL || zipf == NULL) {
+    fputs("Out of memory\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  if (options.json) {
+    fputs("[", stdout);
+  } else {
+    puts("container,key,value_size,distribution,workload,count,operations,ns_per_op,ops_per_s,peak_rss_kib");
+  }
+
+  bool first = true;
+
+  for (size_t c = 0; c < sizeof(bench_configs) / sizeof(bench_configs[0]); ++c) {
+    const Bench_config* config = &bench_configs[c];
+
+    if (!bench_matches(&options, config)) {
+      continue;
+    }
+
+    for (size_t count = 1; count <= options.max_count; count *= 10) {
+      if (count < options.min_count) {
+        continue;
+      }
+
+      memset(bench, 0, sizeof(*bench));
+      bench->config = *config;
+      bench->count = count;
+      bench->random = random;
+      bench->set = set;
+      bench->map = map;
+      bench->radix = radix;
+      bench->zipf = zipf;
+
+      hlc_random_create_with_engine(random, HLC_RANDOM_XOSHIRO256, options.seed);
+      bench_permutation_create(&bench->permutation, count, random);
+      hlc_random_zipf_create(bench->zipf, count, BENCH_ZIPF_EXPONENT);
+
+      if (config->key == BENCH_U64) {
+        bench->key_layout = HLC_LAYOUT_OF(unsigned long long);
+        bench->key_compare_instance = hlc_ullong_compare_instance;
+        bench->key_assign_instance = hlc_ullong_assign_instance;
+      } else {
+        bench->key_layout = HLC_LAYOUT_OF(Bench_string);
+        bench->key_compare_instance = (hlc_Compare_instance){.trait = &bench_string_compare_trait, .context = NULL};
+        bench->key_assign_instance = (hlc_Assign_instance){.trait = &bench_string_assign_trait, .context = NULL};
+      }
+
+      if (config->value_size == BENCH_LARGE_VALUE_SIZE) {
+        bench->value_layout = HLC_LAYOUT_OF(Bench_large_value);
+        bench->value_assign_instance = (hlc_Assign_instance){.trait = &bench_large_value_assign_trait, .context = NULL};
+      } else {
+        bench->value_layout = HLC_LAYOUT_OF(unsigned long long);
+        bench->value_assign_instance = hlc_ullong_assign_instance;
+      }
+
+      if (config->container == BENCH_SET) {
+        hlc_set_create(set, bench->key_layout, bench->key_compare_instance, hlc_no_destroy_instance);
+      } else if (config->container == BENCH_RADIX) {
+        hlc_radix_map_create(radix, bench->value_layout, hlc_no_destroy_instance);
+      } else {
+        hlc_map_create_with(
+          map,
+          bench->key_layout,
+          bench->value_layout,
+          bench->key_compare_instance,
+          hlc_no_destroy_instance,
+          hlc_no_destroy_instance,
+          config->container == BENCH_MAP_OUT_OF_LINE ? HLC_MAP_VALUES_OUT_OF_LINE : 0
+        );
+      }
+
+      for (Bench_workload workload = BENCH_INSERT; workload <= BENCH_REMOVE; ++workload) {
+        size_t operations = workload == BENCH_INSERT || workload == BENCH_REMOVE ? count : options.operations;
+
+        if (workload == BENCH_SCAN) {
+          operations = config->container == BENCH_SET ? hlc_set_count(set)
+            : config->container == BENCH_RADIX ? hlc_radix_map_count(radix)
+            : hlc_map_count(map);
+        }
+
+        double seconds = bench_run(bench, workload, operations);
+        bench_report(&options, bench, workload, operations, seconds, first);
+        first = false;
+      }
+
+      if (config->container == BENCH_SET) {
+        hlc_set_destroy(set);
+      } else if (config->container == BENCH_RADIX) {
+        hlc_radix_map_destroy(radix);
+      } else {
+        hlc_map_destroy(map);
+      }
+    }
+  }
+
+  if (options.json) {
+    puts("\n]");
+  }
+
+  free(zipf);
+  free(radix);
+  free(map);
+  free(set);
+  free(random);
+  free(bench);
+
+  return EXIT_SUCCESS;
+}
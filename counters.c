@@ -0,0 +1,48 @@
+#include "counters.h"
+
+#include <stddef.h>
+
+#include "tls.h"
+
+#ifdef HLC_COUNTERS
+  #include <stdatomic.h>
+
+  HLC_THREAD_LOCAL hlc_Atomic_counters* hlc_counters_current = NULL;
+
+
+  void hlc_counters_reset(hlc_Atomic_counters* counters) {
+    atomic_store_explicit(&counters->lookups, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->lookup_comparisons, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->insertions, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->insertion_comparisons, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->removals, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->removal_comparisons, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->rotations, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->rebalance_iterations, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->allocations, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->frees, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->assigns, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->reassigns, 0, memory_order_relaxed);
+  }
+
+
+  hlc_Counters hlc_counters_load(const hlc_Atomic_counters* _counters) {
+    // Atomic loads don't modify the counters, but aren't declared to accept const objects by every C11 library.
+    hlc_Atomic_counters* counters = (hlc_Atomic_counters*)_counters;
+
+    return (hlc_Counters){
+      .lookups = atomic_load_explicit(&counters->lookups, memory_order_relaxed),
+      .lookup_comparisons = atomic_load_explicit(&counters->lookup_comparisons, memory_order_relaxed),
+      .insertions = atomic_load_explicit(&counters->insertions, memory_order_relaxed),
+      .insertion_comparisons = atomic_load_explicit(&counters->insertion_comparisons, memory_order_relaxed),
+      .removals = atomic_load_explicit(&counters->removals, memory_order_relaxed),
+      .removal_comparisons = atomic_load_explicit(&counters->removal_comparisons, memory_order_relaxed),
+      .rotations = atomic_load_explicit(&counters->rotations, memory_order_relaxed),
+      .rebalance_iterations = atomic_load_explicit(&counters->rebalance_iterations, memory_order_relaxed),
+      .allocations = atomic_load_explicit(&counters->allocations, memory_order_relaxed),
+      .frees = atomic_load_explicit(&counters->frees, memory_order_relaxed),
+      .assigns = atomic_load_explicit(&counters->assigns, memory_order_relaxed),
+      .reassigns = atomic_load_explicit(&counters->reassigns, memory_order_relaxed),
+    };
+  }
+#endif
@@ -0,0 +1,86 @@
+#ifndef HLC_COUNTERS_H
+#define HLC_COUNTERS_H
+
+#include <stddef.h>
+
+#include "api.h"
+#include "tls.h"
+
+#ifdef HLC_COUNTERS
+  #include <stdatomic.h>
+#endif
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief Operations performed by a container, as counted in builds with HLC_COUNTERS defined.
+/// @details Operations running on a hlc_Task_pool aren't counted.
+typedef struct hlc_Counters {
+  size_t lookups;
+  size_t lookup_comparisons;
+  size_t insertions;
+  size_t insertion_comparisons;
+  size_t removals;
+  size_t removal_comparisons;
+  size_t rotations;
+  size_t rebalance_iterations;
+  size_t allocations;
+  size_t frees;
+  size_t assigns;
+  size_t reassigns;
+} hlc_Counters;
+
+#ifdef HLC_COUNTERS
+  /// @brief The counters containers embed, which are atomic so that concurrent const operations, such as lookups, can
+  /// count without racing.
+  typedef struct hlc_Atomic_counters {
+    atomic_size_t lookups;
+    atomic_size_t lookup_comparisons;
+    atomic_size_t insertions;
+    atomic_size_t insertion_comparisons;
+    atomic_size_t removals;
+    atomic_size_t removal_comparisons;
+    atomic_size_t rotations;
+    atomic_size_t rebalance_iterations;
+    atomic_size_t allocations;
+    atomic_size_t frees;
+    atomic_size_t assigns;
+    atomic_size_t reassigns;
+  } hlc_Atomic_counters;
+
+  /// @brief The counters which hlc_AVL operations on the current thread report to, if any.
+  extern HLC_THREAD_LOCAL hlc_Atomic_counters* hlc_counters_current;
+
+  /// @brief Sets all counters to zero.
+  /// @pre counters != NULL
+  HLC_API void hlc_counters_reset(hlc_Atomic_counters* counters);
+
+  /// @brief Returns the current values of the counters.
+  /// @pre counters != NULL
+  HLC_API hlc_Counters hlc_counters_load(const hlc_Atomic_counters* counters);
+
+  /// @brief Increments a counter of a container. Containers may be const, since counters aren't part of their state.
+  #define HLC_COUNT(counters, counter) \
+    ((void)atomic_fetch_add_explicit(&((hlc_Atomic_counters*)(counters))->counter, 1, memory_order_relaxed))
+
+  /// @brief Makes hlc_AVL operations on the current thread report to the given counters, until HLC_COUNTERS_LEAVE
+  /// restores the counters reported to before, which must follow in the same block. Operations may thus nest, for
+  /// example when a trait operates on another container.
+  #define HLC_COUNTERS_ENTER(counters)                                       \
+    hlc_Atomic_counters* const hlc_counters_previous = hlc_counters_current; \
+    hlc_counters_current = (hlc_Atomic_counters*)(counters)
+
+  #define HLC_COUNTERS_LEAVE() ((void)(hlc_counters_current = hlc_counters_previous))
+
+  /// @brief Increments a counter of the container which is currently being operated on, if any.
+  #define HLC_COUNT_CURRENT(counter) \
+    (hlc_counters_current != NULL ? HLC_COUNT(hlc_counters_current, counter) : (void)0)
+#else
+  #define HLC_COUNT(counters, counter) ((void)0)
+  #define HLC_COUNTERS_ENTER(counters) ((void)0)
+  #define HLC_COUNTERS_LEAVE() ((void)0)
+  #define HLC_COUNT_CURRENT(counter) ((void)0)
+#endif
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -0,0 +1,79 @@
+#include "eytzinger.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "layout.h"
+#include "prefetch.h"
+#include "traits/compare.h"
+
+
+size_t hlc_eytzinger_first(size_t count) {
+  if (count == 0)
+    return 0;
+
+  size_t index = 1;
+
+  while (2 * index <= count) {
+    index = 2 * index;
+  }
+
+  return index;
+}
+
+
+size_t hlc_eytzinger_next(size_t index, size_t count) {
+  assert(index >= 1 && index <= count);
+
+  if (2 * index + 1 <= count) {
+    index = 2 * index + 1;
+
+    while (2 * index <= count) {
+      index = 2 * index;
+    }
+
+    return index;
+  }
+
+  // Climb while we are a right child, then once more to reach the parent of which we are in the left subtree:
+
+  while ((index & 1) != 0) {
+    index >>= 1;
+  }
+
+  return index >> 1;
+}
+
+
+size_t hlc_eytzinger_search(
+  const void* elements,
+  size_t count,
+  hlc_Layout element_layout,
+  const void* key,
+  hlc_Compare_instance element_compare_instance
+) {
+  assert(elements != NULL || count == 0);
+
+  const char* base = elements;
+  size_t index = 1;
+
+  // The descent doesn't branch on the comparison: the outcome only selects the next index. The four grandchildren of
+  // an element are contiguous, so they are prefetched two levels ahead of when they are needed.
+
+  while (index <= count) {
+    if (4 * index <= count) {
+      HLC_PREFETCH(base + (4 * index - 1) * element_layout.size);
+    }
+
+    signed char ordering = hlc_compare(key, base + (index - 1) * element_layout.size, element_compare_instance);
+    index = 2 * index + (ordering > 0);
+  }
+
+  // The path taken is encoded in the bits of the index; the last left turn leads to the lower bound:
+
+  while ((index & 1) != 0) {
+    index >>= 1;
+  }
+
+  return index >> 1;
+}
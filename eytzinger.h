@@ -0,0 +1,36 @@
+#ifndef HLC_EYTZINGER_H
+#define HLC_EYTZINGER_H
+
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+#include "traits/compare.h"
+
+HLC_DECLARATIONS_BEGIN
+
+// Eytzinger arrays store a complete binary search tree in breadth-first order: indices are 1-based, and the children
+// of the element at index i are at indices 2i and 2i + 1. Index 0 is used as a sentinel meaning "no element".
+
+/// @brief Returns the index of the first element in in-order, or 0 if count == 0.
+HLC_API size_t hlc_eytzinger_first(size_t count);
+
+/// @brief Returns the index of the in-order successor of the element at the given index, or 0 if there is none.
+/// @pre index >= 1 && index <= count
+HLC_API size_t hlc_eytzinger_next(size_t index, size_t count);
+
+/// @brief Finds the first element which is not less than the given key.
+/// @param elements The elements, each taking element_layout.size bytes (which should be a multiple of the alignment).
+/// @return The index of the element, or 0 if all elements are less than the key.
+/// @pre elements != NULL || count == 0
+HLC_API size_t hlc_eytzinger_search(
+  const void* elements,
+  size_t count,
+  hlc_Layout element_layout,
+  const void* key,
+  hlc_Compare_instance element_compare_instance
+);
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -0,0 +1,341 @@
+#include "intern.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/string.h"
+
+
+/// @brief The size of the blocks which copies are carved from. Larger copies get a block of their own.
+#define HLC_INTERN_BLOCK_SIZE 65536
+
+/// @brief The initial capacity of the hash table, which must be a power of two.
+#define HLC_INTERN_MIN_CAPACITY 16
+
+
+typedef struct hlc_Intern_entry {
+  size_t size;
+  char bytes[];
+} hlc_Intern_entry;
+
+
+/// @brief A slot of the hash table, which keeps the full hash so that probes rarely compare bytes.
+typedef struct hlc_Intern_slot {
+  unsigned long long hash;
+  const hlc_Intern_entry* entry;
+} hlc_Intern_slot;
+
+
+struct hlc_Intern {
+  // An open addressing hash table with linear probing, at most 3/4 full:
+  hlc_Intern_slot* slots;
+  size_t capacity;
+  size_t count;
+
+  // The most recent block, whose first bytes link to the previous one, and its part which is still free:
+  void* blocks;
+  char* next;
+  char* end;
+};
+
+const hlc_Layout hlc_intern_layout = {.size = sizeof(hlc_Intern), .alignment = alignof(hlc_Intern)};
+
+
+void hlc_intern_create(hlc_Intern* intern) {
+  assert(intern != NULL);
+
+  intern->slots = NULL;
+  intern->capacity = 0;
+  intern->count = 0;
+  intern->blocks = NULL;
+  intern->next = NULL;
+  intern->end = NULL;
+}
+
+
+size_t hlc_intern_count(const hlc_Intern* intern) {
+  assert(intern != NULL);
+  return intern->count;
+}
+
+
+/// @brief Hashes bytes 8 at a time, mixing each word with a multiply and a shift, then finalizing like splitmix64.
+static unsigned long long hlc_intern_hash(const unsigned char* bytes, size_t size) {
+  unsigned long long hash = 0x9E3779B97F4A7C15ULL ^ size;
+  size_t i = 0;
+
+  for (; i + 8 <= size; i += 8) {
+    unsigned long long word;
+    memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 31;
+  }
+
+  unsigned long long tail = 0;
+
+  for (; i < size; ++i) {
+    tail = tail << 8 | bytes[i];
+  }
+
+  hash ^= tail;
+  hash ^= hash >> 30;
+  hash *= 0xBF58476D1CE4E5B9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94D049BB133111EBULL;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+
+/// @brief Doubles the capacity of the hash table.
+/// @return true on success, false on insufficient memory.
+static bool hlc_intern_grow(hlc_Intern* intern) {
+  size_t capacity = intern->capacity > 0 ? intern->capacity * 2 : HLC_INTERN_MIN_CAPACITY;
+  hlc_Intern_slot* slots = calloc(capacity, sizeof(hlc_Intern_slot));
+
+  if (slots == NULL)
+    return false;
+
+  for (size_t i = 0; i < intern->capacity; ++i) {
+    const hlc_Intern_slot* slot = &intern->slots[i];
+
+    if (slot->entry != NULL) {
+      size_t j = (size_t)slot->hash & (capacity - 1);
+
+      while (slots[j].entry != NULL) {
+        j = (j + 1) & (capacity - 1);
+      }
+
+      slots[j] = *slot;
+    }
+  }
+
+  free(intern->slots);
+  intern->slots = slots;
+  intern->capacity = capacity;
+  return true;
+}
+
+
+/// @brief Allocates memory for a new entry from the blocks.
+/// @return The memory on success, or NULL on insufficient memory.
+static hlc_Intern_entry* hlc_intern_allocate(hlc_Intern* intern, size_t size) {
+  hlc_Layout entry_layout = {
+    .size = offsetof(hlc_Intern_entry, bytes) + size + 1,
+    .alignment = alignof(hlc_Intern_entry),
+  };
+
+  hlc_layout_pad(&entry_layout);
+
+  hlc_Layout block_layout = HLC_LAYOUT_OF(void*);
+  size_t entry_offset = hlc_layout_add(&block_layout, entry_layout);
+
+  size_t available = intern->next != NULL ? (size_t)(intern->end - intern->next) : 0;
+
+  if (entry_layout.size > available) {
+    if (entry_offset + entry_layout.size > HLC_INTERN_BLOCK_SIZE / 4) {
+      // Large copies get a block of their own, linked behind the current one, which keeps its free part.
+      void* block = malloc(entry_offset + entry_layout.size);
+
+      if (block == NULL)
+        return NULL;
+
+      if (intern->blocks != NULL) {
+        *(void**)block = *(void**)intern->blocks;
+        *(void**)intern->blocks = block;
+      } else {
+        *(void**)block = NULL;
+        intern->blocks = block;
+      }
+
+      return (hlc_Intern_entry*)((char*)block + entry_offset);
+    }
+
+    void* block = malloc(HLC_INTERN_BLOCK_SIZE);
+
+    if (block == NULL)
+      return NULL;
+
+    *(void**)block = intern->blocks;
+    intern->blocks = block;
+    intern->next = (char*)block + entry_offset;
+    intern->end = (char*)block + HLC_INTERN_BLOCK_SIZE;
+  }
+
+  hlc_Intern_entry* entry = (hlc_Intern_entry*)intern->next;
+  intern->next += entry_layout.size;
+  return entry;
+}
+
+
+const char* hlc_intern(hlc_Intern* intern, const void* bytes, size_t size) {
+  assert(intern != NULL);
+  assert(bytes != NULL || size == 0);
+
+  unsigned long long hash = hlc_intern_hash(bytes, size);
+
+  if (intern->capacity > 0) {
+    size_t i = (size_t)hash & (intern->capacity - 1);
+
+    for (; intern->slots[i].entry != NULL; i = (i + 1) & (intern->capacity - 1)) {
+      const hlc_Intern_slot* slot = &intern->slots[i];
+
+      if (slot->hash == hash && slot->entry->size == size) {
+        if (size == 0 || memcmp(slot->entry->bytes, bytes, size) == 0)
+          return slot->entry->bytes;
+      }
+    }
+  }
+
+  if ((intern->count + 1) * 4 > intern->capacity * 3 && !hlc_intern_grow(intern))
+    return NULL;
+
+  hlc_Intern_entry* entry = hlc_intern_allocate(intern, size);
+
+  if (entry == NULL)
+    return NULL;
+
+  entry->size = size;
+
+  if (size > 0) {
+    memcpy(entry->bytes, bytes, size);
+  }
+
+  entry->bytes[size] = '\0';
+
+  size_t i = (size_t)hash & (intern->capacity - 1);
+
+  while (intern->slots[i].entry != NULL) {
+    i = (i + 1) & (intern->capacity - 1);
+  }
+
+  intern->slots[i] = (hlc_Intern_slot){.hash = hash, .entry = entry};
+  intern->count += 1;
+  return entry->bytes;
+}
+
+
+void hlc_intern_destroy(hlc_Intern* intern) {
+  assert(intern != NULL);
+
+  void* block = intern->blocks;
+
+  while (block != NULL) {
+    void* previous = *(void**)block;
+    free(block);
+    block = previous;
+  }
+
+  free(intern->slots);
+}
+
+
+static bool hlc_intern_cstring_assign(
+  void* _target,
+  const void* _source,
+  const hlc_Assign_trait* trait,
+  void* context
+) {
+  const char** target = _target;
+  const char* const* source = _source;
+  (void)trait;
+
+  assert(target != NULL);
+  assert(source != NULL && *source != NULL);
+
+  const char* copy = hlc_intern(context, *source, strlen(*source));
+
+  if (copy == NULL)
+    return false;
+
+  *target = copy;
+  return true;
+}
+
+
+static bool hlc_intern_cstring_reassign(
+  void* _target,
+  const void* _source,
+  const hlc_Assign_trait* trait,
+  void* context
+) {
+  const char** target = _target;
+  const char* const* source = _source;
+
+  assert(target != NULL && *target != NULL);
+  assert(source != NULL && *source != NULL);
+
+  // Copies are never freed, so the previous one can simply be forgotten.
+  if (*target == *source || strcmp(*target, *source) == 0)
+    return true;
+
+  return hlc_intern_cstring_assign(target, source, trait, context);
+}
+
+
+static const hlc_Assign_trait hlc_intern_cstring_assign_trait = {
+  .assign = hlc_intern_cstring_assign,
+  .reassign = hlc_intern_cstring_reassign,
+};
+
+
+hlc_Assign_instance hlc_intern_cstring_assign_instance(hlc_Intern* intern) {
+  assert(intern != NULL);
+  return (hlc_Assign_instance){.trait = &hlc_intern_cstring_assign_trait, .context = intern};
+}
+
+
+static bool hlc_intern_bytes_assign(void* _target, const void* _source, const hlc_Assign_trait* trait, void* context) {
+  hlc_Bytes* target = _target;
+  const hlc_Bytes* source = _source;
+  (void)trait;
+
+  assert(target != NULL);
+  assert(source != NULL && (source->data != NULL || source->size == 0));
+
+  const char* copy = hlc_intern(context, source->data, source->size);
+
+  if (copy == NULL)
+    return false;
+
+  target->size = source->size;
+  target->data = copy;
+  return true;
+}
+
+
+static bool hlc_intern_bytes_reassign(
+  void* _target,
+  const void* _source,
+  const hlc_Assign_trait* trait,
+  void* context
+) {
+  hlc_Bytes* target = _target;
+  const hlc_Bytes* source = _source;
+
+  assert(target != NULL);
+  assert(source != NULL);
+
+  if (hlc_compare(target, source, hlc_bytes_compare_instance) == 0)
+    return true;
+
+  return hlc_intern_bytes_assign(target, source, trait, context);
+}
+
+
+static const hlc_Assign_trait hlc_intern_bytes_assign_trait = {
+  .assign = hlc_intern_bytes_assign,
+  .reassign = hlc_intern_bytes_reassign,
+};
+
+
+hlc_Assign_instance hlc_intern_bytes_assign_instance(hlc_Intern* intern) {
+  assert(intern != NULL);
+  return (hlc_Assign_instance){.trait = &hlc_intern_bytes_assign_trait, .context = intern};
+}
@@ -0,0 +1,58 @@
+#ifndef HLC_INTERN_H
+#define HLC_INTERN_H
+
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+#include "traits/assign.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief A set of strings, each stored once in blocks of memory owned by the interner. Interning a string which is
+/// already in the set returns the existing copy without allocating, so equal strings share a single copy.
+/// @details Copies live until the interner is destroyed, which frees them all at once. Interners aren't thread-safe.
+typedef struct hlc_Intern hlc_Intern;
+
+/// @memberof hlc_Intern
+extern HLC_API const hlc_Layout hlc_intern_layout;
+
+/// @memberof hlc_Intern
+/// @brief Creates an empty interner.
+/// @pre intern != NULL
+HLC_API void hlc_intern_create(hlc_Intern* intern);
+
+/// @memberof hlc_Intern
+/// @brief Returns the number of distinct strings in this interner.
+/// @pre intern != NULL
+HLC_API size_t hlc_intern_count(const hlc_Intern* intern);
+
+/// @memberof hlc_Intern
+/// @brief Returns the copy of the given bytes owned by this interner, copying them first if needed. Copies are followed
+/// by a NUL byte, so interned NUL-terminated strings remain NUL-terminated.
+/// @return The copy on success, or NULL on insufficient memory.
+/// @pre intern != NULL && (bytes != NULL || size == 0)
+HLC_API const char* hlc_intern(hlc_Intern* intern, const void* bytes, size_t size);
+
+/// @memberof hlc_Intern
+/// @brief Destroys this interner and all its copies.
+/// @pre intern != NULL
+HLC_API void hlc_intern_destroy(hlc_Intern* intern);
+
+/// @memberof hlc_Intern
+/// @brief Returns an instance which assigns elements of type const char* with interned copies of NUL-terminated
+/// strings. Such elements compare with hlc_cstring_compare_instance and need no destruction (hlc_no_destroy_instance).
+/// @details The instance must not be used by parallel operations, such as hlc_map_parallel_clone.
+/// @pre intern != NULL
+HLC_API hlc_Assign_instance hlc_intern_cstring_assign_instance(hlc_Intern* intern);
+
+/// @memberof hlc_Intern
+/// @brief Returns an instance which assigns elements of type hlc_Bytes with interned copies of byte strings. Such
+/// elements compare with hlc_bytes_compare_instance and need no destruction (hlc_no_destroy_instance).
+/// @details The instance must not be used by parallel operations, such as hlc_map_parallel_clone.
+/// @pre intern != NULL
+HLC_API hlc_Assign_instance hlc_intern_bytes_assign_instance(hlc_Intern* intern);
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -0,0 +1,460 @@
+#include "interval.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "avl.h"
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/augment.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+
+struct hlc_Interval_map {
+  hlc_AVL* root;
+  size_t count;
+  hlc_Layout point_layout;
+  hlc_Layout value_layout;
+  hlc_Compare_instance point_compare_instance;
+  hlc_Destroy_instance value_destroy_instance;
+
+  // Nodes hold entries made of the lower bound, the upper bound, the maximum upper bound over the subtree of the node,
+  // and the value:
+  hlc_Layout entry_layout;
+  size_t hi_offset;
+  size_t max_hi_offset;
+  size_t value_offset;
+  hlc_Destroy_trait entry_destroy_trait;
+};
+
+const hlc_Layout hlc_interval_map_layout = {.size = sizeof(hlc_Interval_map), .alignment = alignof(hlc_Interval_map)};
+
+
+static inline hlc_Interval_map_kv_ref hlc_interval_map_kv_ref(const hlc_Interval_map* map, const void* entry) {
+  return (hlc_Interval_map_kv_ref){
+    .lo = entry,
+    .hi = (const char*)entry + map->hi_offset,
+    .value = (char*)entry + map->value_offset,
+  };
+}
+
+
+static inline const void* hlc_interval_map_max_hi(const hlc_Interval_map* map, const void* entry) {
+  return (const char*)entry + map->max_hi_offset;
+}
+
+
+/// @brief Recomputes the maximum upper bound over the subtree of a node.
+static bool hlc_interval_map_augment_update(
+  void* entry,
+  const void* left,
+  const void* right,
+  const hlc_Augment_trait* trait,
+  void* _map
+) {
+  (void)trait;
+  const hlc_Interval_map* map = _map;
+
+  assert(entry != NULL);
+
+  const void* max_hi = (const char*)entry + map->hi_offset;
+
+  if (left != NULL && hlc_compare(hlc_interval_map_max_hi(map, left), max_hi, map->point_compare_instance) > 0) {
+    max_hi = hlc_interval_map_max_hi(map, left);
+  }
+
+  if (right != NULL && hlc_compare(hlc_interval_map_max_hi(map, right), max_hi, map->point_compare_instance) > 0) {
+    max_hi = hlc_interval_map_max_hi(map, right);
+  }
+
+  void* entry_max_hi = (char*)entry + map->max_hi_offset;
+
+  if (hlc_compare(max_hi, entry_max_hi, map->point_compare_instance) == 0)
+    return false;
+
+  memcpy(entry_max_hi, max_hi, map->point_layout.size);
+  return true;
+}
+
+
+static const hlc_Augment_trait hlc_interval_map_augment_trait = {
+  .update = hlc_interval_map_augment_update,
+};
+
+
+static inline hlc_Augment_instance hlc_interval_map_augment_instance(const hlc_Interval_map* map) {
+  return (hlc_Augment_instance){.trait = &hlc_interval_map_augment_trait, .context = (void*)map};
+}
+
+
+#ifndef NDEBUG
+
+/// @brief Checks that the maximum upper bounds of a subtree are current, for assertions.
+/// @param max_hi Receives the maximum upper bound of the subtree, if it isn't empty.
+static bool hlc_interval_map_check(const hlc_Interval_map* map, const hlc_AVL* node, const void** max_hi) {
+  if (node == NULL)
+    return true;
+
+  const void* entry = hlc_avl_element(node, map->entry_layout);
+  *max_hi = (const char*)entry + map->hi_offset;
+
+  for (signed char direction = -1; direction <= +1; direction += 2) {
+    const void* child_max_hi = NULL;
+
+    if (!hlc_interval_map_check(map, hlc_avl_link(node, direction), &child_max_hi))
+      return false;
+
+    if (child_max_hi != NULL && hlc_compare(child_max_hi, *max_hi, map->point_compare_instance) > 0) {
+      *max_hi = child_max_hi;
+    }
+  }
+
+  return hlc_compare(*max_hi, hlc_interval_map_max_hi(map, entry), map->point_compare_instance) == 0;
+}
+
+#endif
+
+
+/// @brief Compares an interval, given as a hlc_Interval_map_kv_ref, with the interval of an entry by their lower then
+/// upper bounds, in the context of its map.
+static signed char hlc_interval_map_entry_compare(
+  const void* _interval,
+  const void* entry,
+  const hlc_Compare_trait* trait,
+  void* context
+) {
+  const hlc_Interval_map_kv_ref* interval = _interval;
+  (void)trait;
+  const hlc_Interval_map* map = context;
+
+  signed char ordering = hlc_compare(interval->lo, entry, map->point_compare_instance);
+
+  if (ordering != 0)
+    return ordering;
+
+  return hlc_compare(interval->hi, (const char*)entry + map->hi_offset, map->point_compare_instance);
+}
+
+
+static const hlc_Compare_trait hlc_interval_map_entry_compare_trait = {
+  .compare = hlc_interval_map_entry_compare,
+};
+
+
+/// @brief Searches for an interval.
+/// @param ordering Receives 0 if the interval was found, or else the side of the returned node where it would be
+/// inserted.
+/// @return The node holding the interval if it was found, else the last node visited, or NULL if the interval map is
+/// empty.
+static hlc_AVL* hlc_interval_map_search(
+  const hlc_Interval_map* map,
+  const void* lo,
+  const void* hi,
+  signed char* ordering
+) {
+  hlc_Interval_map_kv_ref interval = {.lo = lo, .hi = hi, .value = NULL};
+  hlc_Compare_instance entry_compare_instance = {.trait = &hlc_interval_map_entry_compare_trait, .context = (void*)map};
+  return hlc_avl_search(map->root, map->entry_layout, &interval, 0, entry_compare_instance, ordering);
+}
+
+
+/// @brief Destroys an entry, in the context of its map.
+static void hlc_interval_map_entry_destroy(void* target, const hlc_Destroy_trait* trait, void* context) {
+  (void)trait;
+  const hlc_Interval_map* map = context;
+
+  assert(target != NULL);
+  assert(map != NULL);
+
+  hlc_destroy((char*)target + map->value_offset, map->value_destroy_instance);
+}
+
+
+static inline hlc_Destroy_instance hlc_interval_map_entry_destroy_instance(const hlc_Interval_map* map) {
+  return (hlc_Destroy_instance){.trait = &map->entry_destroy_trait, .context = (void*)map};
+}
+
+
+void hlc_interval_map_create(
+  hlc_Interval_map* map,
+  hlc_Layout point_layout,
+  hlc_Layout value_layout,
+  hlc_Compare_instance point_compare_instance,
+  hlc_Destroy_instance value_destroy_instance
+) {
+  assert(map != NULL);
+
+  map->root = NULL;
+  map->count = 0;
+  map->point_layout = point_layout;
+  map->value_layout = value_layout;
+  map->point_compare_instance = point_compare_instance;
+  map->value_destroy_instance = value_destroy_instance;
+
+  map->entry_layout = point_layout;
+  map->hi_offset = hlc_layout_add(&map->entry_layout, point_layout);
+  map->max_hi_offset = hlc_layout_add(&map->entry_layout, point_layout);
+  map->value_offset = hlc_layout_add(&map->entry_layout, value_layout);
+  hlc_layout_pad(&map->entry_layout);
+
+  map->entry_destroy_trait = (hlc_Destroy_trait){
+    .destroy = hlc_interval_map_entry_destroy,
+    .trivial = value_destroy_instance.trait->trivial,
+  };
+}
+
+
+size_t hlc_interval_map_count(const hlc_Interval_map* map) {
+  assert(map != NULL);
+  return map->count;
+}
+
+
+typedef struct hlc_Interval_map_entry_assign_context {
+  const hlc_Interval_map* map;
+  hlc_Assign_instance value_assign_instance;
+} hlc_Interval_map_entry_assign_context;
+
+
+/// @brief Assigns the entry of a new node from a hlc_Interval_map_kv_ref, as a leaf whose subtree is the interval.
+static bool hlc_interval_map_entry_assign(
+  void* target,
+  const void* _source,
+  const hlc_Assign_trait* trait,
+  void* _context
+) {
+  const hlc_Interval_map_kv_ref* source = _source;
+  (void)trait;
+  const hlc_Interval_map_entry_assign_context* context = _context;
+  const hlc_Interval_map* map = context->map;
+
+  assert(target != NULL);
+  assert(source != NULL);
+
+  void* value = (char*)target + map->value_offset;
+
+  if (!hlc_assign_sized(value, source->value, map->value_layout.size, context->value_assign_instance))
+    return false;
+
+  memcpy(target, source->lo, map->point_layout.size);
+  memcpy((char*)target + map->hi_offset, source->hi, map->point_layout.size);
+  memcpy((char*)target + map->max_hi_offset, source->hi, map->point_layout.size);
+  return true;
+}
+
+
+static const hlc_Assign_trait hlc_interval_map_entry_assign_trait = {
+  .assign = hlc_interval_map_entry_assign,
+};
+
+
+bool hlc_interval_map_insert(
+  hlc_Interval_map* map,
+  const void* lo,
+  const void* hi,
+  const void* value,
+  hlc_Assign_instance value_assign_instance
+) {
+  assert(map != NULL);
+  assert(hlc_compare(lo, hi, map->point_compare_instance) <= 0);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_interval_map_search(map, lo, hi, &ordering);
+
+  if (node != NULL && ordering == 0) {
+    void* node_value = hlc_interval_map_kv_ref(map, hlc_avl_element(node, map->entry_layout)).value;
+    return hlc_reassign_sized(node_value, value, map->value_layout.size, value_assign_instance);
+  }
+
+  hlc_Interval_map_kv_ref kv_ref = {.lo = lo, .hi = hi, .value = (void*)value};
+
+  hlc_Interval_map_entry_assign_context entry_assign_context = {
+    .map = map,
+    .value_assign_instance = value_assign_instance,
+  };
+
+  hlc_Assign_instance entry_assign_instance = {
+    .trait = &hlc_interval_map_entry_assign_trait,
+    .context = &entry_assign_context,
+  };
+
+  if (node != NULL) {
+    node = hlc_avl_insert_augmented(
+      node,
+      ordering,
+      &kv_ref,
+      map->entry_layout,
+      entry_assign_instance,
+      hlc_interval_map_augment_instance(map)
+    );
+  } else {
+    node = hlc_avl_new(&kv_ref, map->entry_layout, entry_assign_instance);
+  }
+
+  if (node == NULL)
+    return false;
+
+  if (hlc_avl_link(node, 0) == NULL) {
+    map->root = node;
+  }
+
+  map->count += 1;
+  assert(map->count == hlc_avl_count(map->root));
+  assert(hlc_interval_map_check(map, map->root, &(const void*){NULL}));
+  return true;
+}
+
+
+bool hlc_interval_map_remove(hlc_Interval_map* map, const void* lo, const void* hi) {
+  assert(map != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_interval_map_search(map, lo, hi, &ordering);
+
+  if (node == NULL || ordering != 0)
+    return false;
+
+  node = hlc_avl_remove_augmented(
+    node,
+    map->entry_layout,
+    hlc_interval_map_entry_destroy_instance(map),
+    hlc_interval_map_augment_instance(map)
+  );
+
+  if (node == NULL || hlc_avl_link(node, 0) == NULL) {
+    map->root = node;
+  }
+
+  map->count -= 1;
+  assert(map->count == hlc_avl_count(map->root));
+  assert(hlc_interval_map_check(map, map->root, &(const void*){NULL}));
+  return true;
+}
+
+
+void* (hlc_interval_map_lookup)(const hlc_Interval_map* map, const void* lo, const void* hi) {
+  assert(map != NULL);
+
+  signed char ordering;
+  const hlc_AVL* node = hlc_interval_map_search(map, lo, hi, &ordering);
+
+  if (node == NULL || ordering != 0)
+    return NULL;
+
+  return hlc_interval_map_kv_ref(map, hlc_avl_element(node, map->entry_layout)).value;
+}
+
+
+/// @brief Visits the intervals of a subtree which overlap [lo, hi], in order.
+/// @details Subtrees whose maximum upper bound is below lo hold no match, and neither do the nodes following one whose
+/// lower bound is above hi. Only left subtrees are visited recursively, so the recursion is bounded by the height.
+/// @return true if all matching intervals were visited, false if the callback stopped the iteration.
+static bool hlc_interval_map_visit_overlaps(
+  const hlc_Interval_map* map,
+  const hlc_AVL* node,
+  const void* lo,
+  const void* hi,
+  bool (*callback)(hlc_Interval_map_kv_ref kv_ref, void* context),
+  void* context
+) {
+  while (node != NULL) {
+    const void* entry = hlc_avl_element(node, map->entry_layout);
+
+    if (hlc_compare(hlc_interval_map_max_hi(map, entry), lo, map->point_compare_instance) < 0)
+      return true;
+
+    if (!hlc_interval_map_visit_overlaps(map, hlc_avl_link(node, -1), lo, hi, callback, context))
+      return false;
+
+    hlc_Interval_map_kv_ref kv_ref = hlc_interval_map_kv_ref(map, entry);
+
+    if (hlc_compare(kv_ref.lo, hi, map->point_compare_instance) > 0)
+      return true;
+
+    if (hlc_compare(kv_ref.hi, lo, map->point_compare_instance) >= 0 && !callback(kv_ref, context))
+      return false;
+
+    node = hlc_avl_link(node, +1);
+  }
+
+  return true;
+}
+
+
+bool hlc_interval_map_stab(
+  const hlc_Interval_map* map,
+  const void* point,
+  bool (*callback)(hlc_Interval_map_kv_ref kv_ref, void* context),
+  void* context
+) {
+  assert(map != NULL);
+  assert(callback != NULL);
+
+  return hlc_interval_map_visit_overlaps(map, map->root, point, point, callback, context);
+}
+
+
+bool hlc_interval_map_overlaps(
+  const hlc_Interval_map* map,
+  const void* lo,
+  const void* hi,
+  bool (*callback)(hlc_Interval_map_kv_ref kv_ref, void* context),
+  void* context
+) {
+  assert(map != NULL);
+  assert(hlc_compare(lo, hi, map->point_compare_instance) <= 0);
+  assert(callback != NULL);
+
+  return hlc_interval_map_visit_overlaps(map, map->root, lo, hi, callback, context);
+}
+
+
+void hlc_interval_map_clear(hlc_Interval_map* map) {
+  assert(map != NULL);
+
+  hlc_interval_map_destroy(map);
+  map->root = NULL;
+  map->count = 0;
+}
+
+
+void hlc_interval_map_destroy(hlc_Interval_map* map) {
+  assert(map != NULL);
+
+  hlc_avl_delete(map->root, map->entry_layout, hlc_interval_map_entry_destroy_instance(map));
+}
+
+
+typedef struct hlc_Interval_map_for_each_context {
+  const hlc_Interval_map* map;
+  bool (*callback)(hlc_Interval_map_kv_ref kv_ref, void* context);
+  void* context;
+} hlc_Interval_map_for_each_context;
+
+
+static bool hlc_interval_map_visit(const void* entry, void* _context) {
+  const hlc_Interval_map_for_each_context* context = _context;
+  return context->callback(hlc_interval_map_kv_ref(context->map, entry), context->context);
+}
+
+
+bool hlc_interval_map_for_each(
+  const hlc_Interval_map* map,
+  bool (*callback)(hlc_Interval_map_kv_ref kv_ref, void* context),
+  void* context
+) {
+  assert(map != NULL);
+  assert(callback != NULL);
+
+  hlc_Interval_map_for_each_context for_each_context = {
+    .map = map,
+    .callback = callback,
+    .context = context,
+  };
+
+  return hlc_avl_for_each(map->root, map->entry_layout, hlc_interval_map_visit, &for_each_context);
+}
@@ -0,0 +1,133 @@
+#ifndef HLC_INTERVAL_H
+#define HLC_INTERVAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief A map from closed intervals [lo, hi] to values, which finds the intervals containing a point or overlapping
+/// another interval.
+/// @details Intervals are ordered by their lower bound, then by their upper bound. Each node also holds the maximum
+/// upper bound of its subtree, which the AVL tree keeps current through its rotations, so that queries skip every
+/// subtree ending before the point or interval they look for. Bounds are copied with memcpy and never destroyed.
+typedef struct hlc_Interval_map hlc_Interval_map;
+
+/// @memberof hlc_Interval_map
+extern HLC_API const hlc_Layout hlc_interval_map_layout;
+
+/// @relates hlc_Interval_map
+typedef struct hlc_Interval_map_kv_ref {
+  const void* lo;
+  const void* hi;
+  void* value;
+} hlc_Interval_map_kv_ref;
+
+/// @memberof hlc_Interval_map
+/// @brief Creates an empty interval map.
+/// @param point_layout The layout of the bounds of the intervals, which must be trivially copyable.
+/// @pre map != NULL
+HLC_API void hlc_interval_map_create(
+  hlc_Interval_map* map,
+  hlc_Layout point_layout,
+  hlc_Layout value_layout,
+  hlc_Compare_instance point_compare_instance,
+  hlc_Destroy_instance value_destroy_instance
+);
+
+/// @memberof hlc_Interval_map
+/// @brief Returns the number of intervals in this interval map.
+/// @pre map != NULL
+HLC_API size_t hlc_interval_map_count(const hlc_Interval_map* map);
+
+/// @memberof hlc_Interval_map
+/// @brief Inserts an interval and its value into this interval map, or reassigns the value if the interval is already
+/// in it.
+/// @return true on success, false on insufficient memory.
+/// @pre map != NULL && lo <= hi
+HLC_API bool hlc_interval_map_insert(
+  hlc_Interval_map* map,
+  const void* lo,
+  const void* hi,
+  const void* value,
+  hlc_Assign_instance value_assign_instance
+);
+
+/// @memberof hlc_Interval_map
+/// @brief Removes an interval from this interval map.
+/// @return true on success, false if the interval was not in this interval map.
+/// @pre map != NULL
+HLC_API bool hlc_interval_map_remove(hlc_Interval_map* map, const void* lo, const void* hi);
+
+/// @memberof hlc_Interval_map
+/// @brief Returns the value corresponding to the given interval, if any.
+/// @return The value on success, or NULL if the interval wasn't in this interval map.
+/// @pre map != NULL
+HLC_API void* hlc_interval_map_lookup(const hlc_Interval_map* map, const void* lo, const void* hi);
+
+/// @memberof hlc_Interval_map
+/// @brief Returns the value corresponding to the given interval, if any.
+/// @return The value on success, or NULL if the interval wasn't in this interval map.
+/// @pre map != NULL
+#define hlc_interval_map_lookup(map, lo, hi) _Generic(                 \
+  true ? (map) : (void*)(map),                                         \
+  void*: hlc_interval_map_lookup((map), (lo), (hi)),                   \
+  const void*: (const void*)hlc_interval_map_lookup((map), (lo), (hi)) \
+)
+
+/// @memberof hlc_Interval_map
+/// @brief Calls the callback on each interval of this interval map which contains the given point, in order, until
+/// the callback returns false.
+/// @details Takes O(log n + k log(n / k)) time to report k intervals.
+/// @return true if all matching intervals were visited, false if the callback stopped the iteration.
+/// @pre map != NULL && callback != NULL
+HLC_API bool hlc_interval_map_stab(
+  const hlc_Interval_map* map,
+  const void* point,
+  bool (*callback)(hlc_Interval_map_kv_ref kv_ref, void* context),
+  void* context
+);
+
+/// @memberof hlc_Interval_map
+/// @brief Calls the callback on each interval of this interval map which overlaps [lo, hi], in order, until the
+/// callback returns false.
+/// @details Takes O(log n + k log(n / k)) time to report k intervals.
+/// @return true if all matching intervals were visited, false if the callback stopped the iteration.
+/// @pre map != NULL && lo <= hi && callback != NULL
+HLC_API bool hlc_interval_map_overlaps(
+  const hlc_Interval_map* map,
+  const void* lo,
+  const void* hi,
+  bool (*callback)(hlc_Interval_map_kv_ref kv_ref, void* context),
+  void* context
+);
+
+/// @memberof hlc_Interval_map
+/// @brief Clears this interval map.
+/// @pre map != NULL
+HLC_API void hlc_interval_map_clear(hlc_Interval_map* map);
+
+/// @memberof hlc_Interval_map
+/// @brief Destroys this interval map.
+/// @pre map != NULL
+HLC_API void hlc_interval_map_destroy(hlc_Interval_map* map);
+
+/// @memberof hlc_Interval_map
+/// @brief Calls the callback on each interval of this interval map, in order, until the callback returns false.
+/// @return true if all intervals were visited, false if the callback stopped the iteration.
+/// @pre map != NULL && callback != NULL
+HLC_API bool hlc_interval_map_for_each(
+  const hlc_Interval_map* map,
+  bool (*callback)(hlc_Interval_map_kv_ref kv_ref, void* context),
+  void* context
+);
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -0,0 +1,424 @@
+#include "lru.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "avl.h"
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+
+/// @brief The start of each entry, which links its node into the recency list.
+typedef struct hlc_Lru_cache_links {
+  hlc_AVL* newer;
+  hlc_AVL* older;
+  size_t charge;
+} hlc_Lru_cache_links;
+
+
+struct hlc_Lru_cache {
+  hlc_AVL* root;
+  size_t count;
+  size_t charge;
+  size_t capacity;
+
+  // The ends of the recency list, which runs from the most to the least recently used node:
+  hlc_AVL* newest;
+  hlc_AVL* oldest;
+
+  hlc_Layout key_layout;
+  hlc_Layout value_layout;
+  hlc_Compare_instance key_compare_instance;
+  hlc_Destroy_instance key_destroy_instance;
+  hlc_Destroy_instance value_destroy_instance;
+  hlc_Destroy_instance eviction_instance;
+
+  // Nodes hold entries made of their links, the key and the value:
+  hlc_Layout entry_layout;
+  size_t key_offset;
+  size_t value_offset;
+  hlc_Destroy_trait entry_destroy_trait;
+};
+
+const hlc_Layout hlc_lru_cache_layout = {.size = sizeof(hlc_Lru_cache), .alignment = alignof(hlc_Lru_cache)};
+
+
+static inline hlc_Lru_cache_links* hlc_lru_cache_links(const hlc_Lru_cache* cache, const hlc_AVL* node) {
+  return (hlc_Lru_cache_links*)hlc_avl_element(node, cache->entry_layout);
+}
+
+
+static inline hlc_Lru_cache_kv_ref hlc_lru_cache_kv_ref(const hlc_Lru_cache* cache, const hlc_AVL* node) {
+  char* entry = (char*)hlc_avl_element(node, cache->entry_layout);
+  return (hlc_Lru_cache_kv_ref){.key = entry + cache->key_offset, .value = entry + cache->value_offset};
+}
+
+
+/// @brief Takes a node out of the recency list.
+static void hlc_lru_cache_unlink(hlc_Lru_cache* cache, hlc_AVL* node) {
+  hlc_Lru_cache_links* links = hlc_lru_cache_links(cache, node);
+
+  if (links->newer != NULL) {
+    hlc_lru_cache_links(cache, links->newer)->older = links->older;
+  } else {
+    cache->newest = links->older;
+  }
+
+  if (links->older != NULL) {
+    hlc_lru_cache_links(cache, links->older)->newer = links->newer;
+  } else {
+    cache->oldest = links->newer;
+  }
+}
+
+
+/// @brief Puts a node which isn't in the recency list at its front.
+static void hlc_lru_cache_link_newest(hlc_Lru_cache* cache, hlc_AVL* node) {
+  hlc_Lru_cache_links* links = hlc_lru_cache_links(cache, node);
+  links->newer = NULL;
+  links->older = cache->newest;
+
+  if (cache->newest != NULL) {
+    hlc_lru_cache_links(cache, cache->newest)->newer = node;
+  } else {
+    cache->oldest = node;
+  }
+
+  cache->newest = node;
+}
+
+
+/// @brief Searches for a key.
+/// @param ordering Receives 0 if the key was found, or else the side of the returned node where it would be inserted.
+/// @return The node holding the key if it was found, else the last node visited, or NULL if the cache is empty.
+static hlc_AVL* hlc_lru_cache_search(const hlc_Lru_cache* cache, const void* key, signed char* ordering) {
+  hlc_Compare_instance key_compare_instance = cache->key_compare_instance;
+  return hlc_avl_search(cache->root, cache->entry_layout, key, cache->key_offset, key_compare_instance, ordering);
+}
+
+
+/// @brief Destroys an entry, in the context of its cache.
+static void hlc_lru_cache_entry_destroy(void* target, const hlc_Destroy_trait* trait, void* context) {
+  (void)trait;
+  const hlc_Lru_cache* cache = context;
+
+  assert(target != NULL);
+  assert(cache != NULL);
+
+  hlc_destroy((char*)target + cache->key_offset, cache->key_destroy_instance);
+  hlc_destroy((char*)target + cache->value_offset, cache->value_destroy_instance);
+}
+
+
+static inline hlc_Destroy_instance hlc_lru_cache_entry_destroy_instance(const hlc_Lru_cache* cache) {
+  return (hlc_Destroy_instance){.trait = &cache->entry_destroy_trait, .context = (void*)cache};
+}
+
+
+/// @brief Removes a node, which is evicted first if evicting is true.
+static void hlc_lru_cache_remove_node(hlc_Lru_cache* cache, hlc_AVL* node, bool evicting) {
+  hlc_lru_cache_unlink(cache, node);
+  cache->charge -= hlc_lru_cache_links(cache, node)->charge;
+
+  if (evicting) {
+    hlc_Lru_cache_kv_ref kv_ref = hlc_lru_cache_kv_ref(cache, node);
+    hlc_destroy(&kv_ref, cache->eviction_instance);
+  }
+
+  node = hlc_avl_remove(node, cache->entry_layout, hlc_lru_cache_entry_destroy_instance(cache));
+
+  if (node == NULL || hlc_avl_link(node, 0) == NULL) {
+    cache->root = node;
+  }
+
+  cache->count -= 1;
+  assert(cache->count == hlc_avl_count(cache->root));
+}
+
+
+/// @brief Evicts the least recently used nodes until the charge fits the capacity.
+static void hlc_lru_cache_evict(hlc_Lru_cache* cache) {
+  while (cache->charge > cache->capacity) {
+    assert(cache->oldest != NULL);
+    hlc_lru_cache_remove_node(cache, cache->oldest, true);
+  }
+}
+
+
+/// @brief Evicts nodes after a node was inserted or reassigned and marked as the most recently used. A node whose
+/// charge alone exceeds the capacity is evicted alone, rather than after all the others.
+static void hlc_lru_cache_evict_after_insertion(hlc_Lru_cache* cache, hlc_AVL* node) {
+  if (hlc_lru_cache_links(cache, node)->charge > cache->capacity) {
+    hlc_lru_cache_remove_node(cache, node, true);
+  } else {
+    hlc_lru_cache_evict(cache);
+  }
+}
+
+
+void hlc_lru_cache_create(
+  hlc_Lru_cache* cache,
+  hlc_Layout key_layout,
+  hlc_Layout value_layout,
+  hlc_Compare_instance key_compare_instance,
+  hlc_Destroy_instance key_destroy_instance,
+  hlc_Destroy_instance value_destroy_instance,
+  hlc_Destroy_instance eviction_instance,
+  size_t capacity
+) {
+  assert(cache != NULL);
+
+  cache->root = NULL;
+  cache->count = 0;
+  cache->charge = 0;
+  cache->capacity = capacity;
+  cache->newest = NULL;
+  cache->oldest = NULL;
+  cache->key_layout = key_layout;
+  cache->value_layout = value_layout;
+  cache->key_compare_instance = key_compare_instance;
+  cache->key_destroy_instance = key_destroy_instance;
+  cache->value_destroy_instance = value_destroy_instance;
+  cache->eviction_instance = eviction_instance;
+
+  cache->entry_layout = HLC_LAYOUT_OF(hlc_Lru_cache_links);
+  cache->key_offset = hlc_layout_add(&cache->entry_layout, key_layout);
+  cache->value_offset = hlc_layout_add(&cache->entry_layout, value_layout);
+  hlc_layout_pad(&cache->entry_layout);
+
+  cache->entry_destroy_trait = (hlc_Destroy_trait){
+    .destroy = hlc_lru_cache_entry_destroy,
+    .trivial = key_destroy_instance.trait->trivial && value_destroy_instance.trait->trivial,
+  };
+}
+
+
+size_t hlc_lru_cache_count(const hlc_Lru_cache* cache) {
+  assert(cache != NULL);
+  return cache->count;
+}
+
+
+size_t hlc_lru_cache_charge(const hlc_Lru_cache* cache) {
+  assert(cache != NULL);
+  return cache->charge;
+}
+
+
+size_t hlc_lru_cache_capacity(const hlc_Lru_cache* cache) {
+  assert(cache != NULL);
+  return cache->capacity;
+}
+
+
+void hlc_lru_cache_set_capacity(hlc_Lru_cache* cache, size_t capacity) {
+  assert(cache != NULL);
+
+  cache->capacity = capacity;
+  hlc_lru_cache_evict(cache);
+}
+
+
+typedef struct hlc_Lru_cache_entry_assign_context {
+  const hlc_Lru_cache* cache;
+  size_t charge;
+  hlc_Assign_instance key_assign_instance;
+  hlc_Assign_instance value_assign_instance;
+
+  /// @brief Receives the entry which was assigned, from which its node is found.
+  void* entry;
+} hlc_Lru_cache_entry_assign_context;
+
+
+/// @brief Assigns the entry of a new node from a hlc_Lru_cache_kv_ref, leaving it out of the recency list.
+static bool hlc_lru_cache_entry_assign(
+  void* target,
+  const void* _source,
+  const hlc_Assign_trait* trait,
+  void* _context
+) {
+  const hlc_Lru_cache_kv_ref* source = _source;
+  (void)trait;
+  hlc_Lru_cache_entry_assign_context* context = _context;
+  const hlc_Lru_cache* cache = context->cache;
+
+  assert(target != NULL);
+  assert(source != NULL);
+
+  void* key = (char*)target + cache->key_offset;
+  void* value = (char*)target + cache->value_offset;
+
+  if (!hlc_assign_sized(key, source->key, cache->key_layout.size, context->key_assign_instance))
+    return false;
+
+  if (!hlc_assign_sized(value, source->value, cache->value_layout.size, context->value_assign_instance)) {
+    hlc_destroy(key, cache->key_destroy_instance);
+    return false;
+  }
+
+  *(hlc_Lru_cache_links*)target = (hlc_Lru_cache_links){.newer = NULL, .older = NULL, .charge = context->charge};
+  context->entry = target;
+  return true;
+}
+
+
+static const hlc_Assign_trait hlc_lru_cache_entry_assign_trait = {
+  .assign = hlc_lru_cache_entry_assign,
+};
+
+
+bool hlc_lru_cache_insert(
+  hlc_Lru_cache* cache,
+  const void* key,
+  const void* value,
+  size_t charge,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance
+) {
+  assert(cache != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_lru_cache_search(cache, key, &ordering);
+
+  if (node != NULL && ordering == 0) {
+    void* node_value = (char*)hlc_avl_element(node, cache->entry_layout) + cache->value_offset;
+
+    if (!hlc_reassign_sized(node_value, value, cache->value_layout.size, value_assign_instance))
+      return false;
+
+    hlc_Lru_cache_links* links = hlc_lru_cache_links(cache, node);
+    cache->charge = cache->charge - links->charge + charge;
+    links->charge = charge;
+
+    hlc_lru_cache_unlink(cache, node);
+    hlc_lru_cache_link_newest(cache, node);
+    hlc_lru_cache_evict_after_insertion(cache, node);
+    return true;
+  }
+
+  hlc_Lru_cache_kv_ref kv_ref = {.key = key, .value = (void*)value};
+
+  hlc_Lru_cache_entry_assign_context entry_assign_context = {
+    .cache = cache,
+    .charge = charge,
+    .key_assign_instance = key_assign_instance,
+    .value_assign_instance = value_assign_instance,
+    .entry = NULL,
+  };
+
+  hlc_Assign_instance entry_assign_instance = {
+    .trait = &hlc_lru_cache_entry_assign_trait,
+    .context = &entry_assign_context,
+  };
+
+  if (node != NULL) {
+    node = hlc_avl_insert(node, ordering, &kv_ref, cache->entry_layout, entry_assign_instance);
+  } else {
+    node = hlc_avl_new(&kv_ref, cache->entry_layout, entry_assign_instance);
+  }
+
+  if (node == NULL)
+    return false;
+
+  if (hlc_avl_link(node, 0) == NULL) {
+    cache->root = node;
+  }
+
+  cache->count += 1;
+  cache->charge += charge;
+  assert(cache->count == hlc_avl_count(cache->root));
+
+  node = hlc_avl_node(entry_assign_context.entry, cache->entry_layout);
+  hlc_lru_cache_link_newest(cache, node);
+  hlc_lru_cache_evict_after_insertion(cache, node);
+  return true;
+}
+
+
+bool hlc_lru_cache_remove(hlc_Lru_cache* cache, const void* key) {
+  assert(cache != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_lru_cache_search(cache, key, &ordering);
+
+  if (node == NULL || ordering != 0)
+    return false;
+
+  hlc_lru_cache_remove_node(cache, node, false);
+  return true;
+}
+
+
+void* hlc_lru_cache_lookup(hlc_Lru_cache* cache, const void* key) {
+  assert(cache != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_lru_cache_search(cache, key, &ordering);
+
+  if (node == NULL || ordering != 0)
+    return NULL;
+
+  if (node != cache->newest) {
+    hlc_lru_cache_unlink(cache, node);
+    hlc_lru_cache_link_newest(cache, node);
+  }
+
+  return hlc_lru_cache_kv_ref(cache, node).value;
+}
+
+
+void* (hlc_lru_cache_peek)(const hlc_Lru_cache* cache, const void* key) {
+  assert(cache != NULL);
+
+  signed char ordering;
+  const hlc_AVL* node = hlc_lru_cache_search(cache, key, &ordering);
+  return node != NULL && ordering == 0 ? hlc_lru_cache_kv_ref(cache, node).value : NULL;
+}
+
+
+bool hlc_lru_cache_contains(const hlc_Lru_cache* cache, const void* key) {
+  assert(cache != NULL);
+
+  signed char ordering;
+  return hlc_lru_cache_search(cache, key, &ordering) != NULL && ordering == 0;
+}
+
+
+void hlc_lru_cache_clear(hlc_Lru_cache* cache) {
+  assert(cache != NULL);
+
+  hlc_lru_cache_destroy(cache);
+  cache->root = NULL;
+  cache->count = 0;
+  cache->charge = 0;
+  cache->newest = NULL;
+  cache->oldest = NULL;
+}
+
+
+void hlc_lru_cache_destroy(hlc_Lru_cache* cache) {
+  assert(cache != NULL);
+
+  hlc_avl_delete(cache->root, cache->entry_layout, hlc_lru_cache_entry_destroy_instance(cache));
+}
+
+
+bool hlc_lru_cache_for_each(
+  const hlc_Lru_cache* cache,
+  bool (*callback)(hlc_Lru_cache_kv_ref kv_ref, void* context),
+  void* context
+) {
+  assert(cache != NULL);
+  assert(callback != NULL);
+
+  for (const hlc_AVL* node = cache->newest; node != NULL; node = hlc_lru_cache_links(cache, node)->older) {
+    if (!callback(hlc_lru_cache_kv_ref(cache, node), context))
+      return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,138 @@
+#ifndef HLC_LRU_H
+#define HLC_LRU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief A map of bounded capacity, which evicts its least recently used key/value pairs to make room for new ones.
+/// @details Each key/value pair has a charge against the capacity, such as 1 to bound the number of pairs, or the
+/// number of bytes the pair holds to bound memory. Nodes are linked in recency order alongside their tree links, so
+/// that a hit takes one descent, and an eviction takes no search at all.
+typedef struct hlc_Lru_cache hlc_Lru_cache;
+
+/// @memberof hlc_Lru_cache
+extern HLC_API const hlc_Layout hlc_lru_cache_layout;
+
+/// @relates hlc_Lru_cache
+typedef struct hlc_Lru_cache_kv_ref {
+  const void* key;
+  void* value;
+} hlc_Lru_cache_kv_ref;
+
+/// @memberof hlc_Lru_cache
+/// @brief Creates an empty LRU cache.
+/// @param eviction_instance Called on a hlc_Lru_cache_kv_ref to each evicted key/value pair, before the key and value
+/// are destroyed. Pairs which are removed, reassigned or destroyed along with the cache aren't evicted.
+/// @param capacity The maximum total charge of the key/value pairs.
+/// @pre cache != NULL
+HLC_API void hlc_lru_cache_create(
+  hlc_Lru_cache* cache,
+  hlc_Layout key_layout,
+  hlc_Layout value_layout,
+  hlc_Compare_instance key_compare_instance,
+  hlc_Destroy_instance key_destroy_instance,
+  hlc_Destroy_instance value_destroy_instance,
+  hlc_Destroy_instance eviction_instance,
+  size_t capacity
+);
+
+/// @memberof hlc_Lru_cache
+/// @brief Returns the number of key/value pairs in this LRU cache.
+/// @pre cache != NULL
+HLC_API size_t hlc_lru_cache_count(const hlc_Lru_cache* cache);
+
+/// @memberof hlc_Lru_cache
+/// @brief Returns the total charge of the key/value pairs in this LRU cache, which never exceeds its capacity.
+/// @pre cache != NULL
+HLC_API size_t hlc_lru_cache_charge(const hlc_Lru_cache* cache);
+
+/// @memberof hlc_Lru_cache
+/// @brief Returns the capacity of this LRU cache.
+/// @pre cache != NULL
+HLC_API size_t hlc_lru_cache_capacity(const hlc_Lru_cache* cache);
+
+/// @memberof hlc_Lru_cache
+/// @brief Changes the capacity of this LRU cache, evicting key/value pairs until they fit.
+/// @pre cache != NULL
+HLC_API void hlc_lru_cache_set_capacity(hlc_Lru_cache* cache, size_t capacity);
+
+/// @memberof hlc_Lru_cache
+/// @brief Inserts a key/value pair into this LRU cache, or reassigns the value if the key is already in it, and marks
+/// it as the most recently used. Least recently used pairs are then evicted until the charge fits the capacity. If the
+/// charge of the pair alone exceeds the capacity, the pair is evicted right away instead, and the others are kept.
+/// @return true on success, false on insufficient memory.
+/// @pre cache != NULL
+HLC_API bool hlc_lru_cache_insert(
+  hlc_Lru_cache* cache,
+  const void* key,
+  const void* value,
+  size_t charge,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance
+);
+
+/// @memberof hlc_Lru_cache
+/// @brief Removes a key from this LRU cache, without evicting it.
+/// @return true on success, false if the key was not in this LRU cache.
+/// @pre cache != NULL
+HLC_API bool hlc_lru_cache_remove(hlc_Lru_cache* cache, const void* key);
+
+/// @memberof hlc_Lru_cache
+/// @brief Returns the value corresponding to the given key, if any, and marks it as the most recently used.
+/// @return The value on success, or NULL if the key wasn't in this LRU cache.
+/// @pre cache != NULL
+HLC_API void* hlc_lru_cache_lookup(hlc_Lru_cache* cache, const void* key);
+
+/// @memberof hlc_Lru_cache
+/// @brief Returns the value corresponding to the given key, if any, without marking it as used.
+/// @return The value on success, or NULL if the key wasn't in this LRU cache.
+/// @pre cache != NULL
+HLC_API void* hlc_lru_cache_peek(const hlc_Lru_cache* cache, const void* key);
+
+/// @memberof hlc_Lru_cache
+/// @brief Returns the value corresponding to the given key, if any, without marking it as used.
+/// @return The value on success, or NULL if the key wasn't in this LRU cache.
+/// @pre cache != NULL
+#define hlc_lru_cache_peek(cache, key) _Generic(               \
+  true ? (cache) : (void*)(cache),                             \
+  void*: hlc_lru_cache_peek((cache), (key)),                   \
+  const void*: (const void*)hlc_lru_cache_peek((cache), (key)) \
+)
+
+/// @memberof hlc_Lru_cache
+/// @brief Checks if this LRU cache contains the given key, without marking it as used.
+/// @pre cache != NULL
+HLC_API bool hlc_lru_cache_contains(const hlc_Lru_cache* cache, const void* key);
+
+/// @memberof hlc_Lru_cache
+/// @brief Clears this LRU cache, without evicting its key/value pairs.
+/// @pre cache != NULL
+HLC_API void hlc_lru_cache_clear(hlc_Lru_cache* cache);
+
+/// @memberof hlc_Lru_cache
+/// @brief Destroys this LRU cache, without evicting its key/value pairs.
+/// @pre cache != NULL
+HLC_API void hlc_lru_cache_destroy(hlc_Lru_cache* cache);
+
+/// @memberof hlc_Lru_cache
+/// @brief Calls the callback on each key/value pair of this LRU cache, from the most to the least recently used, until
+/// the callback returns false. Recency is left unchanged.
+/// @return true if all key/value pairs were visited, false if the callback stopped the iteration.
+/// @pre cache != NULL && callback != NULL
+HLC_API bool hlc_lru_cache_for_each(
+  const hlc_Lru_cache* cache,
+  bool (*callback)(hlc_Lru_cache_kv_ref kv_ref, void* context),
+  void* context
+);
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -1,8 +1,13 @@
 #include <assert.h>
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
 
 #ifdef __has_include
   #if __has_include(<crtdbg.h>)
@@ -10,28 +15,484 @@
   #endif
 #endif
 
+#include "intern.h"
+#include "interval.h"
 #include "layout.h"
+#include "lru.h"
 #include "map.h"
+#include "multimap.h"
+#include "multiset.h"
+#include "radix.h"
 #include "random.h"
 #include "set.h"
 #include "stack.h"
+#include "task.h"
+#include "trace.h"
 #include "traits/assign.h"
 #include "traits/compare.h"
 #include "traits/destroy.h"
+#include "traits/reduce.h"
+#include "traits/string.h"
 
 
-static void shuffle(hlc_Random* random, int* xs, size_t count) {
-  assert(xs != NULL);
+/// @brief Fails every assignment, as an assignment running out of memory would.
+static bool failing_assign(void* target, const void* source, const hlc_Assign_trait* trait, void* context) {
+  (void)target;
+  (void)source;
+  (void)trait;
+  (void)context;
+  return false;
+}
+
+static const hlc_Assign_trait failing_assign_trait = {
+  .assign = failing_assign,
+  .reassign = failing_assign,
+};
+
+
+static bool sum_initialize(void* accumulator, const hlc_Reduce_trait* trait, void* context) {
+  (void)trait;
+  (void)context;
+  *(double*)accumulator = 0;
+  return true;
+}
+
+
+static void sum_accumulate(void* accumulator, const void* element, const hlc_Reduce_trait* trait, void* context) {
+  (void)trait;
+  (void)context;
+  *(double*)accumulator += *(const double*)((const hlc_Map_kv_ref*)element)->value;
+}
+
+
+static void sum_combine(void* accumulator, void* other, const hlc_Reduce_trait* trait, void* context) {
+  (void)trait;
+  (void)context;
+  *(double*)accumulator += *(double*)other;
+}
+
+
+static const hlc_Reduce_trait sum_reduce_trait = {
+  .initialize = sum_initialize,
+  .accumulate = sum_accumulate,
+  .combine = sum_combine,
+};
+
+
+/// @brief A sequence of ints reduced by concatenation, which only lists elements in order if partial results are
+/// combined in order.
+typedef struct Concatenation {
+  int* elements;
+  size_t count;
+  bool failed;
+} Concatenation;
+
+
+static bool concatenation_initialize(void* accumulator, const hlc_Reduce_trait* trait, void* context) {
+  (void)trait;
+  (void)context;
+  *(Concatenation*)accumulator = (Concatenation){.elements = NULL, .count = 0, .failed = false};
+  return true;
+}
+
+
+static void concatenation_append(Concatenation* concatenation, const int* elements, size_t count) {
+  int* grown = realloc(concatenation->elements, (concatenation->count + count) * sizeof(int));
+
+  if (grown == NULL) {
+    concatenation->failed = true;
+    return;
+  }
+
+  memcpy(grown + concatenation->count, elements, count * sizeof(int));
+  concatenation->elements = grown;
+  concatenation->count += count;
+}
+
+
+static void concatenation_accumulate_element(
+  void* accumulator,
+  const void* element,
+  const hlc_Reduce_trait* trait,
+  void* context
+) {
+  (void)trait;
+  (void)context;
+  concatenation_append(accumulator, element, 1);
+}
+
+
+static void concatenation_accumulate_key(
+  void* accumulator,
+  const void* element,
+  const hlc_Reduce_trait* trait,
+  void* context
+) {
+  (void)trait;
+  (void)context;
+  concatenation_append(accumulator, ((const hlc_Map_kv_ref*)element)->key, 1);
+}
+
+
+static void concatenation_combine(void* accumulator, void* _other, const hlc_Reduce_trait* trait, void* context) {
+  Concatenation* other = _other;
+  (void)trait;
+  (void)context;
+
+  concatenation_append(accumulator, other->elements, other->count);
+  ((Concatenation*)accumulator)->failed |= other->failed;
+  free(other->elements);
+}
+
+
+static const hlc_Reduce_trait concatenation_element_reduce_trait = {
+  .initialize = concatenation_initialize,
+  .accumulate = concatenation_accumulate_element,
+  .combine = concatenation_combine,
+};
+
+
+static const hlc_Reduce_trait concatenation_key_reduce_trait = {
+  .initialize = concatenation_initialize,
+  .accumulate = concatenation_accumulate_key,
+  .combine = concatenation_combine,
+};
+
+
+/// @brief Visits counted from several threads, stopping at a given element.
+typedef struct Parallel_visits {
+  atomic_size_t count;
+  atomic_llong sum;
+  int stop;
+} Parallel_visits;
+
+
+static bool parallel_visit_element(const void* element, void* context) {
+  Parallel_visits* visits = context;
+  int x = *(const int*)element;
+
+  atomic_fetch_add_explicit(&visits->count, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&visits->sum, x, memory_order_relaxed);
+  return x != visits->stop;
+}
+
+
+static bool parallel_visit_kv(hlc_Map_kv_ref kv_ref, void* context) {
+  Parallel_visits* visits = context;
+  int key = *(const int*)kv_ref.key;
+
+  // Values are twice their keys, so a value seen with the wrong key is counted as a stop:
+  if (*(const int*)kv_ref.value != 2 * key)
+    return false;
+
+  atomic_fetch_add_explicit(&visits->count, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&visits->sum, key, memory_order_relaxed);
+  return key != visits->stop;
+}
+
+
+/// @brief Counts evicted pairs whose value is the opposite of their key, so that any other pair makes the count fall
+/// short.
+static void count_eviction(void* target, const hlc_Destroy_trait* trait, void* context) {
+  const hlc_Lru_cache_kv_ref* kv_ref = target;
+  (void)trait;
+  size_t* evictions = context;
+
+  *evictions += *(const int*)kv_ref->key == -*(const int*)kv_ref->value;
+}
+
+
+static const hlc_Destroy_trait eviction_destroy_trait = {
+  .destroy = count_eviction,
+};
+
+
+typedef struct Interval_query {
+  int lo;
+  int hi;
+  size_t count;
+} Interval_query;
+
+
+/// @brief Checks that the intervals reported by a query overlap it, in order, and that their values match them.
+static bool interval_check_overlap(hlc_Interval_map_kv_ref kv_ref, void* context) {
+  Interval_query* query = context;
+  int lo = *(const int*)kv_ref.lo;
+  int hi = *(const int*)kv_ref.hi;
+
+  if (lo > query->hi || hi < query->lo || *(int*)kv_ref.value != lo * 100 + (hi - lo))
+    return false;
+
+  query->count += 1;
+  return true;
+}
+
+
+/// @brief Visits consecutive ints from 1, in order, stopping once a given number of them were visited.
+typedef struct Ordered_visits {
+  size_t count;
+  size_t limit;
+  bool ordered;
+} Ordered_visits;
 
-  for (size_t i = 0; i + 1 < count; ++i) {
-    size_t j = hlc_random_size_in(random, i, count - 1);
-    int t = xs[i];
-    xs[i] = xs[j];
-    xs[j] = t;
+
+static bool ordered_visit(const void* element, void* context) {
+  Ordered_visits* visits = context;
+  visits->count += 1;
+  visits->ordered &= *(const int*)element == (int)visits->count;
+  return visits->count < visits->limit;
+}
+
+
+/// @brief Visits key/value pairs like ordered_visit, checking that each value is the opposite of its key.
+static bool ordered_visit_kv(hlc_Map_kv_ref kv_ref, void* context) {
+  Ordered_visits* visits = context;
+  visits->ordered &= *(const double*)kv_ref.value == -*(const int*)kv_ref.key;
+  return ordered_visit(kv_ref.key, context);
+}
+
+
+typedef struct Prefix_visits {
+  size_t count;
+  int previous;
+  bool ordered;
+} Prefix_visits;
+
+
+/// @brief Visits the pairs of a map from hlc_Bytes keys "shared-prefix-%05d" to their number, checking their order.
+static bool shared_prefix_visit(hlc_Map_kv_ref kv_ref, void* context) {
+  Prefix_visits* visits = context;
+  const hlc_Bytes* key = kv_ref.key;
+  int number = *(const int*)kv_ref.value;
+
+  char buffer[32];
+  int length = snprintf(buffer, sizeof(buffer), "shared-prefix-%05d", number);
+
+  visits->count += 1;
+  visits->ordered &= number > visits->previous && key->size == (size_t)length
+    && memcmp(key->data, buffer, key->size) == 0;
+
+  visits->previous = number;
+  return true;
+}
+
+
+/// @brief Checks hlc_compare_many using the compare_many hook of an instance against calling compare on each element,
+/// on arrays of up to 40 elements drawn from the given values, both as drawn and sorted, probed with each value.
+static bool compare_many_matches(
+  hlc_Random* random,
+  hlc_Compare_instance instance,
+  const void* values,
+  size_t value_count,
+  size_t size
+) {
+  hlc_Compare_trait scalar_trait = *instance.trait;
+  scalar_trait.compare_many = NULL;
+  hlc_Compare_instance scalar_instance = {.trait = &scalar_trait, .context = instance.context};
+
+  unsigned char ys[40 * 8];
+  unsigned char y[8];
+
+  for (size_t count = 0; count <= 40; ++count) {
+    for (size_t i = 0; i < count; ++i) {
+      memcpy(ys + i * size, (const char*)values + hlc_random_size_in(random, 0, value_count - 1) * size, size);
+    }
+
+    for (int sorted = 0; sorted <= 1; ++sorted) {
+      for (size_t k = 0; k < value_count; ++k) {
+        const void* x = (const char*)values + k * size;
+
+        if (hlc_compare_many(x, ys, count, size, instance) != hlc_compare_many(x, ys, count, size, scalar_instance))
+          return false;
+      }
+
+      // Insertion sort, so that the sorted pass finds lower bounds past the first elements:
+      for (size_t i = 1; i < count; ++i) {
+        memcpy(y, ys + i * size, size);
+        size_t j = i;
+
+        for (; j > 0 && hlc_compare(y, ys + (j - 1) * size, scalar_instance) < 0; --j) {
+          memcpy(ys + j * size, ys + (j - 1) * size, size);
+        }
+
+        memcpy(ys + j * size, y, size);
+      }
+    }
+  }
+
+  return true;
+}
+
+
+/// @brief Values of an integer type at its limits, around zero and around half its maximum, where unsigned values
+/// switch sign once biased to be compared as signed ones.
+#define EDGE_VALUES(t, min, max) {                                                   \
+  (t)(min), (t)((min) + 1), (t)((min) / 2), (t)-1, (t)0, (t)1, (t)2, (t)((max) / 2), \
+  (t)((max) / 2 + 1), (t)((max) - 1), (t)(max)                                       \
+}
+
+/// @brief Checks compare_many for the primitive compare instance of a type, see compare_many_matches.
+#define COMPARE_MANY_MATCHES(random, t_name, t, min, max) do {                \
+  static const t values[] = EDGE_VALUES(t, min, max);                         \
+  size_t count = sizeof(values) / sizeof(t);                                  \
+  hlc_Compare_instance instance = hlc_##t_name##_compare_instance;            \
+  assert(compare_many_matches((random), instance, values, count, sizeof(t))); \
+} while (false)
+
+
+typedef struct Radix_order {
+  size_t count;
+  long long previous;
+} Radix_order;
+
+
+/// @brief Checks that the keys of a radix map are visited in increasing order, decoding hlc_radix_encode_llong.
+static bool radix_check_order(hlc_Radix_map_kv_ref kv_ref, void* context) {
+  Radix_order* order = context;
+  unsigned long long x = 0;
+
+  for (size_t i = 0; i < kv_ref.key_size; ++i) {
+    x = x << 8 | ((const unsigned char*)kv_ref.key)[i];
+  }
+
+  long long key = (long long)(x ^ 0x8000000000000000ULL);
+
+  if ((order->count > 0 && key <= order->previous) || *(const long long*)kv_ref.value != key)
+    return false;
+
+  order->count += 1;
+  order->previous = key;
+  return true;
+}
+
+
+/// @brief Checks that the nested keys "a", "aa", ... of a radix map are visited by increasing size, mapped to it.
+static bool radix_check_nested(hlc_Radix_map_kv_ref kv_ref, void* context) {
+  Radix_order* order = context;
+
+  if (kv_ref.key_size != order->count + 1 || *(const size_t*)kv_ref.value != kv_ref.key_size)
+    return false;
+
+  for (size_t i = 0; i < kv_ref.key_size; ++i) {
+    if (((const unsigned char*)kv_ref.key)[i] != 'a')
+      return false;
   }
+
+  order->count += 1;
+  return true;
 }
 
 
+#ifdef HLC_COUNTERS
+  /// @brief Assigns an int and inserts it into the set given as context, so that assigning operates on another
+  /// container.
+  static bool nested_assign(void* target, const void* source, const hlc_Assign_trait* trait, void* context) {
+    (void)trait;
+    *(int*)target = *(const int*)source;
+    return hlc_set_insert(context, source, hlc_int_assign_instance);
+  }
+
+  static const hlc_Assign_trait nested_assign_trait = {
+    .assign = nested_assign,
+    .reassign = nested_assign,
+  };
+#endif
+
+
+#ifdef HLC_TRACE
+  #define TRACE_SETS 8
+
+  /// @brief Returns the set replaying the container with the given identifier, creating it on first use as
+  /// hlc_replay does.
+  static hlc_Set* trace_set(unsigned long* ids, hlc_Set** sets, size_t* count, unsigned long id) {
+    for (size_t i = 0; i < *count; ++i) {
+      if (ids[i] == id)
+        return sets[i];
+    }
+
+    if (*count == TRACE_SETS)
+      return NULL;
+
+    hlc_Set* set = malloc(hlc_set_layout.size);
+
+    if (set == NULL)
+      return NULL;
+
+    hlc_set_create(set, HLC_LAYOUT_OF(unsigned long long), hlc_ullong_compare_instance, hlc_no_destroy_instance);
+    ids[*count] = id;
+    sets[*count] = set;
+    *count += 1;
+    return set;
+  }
+
+
+  /// @brief Replays a trace of sets, using the recorded key hashes as keys.
+  /// @return The number of lookups which found their key, or (size_t)-1 if the trace couldn't be replayed.
+  static size_t trace_replay_hits(const char* path) {
+    FILE* file = fopen(path, "rb");
+
+    if (file == NULL)
+      return (size_t)-1;
+
+    unsigned char header[HLC_TRACE_HEADER_SIZE];
+    unsigned char bytes[HLC_TRACE_RECORD_SIZE];
+    unsigned long ids[TRACE_SETS];
+    hlc_Set* sets[TRACE_SETS];
+    size_t count = 0;
+    size_t hits = 0;
+    bool ok = fread(header, sizeof(header), 1, file) == 1 && hlc_trace_decode_header(header);
+
+    while (ok && fread(bytes, sizeof(bytes), 1, file) == 1) {
+      hlc_Trace_record record;
+      ok = hlc_trace_decode_record(bytes, &record) && record.container == HLC_TRACE_SET;
+      hlc_Set* set = ok ? trace_set(ids, sets, &count, record.container_id) : NULL;
+      ok = set != NULL;
+
+      if (!ok)
+        break;
+
+      switch (record.operation) {
+        case HLC_TRACE_CREATE:
+        case HLC_TRACE_DESTROY:
+          hlc_set_clear(set);
+          break;
+        case HLC_TRACE_CLONE: {
+          hlc_Set* source = trace_set(ids, sets, &count, (unsigned long)record.key);
+          ok = source != NULL && source != set;
+
+          if (ok) {
+            hlc_set_destroy(set);
+            ok = hlc_set_clone(source, set, hlc_ullong_assign_instance);
+          }
+
+          break;
+        }
+        case HLC_TRACE_INSERT:
+          ok = hlc_set_insert(set, &record.key, hlc_ullong_assign_instance);
+          break;
+        case HLC_TRACE_REMOVE:
+          hlc_set_remove(set, &record.key);
+          break;
+        case HLC_TRACE_LOOKUP:
+          hits += hlc_set_contains(set, &record.key);
+          break;
+        case HLC_TRACE_ITERATE:
+          break;
+      }
+    }
+
+    fclose(file);
+
+    for (size_t i = 0; i < count; ++i) {
+      hlc_set_destroy(sets[i]);
+      free(sets[i]);
+    }
+
+    return ok ? hits : (size_t)-1;
+  }
+#endif
+
+
 #undef NDEBUG
 #include <assert.h>
 
@@ -53,6 +514,12 @@ int main(void) {
 
   hlc_random_create(random);
 
+  hlc_Task_pool* pool = HLC_STACK_ALLOCATE(hlc_task_pool_layout.size);
+  assert(pool != NULL);
+
+  bool pool_ok = hlc_task_pool_create(pool, 4);
+  assert(pool_ok);
+
   puts("Testing hlc_Set:");
 
   for (size_t i = 1; i <= ITERATIONS; ++i) {
@@ -75,7 +542,7 @@ int main(void) {
       hlc_no_destroy_instance
     );
 
-    shuffle(random, elements, COUNT);
+    hlc_random_shuffle(random, elements, COUNT, HLC_LAYOUT_OF(int));
 
     for (size_t j = 0; j < COUNT; ++j) {
       bool ok = hlc_set_insert(set, &elements[j], hlc_int_assign_instance);
@@ -83,7 +550,99 @@ int main(void) {
       assert(ok && contains);
     }
 
-    shuffle(random, elements, COUNT);
+    bool* results = malloc(sizeof(bool) * (COUNT + 3));
+    int* queries = malloc(sizeof(int) * (COUNT + 3));
+    assert(results != NULL && queries != NULL);
+
+    hlc_set_contains_batch(set, elements, COUNT, results);
+
+    for (size_t j = 0; j < COUNT; ++j) {
+      assert(results[j]);
+    }
+
+    // Queries mixing present and absent elements, in batches which don't fill the last group of lookups:
+    for (size_t j = 0; j < COUNT + 3; ++j) {
+      queries[j] = 2 * (int)j - COUNT / 2;
+    }
+
+    size_t query_counts[] = {0, 1, 7, 9, 17, COUNT + 3};
+
+    for (size_t q = 0; q < sizeof(query_counts) / sizeof(query_counts[0]); ++q) {
+      size_t query_count = query_counts[q];
+      hlc_set_contains_batch(set, queries + COUNT / 4 - query_count / 4, query_count, results);
+
+      for (size_t j = 0; j < query_count; ++j) {
+        int query = queries[COUNT / 4 - query_count / 4 + j];
+        assert(results[j] == (query >= 1 && query <= COUNT));
+      }
+    }
+
+    free(queries);
+    free(results);
+
+    int* sorted = malloc(sizeof(int) * COUNT);
+    assert(sorted != NULL);
+
+    bool copy_ok = hlc_set_copy_to_array(set, sorted, hlc_int_assign_instance);
+    assert(copy_ok);
+
+    for (size_t j = 0; j < COUNT; ++j) {
+      assert(sorted[j] == (int)(j + 1));
+    }
+
+    free(sorted);
+
+    Ordered_visits visits = {.count = 0, .limit = SIZE_MAX, .ordered = true};
+    assert(hlc_set_for_each(set, ordered_visit, &visits) && visits.count == COUNT && visits.ordered);
+
+    visits = (Ordered_visits){.count = 0, .limit = COUNT / 3, .ordered = true};
+    assert(!hlc_set_for_each(set, ordered_visit, &visits) && visits.count == COUNT / 3 && visits.ordered);
+
+    hlc_Frozen_set* frozen = HLC_STACK_ALLOCATE(hlc_frozen_set_layout.size);
+    assert(frozen != NULL);
+
+    bool frozen_ok = hlc_set_freeze(set, frozen, hlc_int_assign_instance);
+    assert(frozen_ok && hlc_frozen_set_count(frozen) == COUNT);
+
+    hlc_Frozen_set_iterator* frozen_iterator = HLC_STACK_ALLOCATE(hlc_frozen_set_iterator_layout.size);
+    assert(frozen_iterator != NULL);
+
+    hlc_frozen_set_iterator(frozen, frozen_iterator);
+
+    for (int j = 0; j <= COUNT + 1; ++j) {
+      bool contains = hlc_frozen_set_contains(frozen, &j);
+      assert(contains == (j >= 1 && j <= COUNT));
+
+      if (contains) {
+        const int* element = hlc_frozen_set_iterator_next(frozen_iterator);
+        assert(element != NULL && *element == j);
+      }
+    }
+
+    assert(hlc_frozen_set_iterator_next(frozen_iterator) == NULL);
+
+    HLC_STACK_FREE(frozen_iterator);
+    hlc_frozen_set_destroy(frozen);
+    HLC_STACK_FREE(frozen);
+
+    hlc_Set* clone = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+    assert(clone != NULL);
+
+    bool clone_ok = i % 2 == 0
+      ? hlc_set_parallel_clone(set, clone, hlc_int_assign_instance, pool)
+      : hlc_set_clone(set, clone, hlc_int_assign_instance);
+    assert(clone_ok && hlc_set_count(clone) == COUNT && hlc_set_compare(set, clone, hlc_int_compare_instance) == 0);
+
+    // The clone is independent of the set:
+    int added = COUNT + 1;
+    assert(hlc_set_remove(clone, &(int){1}) && hlc_set_insert(clone, &added, hlc_int_assign_instance));
+    assert(hlc_set_contains(set, &(int){1}) && !hlc_set_contains(set, &added) && hlc_set_count(set) == COUNT);
+    assert(hlc_set_compare(set, clone, hlc_int_compare_instance) < 0);
+
+    hlc_set_destroy(clone);
+    HLC_STACK_FREE(clone);
+
+    hlc_random_shuffle(random, elements, COUNT, HLC_LAYOUT_OF(int));
 
     for (size_t j = 0; j < COUNT; ++j) {
       bool ok = hlc_set_remove(set, &elements[j]);
@@ -112,16 +671,17 @@ int main(void) {
     hlc_Map* map = HLC_STACK_ALLOCATE(hlc_map_layout.size);
     assert(map != NULL);
 
-    hlc_map_create(
+    hlc_map_create_with(
       map,
       HLC_LAYOUT_OF(int),
       HLC_LAYOUT_OF(double),
       hlc_int_compare_instance,
       hlc_no_destroy_instance,
-      hlc_no_destroy_instance
+      hlc_no_destroy_instance,
+      i % 2 == 0 ? HLC_MAP_VALUES_OUT_OF_LINE : 0
     );
 
-    shuffle(random, keys, COUNT);
+    hlc_random_shuffle(random, keys, COUNT, HLC_LAYOUT_OF(int));
 
     for (size_t j = 0; j < COUNT; ++j) {
       double value = -keys[j];
@@ -131,7 +691,157 @@ int main(void) {
       assert(ok && contains && lookup != NULL && *lookup == value);
     }
 
-    shuffle(random, keys, COUNT);
+    hlc_Map_stats map_stats = hlc_map_stats(map);
+    assert(map_stats.count == COUNT && map_stats.kv_size == sizeof(int) + sizeof(double));
+
+    // Out of line values take slots from blocks which are accounted in full, and which double in size up to 64 KB, so
+    // that unused slots take less than the used ones and a block:
+    size_t values_size = map_stats.total_size - COUNT * map_stats.node_size;
+    size_t used_size = COUNT * sizeof(double);
+    assert(i % 2 == 0 ? values_size > used_size && values_size < 2 * used_size + 65536 : values_size == 0);
+    assert(map_stats.average_depth >= 1 && map_stats.average_depth <= (double)map_stats.height);
+
+    // The height of an AVL tree of n nodes is at least log2(n + 1), and at most the h for which the sparsest tree of
+    // height h + 1, of fib(h + 3) - 1 nodes, has more than n nodes:
+    size_t sparsest[3] = {0, 1, 2};
+    size_t max_height = 1;
+
+    for (; sparsest[2] <= COUNT; ++max_height) {
+      sparsest[0] = sparsest[1];
+      sparsest[1] = sparsest[2];
+      sparsest[2] = sparsest[0] + sparsest[1] + 1;
+    }
+
+    assert(((size_t)1 << map_stats.height) > COUNT && map_stats.height <= max_height);
+
+    double sum;
+    hlc_Reduce_instance sum_reduce_instance = {.trait = &sum_reduce_trait, .context = NULL};
+    bool sum_ok = hlc_map_parallel_reduce(map, pool, &sum, HLC_LAYOUT_OF(double), sum_reduce_instance);
+    assert(sum_ok && sum == -(double)COUNT * (COUNT + 1) / 2);
+
+    void** values = malloc(sizeof(void*) * COUNT);
+    assert(values != NULL);
+
+    hlc_map_lookup_batch(map, keys, COUNT, values);
+
+    for (size_t j = 0; j < COUNT; ++j) {
+      assert(values[j] != NULL && *(const double*)values[j] == -keys[j]);
+    }
+
+    free(values);
+
+    // Queries mixing present and absent keys, in batches which don't fill the last group of lookups:
+    int* queries = malloc(sizeof(int) * (COUNT + 3));
+    values = malloc(sizeof(void*) * (COUNT + 3));
+    assert(queries != NULL && values != NULL);
+
+    for (size_t j = 0; j < COUNT + 3; ++j) {
+      queries[j] = 2 * (int)j - COUNT / 2;
+    }
+
+    size_t query_counts[] = {0, 1, 7, 9, 17, COUNT + 3};
+
+    for (size_t q = 0; q < sizeof(query_counts) / sizeof(query_counts[0]); ++q) {
+      size_t query_count = query_counts[q];
+      hlc_map_lookup_batch(map, queries + COUNT / 4 - query_count / 4, query_count, values);
+
+      for (size_t j = 0; j < query_count; ++j) {
+        int query = queries[COUNT / 4 - query_count / 4 + j];
+        bool present = query >= 1 && query <= COUNT;
+        assert(present ? values[j] != NULL && *(const double*)values[j] == -query : values[j] == NULL);
+      }
+    }
+
+    free(queries);
+    free(values);
+
+    int* sorted = malloc(sizeof(int) * COUNT);
+    assert(sorted != NULL);
+
+    bool copy_ok = hlc_map_copy_keys(map, sorted, hlc_int_assign_instance);
+    assert(copy_ok);
+
+    for (size_t j = 0; j < COUNT; ++j) {
+      assert(sorted[j] == (int)(j + 1));
+    }
+
+    free(sorted);
+
+    double* sorted_values = malloc(sizeof(double) * COUNT);
+    assert(sorted_values != NULL);
+
+    copy_ok = hlc_map_copy_values(map, sorted_values, hlc_double_assign_instance);
+    assert(copy_ok);
+
+    for (size_t j = 0; j < COUNT; ++j) {
+      assert(sorted_values[j] == -(double)(j + 1));
+    }
+
+    free(sorted_values);
+
+    Ordered_visits visits = {.count = 0, .limit = SIZE_MAX, .ordered = true};
+    assert(hlc_map_for_each(map, ordered_visit_kv, &visits) && visits.count == COUNT && visits.ordered);
+
+    visits = (Ordered_visits){.count = 0, .limit = 1, .ordered = true};
+    assert(!hlc_map_for_each(map, ordered_visit_kv, &visits) && visits.count == 1 && visits.ordered);
+
+    hlc_Frozen_map* frozen = HLC_STACK_ALLOCATE(hlc_frozen_map_layout.size);
+    assert(frozen != NULL);
+
+    bool frozen_ok = hlc_map_freeze(map, frozen, hlc_int_assign_instance, hlc_double_assign_instance);
+    assert(frozen_ok && hlc_frozen_map_count(frozen) == COUNT);
+
+    hlc_Frozen_map_iterator* frozen_iterator = HLC_STACK_ALLOCATE(hlc_frozen_map_iterator_layout.size);
+    assert(frozen_iterator != NULL);
+
+    hlc_frozen_map_iterator(frozen, frozen_iterator);
+
+    for (int j = 0; j <= COUNT + 1; ++j) {
+      const double* lookup = hlc_frozen_map_lookup(frozen, &j);
+      assert((lookup != NULL) == (j >= 1 && j <= COUNT));
+
+      if (lookup != NULL) {
+        hlc_Map_kv_ref kv_ref = hlc_frozen_map_iterator_next(frozen_iterator);
+        assert(*lookup == -j && kv_ref.key != NULL && *(const int*)kv_ref.key == j && kv_ref.value == lookup);
+      }
+    }
+
+    assert(hlc_frozen_map_iterator_next(frozen_iterator).key == NULL);
+
+    HLC_STACK_FREE(frozen_iterator);
+    hlc_frozen_map_destroy(frozen);
+    HLC_STACK_FREE(frozen);
+
+    hlc_Map* clone = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    assert(clone != NULL);
+
+    // Iterations alternate between in line and out of line values, and every other pair of them clones in parallel,
+    // which falls back to a sequential clone for out of line values:
+    bool clone_ok = i % 4 < 2
+      ? hlc_map_parallel_clone(map, clone, hlc_int_assign_instance, hlc_double_assign_instance, pool)
+      : hlc_map_clone(map, clone, hlc_int_assign_instance, hlc_double_assign_instance);
+    assert(clone_ok && hlc_map_count(clone) == COUNT);
+
+    // The clone is independent of the map, including its values:
+    for (size_t j = 0; j < COUNT; ++j) {
+      double* lookup = hlc_map_lookup(clone, &keys[j]);
+      assert(lookup != NULL && *lookup == -keys[j]);
+      *lookup = keys[j];
+    }
+
+    assert(hlc_map_remove(clone, &(int){1}));
+
+    for (size_t j = 0; j < COUNT; ++j) {
+      const double* lookup = hlc_map_lookup(map, &keys[j]);
+      assert(lookup != NULL && *lookup == -keys[j]);
+    }
+
+    assert(hlc_map_count(map) == COUNT && hlc_map_count(clone) == COUNT - 1);
+
+    hlc_map_destroy(clone);
+    HLC_STACK_FREE(clone);
+
+    hlc_random_shuffle(random, keys, COUNT, HLC_LAYOUT_OF(int));
 
     for (size_t j = 0; j < COUNT; ++j) {
       bool ok = hlc_map_remove(map, &keys[j]);
@@ -146,6 +856,1085 @@ int main(void) {
     free(keys);
   }
 
+  {
+    // Zero-sized values, which take no memory, are still found at valid addresses once frozen:
+    hlc_Layout empty_layout = {.size = 0, .alignment = 1};
+    hlc_Map* map = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    hlc_Frozen_map* frozen = HLC_STACK_ALLOCATE(hlc_frozen_map_layout.size);
+    assert(map != NULL && frozen != NULL);
+
+    hlc_map_create(
+      map,
+      HLC_LAYOUT_OF(int),
+      empty_layout,
+      hlc_int_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    for (int j = 0; j < 100; ++j) {
+      bool ok = hlc_map_insert(map, &j, NULL, hlc_int_assign_instance, hlc_no_assign_instance);
+      assert(ok);
+    }
+
+    bool frozen_ok = hlc_map_freeze(map, frozen, hlc_int_assign_instance, hlc_no_assign_instance);
+    assert(frozen_ok && hlc_frozen_map_count(frozen) == 100);
+
+    for (int j = 0; j <= 100; ++j) {
+      assert((hlc_frozen_map_lookup(frozen, &j) != NULL) == (j < 100));
+    }
+
+    hlc_frozen_map_destroy(frozen);
+    hlc_map_destroy(map);
+    HLC_STACK_FREE(frozen);
+    HLC_STACK_FREE(map);
+  }
+
+  puts("Testing parallel operations:");
+
+  {
+    hlc_Set* set = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+    hlc_Map* map = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    assert(set != NULL && map != NULL);
+
+    hlc_set_create(set, HLC_LAYOUT_OF(int), hlc_int_compare_instance, hlc_no_destroy_instance);
+    hlc_map_create(
+      map,
+      HLC_LAYOUT_OF(int),
+      HLC_LAYOUT_OF(int),
+      hlc_int_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    for (int j = COUNT; j >= 1; --j) {
+      int value = 2 * j;
+      bool ok = hlc_set_insert(set, &j, hlc_int_assign_instance)
+        && hlc_map_insert(map, &j, &value, hlc_int_assign_instance, hlc_int_assign_instance);
+      assert(ok);
+    }
+
+    long long sum = (long long)COUNT * (COUNT + 1) / 2;
+
+    // Without a stop, every element is visited exactly once:
+    Parallel_visits visits = {.count = 0, .sum = 0, .stop = 0};
+    assert(hlc_set_parallel_for_each(set, pool, parallel_visit_element, &visits));
+    assert(atomic_load(&visits.count) == COUNT && atomic_load(&visits.sum) == sum);
+
+    atomic_store(&visits.count, 0);
+    atomic_store(&visits.sum, 0);
+    assert(hlc_map_parallel_for_each(map, pool, parallel_visit_kv, &visits));
+    assert(atomic_load(&visits.count) == COUNT && atomic_load(&visits.sum) == sum);
+
+    // Stopping at an element reports the stop, wherever the element is in the tree:
+    for (int stop = 1; stop <= COUNT; stop += COUNT / 4 - 1) {
+      atomic_store(&visits.count, 0);
+      atomic_store(&visits.sum, 0);
+      visits.stop = stop;
+      assert(!hlc_set_parallel_for_each(set, pool, parallel_visit_element, &visits));
+      assert(atomic_load(&visits.count) >= 1 && atomic_load(&visits.count) <= COUNT);
+
+      atomic_store(&visits.count, 0);
+      assert(!hlc_map_parallel_for_each(map, pool, parallel_visit_kv, &visits));
+      assert(atomic_load(&visits.count) >= 1 && atomic_load(&visits.count) <= COUNT);
+    }
+
+    // Concatenation isn't commutative, so the reductions only list the elements in order if they combine partial
+    // results in order:
+    hlc_Reduce_instance element_reduce_instance = {.trait = &concatenation_element_reduce_trait, .context = NULL};
+    hlc_Reduce_instance key_reduce_instance = {.trait = &concatenation_key_reduce_trait, .context = NULL};
+    Concatenation elements;
+    Concatenation keys;
+
+    bool ok = hlc_set_parallel_reduce(set, pool, &elements, HLC_LAYOUT_OF(Concatenation), element_reduce_instance)
+      && hlc_map_parallel_reduce(map, pool, &keys, HLC_LAYOUT_OF(Concatenation), key_reduce_instance);
+    assert(ok && !elements.failed && !keys.failed && elements.count == COUNT && keys.count == COUNT);
+
+    for (size_t j = 0; j < COUNT; ++j) {
+      assert(elements.elements[j] == (int)(j + 1) && keys.elements[j] == (int)(j + 1));
+    }
+
+    free(keys.elements);
+    free(elements.elements);
+
+    // Reducing an empty set gives the initial accumulator:
+    hlc_set_clear(set);
+    ok = hlc_set_parallel_reduce(set, pool, &elements, HLC_LAYOUT_OF(Concatenation), element_reduce_instance);
+    assert(ok && !elements.failed && elements.count == 0);
+    free(elements.elements);
+
+    hlc_map_destroy(map);
+    hlc_set_destroy(set);
+    HLC_STACK_FREE(map);
+    HLC_STACK_FREE(set);
+  }
+
+  puts("Testing stats:");
+
+  {
+    hlc_Set* set = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+    assert(set != NULL);
+
+    hlc_set_create(set, HLC_LAYOUT_OF(int), hlc_int_compare_instance, hlc_no_destroy_instance);
+
+    hlc_Set_stats stats = hlc_set_stats(set);
+    assert(stats.count == 0 && stats.total_size == 0 && stats.height == 0 && stats.average_depth == 0);
+    assert(stats.element_size == sizeof(int) && stats.node_size > sizeof(int));
+    assert(stats.overhead == (double)(stats.node_size - sizeof(int)) / (double)stats.node_size);
+
+    // Inserting 1 to 2^k - 1 in order builds a perfect tree, of height k and with 2^(d - 1) nodes at each depth d:
+    for (int k = 1; k <= 10; ++k) {
+      for (int j = 1 << (k - 1); j < 1 << k; ++j) {
+        bool ok = hlc_set_insert(set, &j, hlc_int_assign_instance);
+        assert(ok);
+      }
+
+      size_t count = ((size_t)1 << k) - 1;
+      size_t depth_sum = ((size_t)k - 1) * ((size_t)1 << k) + 1;
+
+      stats = hlc_set_stats(set);
+      assert(stats.count == count && stats.total_size == count * stats.node_size && stats.height == (size_t)k);
+      assert(stats.average_depth == (double)depth_sum / (double)count);
+    }
+
+    // Removing the leftmost leaf of the perfect tree leaves its height unchanged, and removing all but 1 and 2 leaves
+    // a tree of height 2 whichever of them is the root:
+    assert(hlc_set_remove(set, &(int){1}));
+    stats = hlc_set_stats(set);
+    assert(stats.count == 1022 && stats.height == 10);
+
+    for (int j = 3; j < 1024; ++j) {
+      assert(hlc_set_remove(set, &j));
+    }
+
+    assert(hlc_set_insert(set, &(int){1}, hlc_int_assign_instance));
+    stats = hlc_set_stats(set);
+    assert(stats.count == 2 && stats.height == 2 && stats.average_depth == 1.5);
+
+    hlc_set_destroy(set);
+    HLC_STACK_FREE(set);
+  }
+
+  puts("Testing string traits:");
+
+  {
+    hlc_Intern* intern = HLC_STACK_ALLOCATE(hlc_intern_layout.size);
+    assert(intern != NULL);
+
+    hlc_intern_create(intern);
+
+    hlc_Map* owned = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    hlc_Map* interned = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    assert(owned != NULL && interned != NULL);
+
+    hlc_map_create(
+      owned,
+      HLC_LAYOUT_OF(hlc_Bytes),
+      HLC_LAYOUT_OF(int),
+      hlc_bytes_compare_instance,
+      hlc_bytes_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    hlc_map_create(
+      interned,
+      HLC_LAYOUT_OF(const char*),
+      HLC_LAYOUT_OF(int),
+      hlc_cstring_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    hlc_Assign_instance intern_assign_instance = hlc_intern_cstring_assign_instance(intern);
+
+    for (int j = 0; j < COUNT; ++j) {
+      // Keys repeat, and share their first 8 bytes so that comparisons reach past the cached prefixes:
+      char buffer[32];
+      int length = snprintf(buffer, sizeof(buffer), "string-key-%d", j % (COUNT / 4));
+      assert(length > 0);
+
+      const char* key = buffer;
+      hlc_Bytes bytes = {.size = (size_t)length + 1, .data = buffer};
+
+      bool ok = hlc_map_insert(owned, &bytes, &j, hlc_bytes_assign_instance, hlc_int_assign_instance)
+        && hlc_map_insert(interned, &key, &j, intern_assign_instance, hlc_int_assign_instance);
+
+      const int* owned_lookup = hlc_map_lookup(owned, &bytes);
+      const int* interned_lookup = hlc_map_lookup(interned, &key);
+      assert(ok && owned_lookup != NULL && *owned_lookup == j && interned_lookup != NULL && *interned_lookup == j);
+    }
+
+    assert(hlc_map_count(owned) == COUNT / 4 && hlc_map_count(interned) == COUNT / 4);
+    assert(hlc_intern_count(intern) == COUNT / 4);
+
+    const char* missing = "key-";
+    assert(!hlc_map_contains(interned, &missing));
+
+    // Failing to assign a value must leave the map as it was, including the key of a pair being reassigned:
+    hlc_Map* copied = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    assert(copied != NULL);
+
+    hlc_map_create(
+      copied,
+      HLC_LAYOUT_OF(const char*),
+      HLC_LAYOUT_OF(int),
+      hlc_cstring_compare_instance,
+      hlc_cstring_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    hlc_Assign_instance failing_assign_instance = {.trait = &failing_assign_trait, .context = NULL};
+    char buffer[] = "key-1";
+    const char* key = buffer;
+    int value = 1;
+
+    assert(hlc_map_insert(copied, &key, &value, hlc_cstring_assign_instance, hlc_int_assign_instance));
+    assert(!hlc_map_insert(copied, &key, &value, hlc_cstring_assign_instance, failing_assign_instance));
+    assert(!hlc_map_insert(copied, &missing, &value, hlc_cstring_assign_instance, failing_assign_instance));
+
+    buffer[0] = '\0';
+    const char* same_key = "key-1";
+    const int* copied_lookup = hlc_map_lookup(copied, &same_key);
+    assert(hlc_map_count(copied) == 1 && copied_lookup != NULL && *copied_lookup == 1);
+    assert(!hlc_map_contains(copied, &missing));
+
+    hlc_map_destroy(copied);
+    HLC_STACK_FREE(copied);
+
+    hlc_map_destroy(interned);
+    hlc_map_destroy(owned);
+    HLC_STACK_FREE(interned);
+    HLC_STACK_FREE(owned);
+
+    hlc_intern_destroy(intern);
+    HLC_STACK_FREE(intern);
+  }
+
+  {
+    // Distinct keys which tie on their first 8 bytes, so that comparisons go past the prefixes cached in nodes. They
+    // are zero-padded, so that their order is that of their numbers:
+    hlc_Map* map = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    bool* present = calloc(COUNT, sizeof(bool));
+    assert(map != NULL && present != NULL);
+
+    hlc_map_create(
+      map,
+      HLC_LAYOUT_OF(hlc_Bytes),
+      HLC_LAYOUT_OF(int),
+      hlc_bytes_compare_instance,
+      hlc_bytes_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    // Inserts two random keys for each one removed, checking against the keys known to be present:
+    for (int j = 0; j < 3 * COUNT; ++j) {
+      int number = (int)hlc_random_size_in(random, 0, COUNT - 1);
+      char buffer[32];
+      int length = snprintf(buffer, sizeof(buffer), "shared-prefix-%05d", number);
+      assert(length > 0);
+
+      hlc_Bytes key = {.size = (size_t)length, .data = buffer};
+
+      if (j % 3 != 2) {
+        bool ok = hlc_map_insert(map, &key, &number, hlc_bytes_assign_instance, hlc_int_assign_instance);
+        present[number] = true;
+
+        const int* value = hlc_map_lookup(map, &key);
+        assert(ok && value != NULL && *value == number);
+      } else {
+        bool removed = hlc_map_remove(map, &key);
+        assert(removed == present[number] && !hlc_map_contains(map, &key));
+        present[number] = false;
+      }
+    }
+
+    size_t count = 0;
+
+    for (int number = 0; number < COUNT; ++number) {
+      char buffer[32];
+      int length = snprintf(buffer, sizeof(buffer), "shared-prefix-%05d", number);
+      assert(length > 0);
+
+      hlc_Bytes key = {.size = (size_t)length, .data = buffer};
+      const int* value = hlc_map_lookup(map, &key);
+      assert(present[number] ? value != NULL && *value == number : value == NULL);
+      count += present[number];
+    }
+
+    assert(hlc_map_count(map) == count);
+
+    Prefix_visits visits = {.count = 0, .previous = -1, .ordered = true};
+    bool visited = hlc_map_for_each(map, shared_prefix_visit, &visits);
+    assert(visited && visits.ordered && visits.count == count);
+
+    hlc_map_destroy(map);
+    HLC_STACK_FREE(map);
+    free(present);
+  }
+
+  puts("Testing random engines:");
+
+  {
+    // The 10000th outputs from the seed 5489, as the C++ standard gives for std::mt19937 and std::mt19937_64, and as
+    // the reference implementations of xoshiro256** and PCG64 produce from states expanded from it with splitmix64:
+    static const struct {
+      hlc_Random_engine engine;
+      unsigned long long output;
+    } known_outputs[] = {
+      {HLC_RANDOM_MT19937, 4123659995ULL},
+      {HLC_RANDOM_MT19937_64, 9981545732273789042ULL},
+      {HLC_RANDOM_XOSHIRO256, 10745431899595660155ULL},
+      {HLC_RANDOM_PCG64, 1241524388852966023ULL},
+    };
+
+    hlc_Random* known_random = HLC_STACK_ALLOCATE(hlc_random_layout.size);
+    assert(known_random != NULL);
+
+    for (size_t k = 0; k < sizeof(known_outputs) / sizeof(known_outputs[0]); ++k) {
+      hlc_random_create_with_engine(known_random, known_outputs[k].engine, 5489);
+      assert(hlc_random_engine(known_random) == known_outputs[k].engine);
+
+      // Full ranges return outputs unchanged: 32 bits for MT19937, and 64 bits for the other engines.
+      unsigned long long output = 0;
+
+      for (size_t j = 0; j < 10000; ++j) {
+        output = known_outputs[k].engine == HLC_RANDOM_MT19937
+          ? hlc_random_ulong_in(known_random, 0, 0xFFFFFFFFUL)
+          : hlc_random_ullong_in(known_random, 0, ULLONG_MAX);
+      }
+
+      assert(output == known_outputs[k].output);
+    }
+
+    hlc_random_create_with(known_random, 5489);
+
+    for (size_t j = 1; j < 10000; ++j) {
+      hlc_random_ulong_in(known_random, 0, 0xFFFFFFFFUL);
+    }
+
+    assert(hlc_random_ulong_in(known_random, 0, 0xFFFFFFFFUL) == 4123659995UL);
+
+    HLC_STACK_FREE(known_random);
+  }
+
+  puts("Testing random utilities:");
+
+  {
+    // Statistical checks use fixed seeds, and tolerances of several standard deviations.
+    hlc_Random* fixed = HLC_STACK_ALLOCATE(hlc_random_layout.size);
+    hlc_Random* copy = HLC_STACK_ALLOCATE(hlc_random_layout.size);
+    assert(fixed != NULL && copy != NULL);
+
+    hlc_random_create_with_engine(fixed, HLC_RANDOM_XOSHIRO256, 42);
+
+    // Samples are strictly increasing and in range, whether method A or D draws them:
+    size_t indices[200];
+
+    for (size_t n = 0; n <= 200; n += n < 40 ? 1 : 20) {
+      for (size_t k = 0; k <= n; k += k < 10 ? 1 : 7) {
+        hlc_random_sample(fixed, indices, k, n);
+
+        for (size_t j = 0; j < k; ++j) {
+          assert(indices[j] < n && (j == 0 || indices[j - 1] < indices[j]));
+        }
+      }
+    }
+
+    // Each index is sampled with probability k / n, for (n, k) = (10, 4) drawn by method A and (100, 3) by method D:
+    size_t sample_ns[] = {10, 100};
+    size_t sample_ks[] = {4, 3};
+
+    for (size_t p = 0; p < 2; ++p) {
+      size_t frequencies[100] = {0};
+      size_t trials = 100000;
+
+      for (size_t t = 0; t < trials; ++t) {
+        hlc_random_sample(fixed, indices, sample_ks[p], sample_ns[p]);
+
+        for (size_t j = 0; j < sample_ks[p]; ++j) {
+          frequencies[indices[j]] += 1;
+        }
+      }
+
+      double expected = (double)trials * (double)sample_ks[p] / (double)sample_ns[p];
+
+      for (size_t j = 0; j < sample_ns[p]; ++j) {
+        assert(frequencies[j] > 0.9 * expected && frequencies[j] < 1.1 * expected);
+      }
+    }
+
+    // Rank r of a Zipf distribution over 10 ranks with exponent 1 is drawn with probability 1 / ((r + 1) H(10)):
+    hlc_Random_zipf* zipf = HLC_STACK_ALLOCATE(hlc_random_zipf_layout.size);
+    assert(zipf != NULL);
+
+    hlc_random_zipf_create(zipf, 10, 1.0);
+    size_t ranks[10] = {0};
+    double harmonic = 0;
+
+    for (size_t j = 0; j < 100000; ++j) {
+      size_t rank = hlc_random_zipf_next(zipf, fixed);
+      assert(rank < 10);
+      ranks[rank] += 1;
+    }
+
+    for (size_t r = 0; r < 10; ++r) {
+      harmonic += 1.0 / (double)(r + 1);
+    }
+
+    for (size_t r = 0; r < 10; ++r) {
+      double expected = 100000 / ((double)(r + 1) * harmonic);
+      assert(ranks[r] > 0.9 * expected && ranks[r] < 1.1 * expected);
+    }
+
+    hlc_random_zipf_create(zipf, 1, 2.0);
+    assert(hlc_random_zipf_next(zipf, fixed) == 0);
+
+    HLC_STACK_FREE(zipf);
+
+    // Doubles are multiples of 2^-53 in [0, 1), averaging 1/2:
+    double double_sum = 0;
+
+    for (size_t j = 0; j < 100000; ++j) {
+      double x = hlc_random_double(fixed);
+      assert(x >= 0 && x < 1 && (double)(unsigned long long)(x * 0x1p53) == x * 0x1p53);
+      double_sum += x;
+    }
+
+    assert(double_sum / 100000 > 0.49 && double_sum / 100000 < 0.51);
+
+    // Filling takes the bytes of 64-bit outputs from the lowest one, and filling with sizes in a range draws the same
+    // sizes as drawing them one by one:
+    hlc_random_create_with_engine(fixed, HLC_RANDOM_PCG64, 7);
+    hlc_random_create_with_engine(copy, HLC_RANDOM_PCG64, 7);
+
+    unsigned char bytes[13];
+    hlc_random_fill(fixed, bytes, sizeof(bytes));
+
+    for (size_t j = 0; j < sizeof(bytes); j += 8) {
+      unsigned long long x = hlc_random_ullong_in(copy, 0, ULLONG_MAX);
+
+      for (size_t b = 0; b < 8 && j + b < sizeof(bytes); ++b) {
+        assert(bytes[j + b] == (unsigned char)(x >> 8 * b));
+      }
+    }
+
+    size_t mins[] = {3, 0, 1};
+    size_t maxs[] = {9, SIZE_MAX, SIZE_MAX / 3};
+    size_t sizes[100];
+
+    for (size_t p = 0; p < 3; ++p) {
+      hlc_random_fill_size_in(fixed, sizes, 100, mins[p], maxs[p]);
+
+      for (size_t j = 0; j < 100; ++j) {
+        assert(sizes[j] >= mins[p] && sizes[j] <= maxs[p] && sizes[j] == hlc_random_size_in(copy, mins[p], maxs[p]));
+      }
+    }
+
+    HLC_STACK_FREE(copy);
+    HLC_STACK_FREE(fixed);
+  }
+
+  puts("Testing compare_many:");
+
+  COMPARE_MANY_MATCHES(random, schar, signed char, SCHAR_MIN, SCHAR_MAX);
+  COMPARE_MANY_MATCHES(random, short, short, SHRT_MIN, SHRT_MAX);
+  COMPARE_MANY_MATCHES(random, int, int, INT_MIN, INT_MAX);
+  COMPARE_MANY_MATCHES(random, long, long, LONG_MIN, LONG_MAX);
+  COMPARE_MANY_MATCHES(random, llong, long long, LLONG_MIN, LLONG_MAX);
+  COMPARE_MANY_MATCHES(random, uchar, unsigned char, 0, UCHAR_MAX);
+  COMPARE_MANY_MATCHES(random, ushort, unsigned short, 0, USHRT_MAX);
+  COMPARE_MANY_MATCHES(random, uint, unsigned, 0, UINT_MAX);
+  COMPARE_MANY_MATCHES(random, ulong, unsigned long, 0, ULONG_MAX);
+  COMPARE_MANY_MATCHES(random, ullong, unsigned long long, 0, ULLONG_MAX);
+  COMPARE_MANY_MATCHES(random, size, size_t, 0, SIZE_MAX);
+  COMPARE_MANY_MATCHES(random, ptrdiff, ptrdiff_t, PTRDIFF_MIN, PTRDIFF_MAX);
+  COMPARE_MANY_MATCHES(random, char, char, CHAR_MIN, CHAR_MAX);
+  COMPARE_MANY_MATCHES(random, wchar, wchar_t, WCHAR_MIN, WCHAR_MAX);
+
+  puts("Testing hlc_Radix_map:");
+
+  {
+    long long* keys = malloc(COUNT * sizeof(long long));
+    assert(keys != NULL);
+
+    for (int j = 0; j < COUNT; ++j) {
+      keys[j] = (long long)(j - COUNT / 2) * 1000003;
+    }
+
+    hlc_random_shuffle(random, keys, COUNT, HLC_LAYOUT_OF(long long));
+
+    hlc_Radix_map* map = HLC_STACK_ALLOCATE(hlc_radix_map_layout.size);
+    assert(map != NULL);
+
+    hlc_radix_map_create(map, HLC_LAYOUT_OF(long long), hlc_no_destroy_instance);
+
+    for (int j = 0; j < COUNT; ++j) {
+      unsigned char key[8];
+      hlc_radix_encode_llong(keys[j], key);
+
+      bool ok = hlc_radix_map_insert(map, key, sizeof(key), &keys[j], hlc_llong_assign_instance);
+      const long long* value = hlc_radix_map_lookup(map, key, sizeof(key));
+      assert(ok && value != NULL && *value == keys[j]);
+    }
+
+    assert(hlc_radix_map_count(map) == COUNT);
+
+    Radix_order order = {.count = 0};
+    bool ordered = hlc_radix_map_for_each(map, radix_check_order, &order);
+    assert(ordered && order.count == COUNT);
+
+    // The keys in [0, 2^24) are exactly those sharing the first 5 bytes of 0:
+    unsigned char prefix[8];
+    hlc_radix_encode_llong(0, prefix);
+    order.count = 0;
+    ordered = hlc_radix_map_for_each_prefix(map, prefix, 5, radix_check_order, &order);
+    assert(ordered && order.count == (1LL << 24) / 1000003 + 1);
+
+    for (int j = 0; j < COUNT; j += 2) {
+      unsigned char key[8];
+      hlc_radix_encode_llong(keys[j], key);
+
+      bool ok = hlc_radix_map_remove(map, key, sizeof(key));
+      assert(ok && !hlc_radix_map_contains(map, key, sizeof(key)));
+      assert(hlc_radix_map_contains(map, key, 7) == false);
+    }
+
+    assert(hlc_radix_map_count(map) == COUNT / 2);
+
+    order.count = 0;
+    ordered = hlc_radix_map_for_each(map, radix_check_order, &order);
+    assert(ordered && order.count == COUNT / 2);
+
+    hlc_radix_map_destroy(map);
+    HLC_STACK_FREE(map);
+    free(keys);
+  }
+
+  {
+    // Each key is a prefix of the next, so that the map is a chain of inner nodes as deep as the longest key:
+    const size_t depth = 5000;
+    unsigned char* key = malloc(depth);
+    assert(key != NULL);
+
+    memset(key, 'a', depth);
+
+    hlc_Radix_map* map = HLC_STACK_ALLOCATE(hlc_radix_map_layout.size);
+    assert(map != NULL);
+
+    hlc_radix_map_create(map, HLC_LAYOUT_OF(size_t), hlc_no_destroy_instance);
+
+    for (int pass = 0; pass < 2; ++pass) {
+      for (size_t size = 1; size <= depth; ++size) {
+        bool ok = hlc_radix_map_insert(map, key, size, &size, hlc_size_assign_instance);
+        assert(ok);
+      }
+
+      const size_t* value = hlc_radix_map_lookup(map, key, depth);
+      assert(hlc_radix_map_count(map) == depth && value != NULL && *value == depth);
+
+      Radix_order order = {.count = 0};
+      bool ordered = hlc_radix_map_for_each(map, radix_check_nested, &order);
+      assert(ordered && order.count == depth);
+
+      order.count = depth / 2 - 1;
+      ordered = hlc_radix_map_for_each_prefix(map, key, depth / 2, radix_check_nested, &order);
+      assert(ordered && order.count == depth);
+
+      // The first pass clears the map, and the second one destroys it:
+      if (pass == 0) {
+        hlc_radix_map_clear(map);
+        assert(hlc_radix_map_count(map) == 0);
+      }
+    }
+
+    hlc_radix_map_destroy(map);
+    HLC_STACK_FREE(map);
+    free(key);
+  }
+
+  puts("Testing hlc_Multiset and hlc_Multimap:");
+
+  {
+    hlc_Multiset* multiset = HLC_STACK_ALLOCATE(hlc_multiset_layout.size);
+    hlc_Multimap* multimap = HLC_STACK_ALLOCATE(hlc_multimap_layout.size);
+    assert(multiset != NULL && multimap != NULL);
+
+    hlc_multiset_create(multiset, HLC_LAYOUT_OF(int), hlc_int_compare_instance, hlc_no_destroy_instance);
+
+    hlc_multimap_create(
+      multimap,
+      HLC_LAYOUT_OF(int),
+      HLC_LAYOUT_OF(int),
+      hlc_int_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    // Few distinct keys, each repeated many times:
+    const int distinct = 97;
+
+    for (int j = 0; j < COUNT; ++j) {
+      int key = j % distinct;
+
+      bool ok = hlc_multiset_insert(multiset, &key, hlc_int_assign_instance)
+        && hlc_multimap_insert(multimap, &key, &j, hlc_int_assign_instance, hlc_int_assign_instance);
+
+      assert(ok);
+    }
+
+    assert(hlc_multiset_count(multiset) == COUNT && hlc_multiset_distinct_count(multiset) == (size_t)distinct);
+    assert(hlc_multimap_count(multimap) == COUNT && hlc_multimap_key_count(multimap) == (size_t)distinct);
+
+    for (int key = 0; key < distinct; ++key) {
+      size_t expected = (size_t)(COUNT / distinct + (key < COUNT % distinct));
+      assert(hlc_multiset_multiplicity(multiset, &key) == expected);
+
+      size_t value_count;
+      const int* values = hlc_multimap_lookup(multimap, &key, &value_count);
+      assert(values != NULL && value_count == expected);
+
+      for (size_t i = 0; i < value_count; ++i) {
+        assert(values[i] == key + (int)i * distinct);
+      }
+    }
+
+    // Removing one occurrence at a time keeps the element until its last one:
+    int key = 3;
+    size_t multiplicity = hlc_multiset_multiplicity(multiset, &key);
+
+    for (size_t i = 1; i < multiplicity; ++i) {
+      assert(hlc_multiset_remove(multiset, &key) && hlc_multiset_contains(multiset, &key));
+    }
+
+    assert(hlc_multiset_remove(multiset, &key) && !hlc_multiset_contains(multiset, &key));
+    assert(!hlc_multiset_remove(multiset, &key));
+    assert(hlc_multiset_count(multiset) == COUNT - multiplicity);
+
+    key = 5;
+    assert(hlc_multiset_remove_all(multiset, &key) == multiplicity);
+    assert(hlc_multiset_distinct_count(multiset) == (size_t)distinct - 2);
+
+    // Removing the first value of a key shifts the others:
+    assert(hlc_multimap_remove_at(multimap, &key, 0));
+
+    size_t value_count;
+    const int* values = hlc_multimap_lookup(multimap, &key, &value_count);
+    assert(value_count == multiplicity - 1 && values[0] == key + distinct);
+
+    assert(hlc_multimap_remove(multimap, &key) == multiplicity - 1);
+    assert(!hlc_multimap_contains(multimap, &key) && hlc_multimap_lookup(multimap, &key, &value_count) == NULL);
+    assert(hlc_multimap_count(multimap) == COUNT - multiplicity);
+
+    hlc_multimap_destroy(multimap);
+    hlc_multiset_destroy(multiset);
+    HLC_STACK_FREE(multimap);
+    HLC_STACK_FREE(multiset);
+  }
+
+  puts("Testing min/max and pops:");
+
+  {
+    int* elements = malloc(COUNT * sizeof(int));
+    assert(elements != NULL);
+
+    for (int j = 0; j < COUNT; ++j) {
+      elements[j] = j;
+    }
+
+    hlc_random_shuffle(random, elements, COUNT, HLC_LAYOUT_OF(int));
+
+    hlc_Set* set = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+    hlc_Map* map = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    assert(set != NULL && map != NULL);
+
+    hlc_set_create(set, HLC_LAYOUT_OF(int), hlc_int_compare_instance, hlc_no_destroy_instance);
+
+    hlc_map_create(
+      map,
+      HLC_LAYOUT_OF(int),
+      HLC_LAYOUT_OF(int),
+      hlc_int_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    assert(hlc_set_min(set) == NULL && hlc_map_max(map).key == NULL && !hlc_set_pop_max(set, NULL));
+
+    for (int j = 0; j < COUNT; ++j) {
+      int value = -elements[j];
+      bool ok = hlc_set_insert(set, &elements[j], hlc_int_assign_instance)
+        && hlc_map_insert(map, &elements[j], &value, hlc_int_assign_instance, hlc_int_assign_instance);
+
+      assert(ok);
+    }
+
+    // Removing elements from the middle must keep the cached extremes, unless they're removed themselves:
+    for (int j = 0; j < COUNT / 2; ++j) {
+      bool ok = hlc_set_remove(set, &elements[j]) && hlc_map_remove(map, &elements[j]);
+      assert(ok);
+    }
+
+    int low = 0;
+    int high = COUNT - 1;
+    int count = 0;
+
+    while (hlc_set_count(set) > 0) {
+      int element;
+      int key;
+      int value;
+
+      if (count % 2 == 0) {
+        while (!hlc_map_contains(map, &low)) {
+          ++low;
+        }
+
+        hlc_Map_kv_ref min = hlc_map_min(map);
+        assert(*(const int*)hlc_set_min(set) == low && *(const int*)min.key == low && *(int*)min.value == -low);
+
+        bool ok = hlc_set_pop_min(set, &element) && hlc_map_pop_min(map, &key, &value);
+        assert(ok && element == low && key == low && value == -low);
+      } else {
+        while (!hlc_map_contains(map, &high)) {
+          --high;
+        }
+
+        hlc_Map_kv_ref max = hlc_map_max(map);
+        assert(*(const int*)hlc_set_max(set) == high && *(const int*)max.key == high && *(int*)max.value == -high);
+
+        bool ok = hlc_set_pop_max(set, NULL) && hlc_map_pop_max(map, NULL, NULL);
+        assert(ok);
+      }
+
+      count += 1;
+    }
+
+    assert(count == COUNT - COUNT / 2 && hlc_map_count(map) == 0);
+    assert(hlc_set_max(set) == NULL && hlc_map_min(map).value == NULL && !hlc_map_pop_min(map, NULL, NULL));
+
+    hlc_map_destroy(map);
+    hlc_set_destroy(set);
+    HLC_STACK_FREE(map);
+    HLC_STACK_FREE(set);
+    free(elements);
+  }
+
+  puts("Testing range removal:");
+
+  {
+    hlc_Set* set = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+    hlc_Map* map = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+    assert(set != NULL && map != NULL);
+
+    hlc_set_create(set, HLC_LAYOUT_OF(int), hlc_int_compare_instance, hlc_no_destroy_instance);
+
+    hlc_map_create(
+      map,
+      HLC_LAYOUT_OF(int),
+      HLC_LAYOUT_OF(int),
+      hlc_int_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance
+    );
+
+    // Even elements from 0 to 2 * (COUNT - 1):
+    for (int j = 0; j < COUNT; ++j) {
+      int element = 2 * j;
+      int value = -element;
+      bool ok = hlc_set_insert(set, &element, hlc_int_assign_instance)
+        && hlc_map_insert(map, &element, &value, hlc_int_assign_instance, hlc_int_assign_instance);
+
+      assert(ok);
+    }
+
+    // Ranges whose bounds fall between elements, or outside of them, or cross each other:
+    int lo = 99;
+    int hi = 201;
+    assert(hlc_set_remove_range(set, &lo, &hi) == 51 && hlc_map_remove_range(map, &lo, &hi) == 51);
+    assert(hlc_set_remove_range(set, &lo, &hi) == 0 && hlc_map_remove_range(map, &lo, &hi) == 0);
+    lo = 300;
+    hi = 298;
+    assert(hlc_set_remove_range(set, &lo, &hi) == 0 && hlc_map_remove_range(map, &lo, &hi) == 0);
+
+    lo = 98;
+    hi = 202;
+    assert(hlc_set_contains(set, &lo) && hlc_set_contains(set, &hi) && hlc_map_contains(map, &hi));
+
+    // Expiring everything below a cutoff, then above one, moves the extremes:
+    lo = -100;
+    hi = 1000;
+    assert(hlc_set_remove_range(set, &lo, &hi) == 501 - 51 && hlc_map_remove_range(map, &lo, &hi) == 501 - 51);
+    assert(*(const int*)hlc_set_min(set) == 1002 && *(const int*)hlc_map_min(map).key == 1002);
+
+    lo = 2 * COUNT - 1000;
+    hi = 2 * COUNT;
+    assert(hlc_set_remove_range(set, &lo, &hi) == 500 && hlc_map_remove_range(map, &lo, &hi) == 500);
+    assert(*(const int*)hlc_set_max(set) == lo - 2 && *(int*)hlc_map_max(map).value == -(lo - 2));
+
+    size_t count = COUNT - 501 - 500;
+    assert(hlc_set_count(set) == count && hlc_map_count(map) == count);
+
+    lo = 0;
+    hi = 2 * COUNT;
+    assert(hlc_set_remove_range(set, &lo, &hi) == count && hlc_map_remove_range(map, &lo, &hi) == count);
+    assert(hlc_set_count(set) == 0 && hlc_set_min(set) == NULL && hlc_map_max(map).key == NULL);
+
+    hlc_map_destroy(map);
+    hlc_set_destroy(set);
+    HLC_STACK_FREE(map);
+    HLC_STACK_FREE(set);
+  }
+
+  puts("Testing hlc_Lru_cache:");
+
+  {
+    hlc_Lru_cache* cache = HLC_STACK_ALLOCATE(hlc_lru_cache_layout.size);
+    assert(cache != NULL);
+
+    size_t evictions = 0;
+    const size_t capacity = 100;
+
+    hlc_lru_cache_create(
+      cache,
+      HLC_LAYOUT_OF(int),
+      HLC_LAYOUT_OF(int),
+      hlc_int_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance,
+      (hlc_Destroy_instance){.trait = &eviction_destroy_trait, .context = &evictions},
+      capacity
+    );
+
+    for (int j = 0; j < COUNT; ++j) {
+      int value = -j;
+      bool ok = hlc_lru_cache_insert(cache, &j, &value, 1, hlc_int_assign_instance, hlc_int_assign_instance);
+      assert(ok && hlc_lru_cache_count(cache) == ((size_t)j < capacity ? (size_t)j + 1 : capacity));
+
+      // Keeping key 0 in use keeps it from being evicted:
+      int key = 0;
+      assert(hlc_lru_cache_lookup(cache, &key) != NULL);
+    }
+
+    assert(evictions == COUNT - capacity);
+
+    int key = COUNT - (int)capacity + 1;
+    assert(hlc_lru_cache_peek(cache, &key) != NULL);
+    key -= 1;
+    assert(!hlc_lru_cache_contains(cache, &key));
+
+    // Charging a pair for half the capacity evicts the half least recently used:
+    key = -1;
+    int value = 1;
+    bool ok = hlc_lru_cache_insert(cache, &key, &value, capacity / 2, hlc_int_assign_instance, hlc_int_assign_instance);
+    assert(ok && hlc_lru_cache_count(cache) == capacity / 2 + 1 && hlc_lru_cache_charge(cache) == capacity);
+
+    key = 0;
+    assert(hlc_lru_cache_contains(cache, &key) && hlc_lru_cache_remove(cache, &key));
+    assert(!hlc_lru_cache_remove(cache, &key));
+
+    hlc_lru_cache_set_capacity(cache, capacity / 2);
+    key = -1;
+    assert(hlc_lru_cache_count(cache) == 1 && hlc_lru_cache_contains(cache, &key));
+    assert(evictions == COUNT - 1);
+
+    // A pair whose charge alone exceeds the capacity is evicted alone, whether it's new or reassigned:
+    key = -2;
+    value = 2;
+    ok = hlc_lru_cache_insert(cache, &key, &value, capacity, hlc_int_assign_instance, hlc_int_assign_instance);
+    assert(ok && !hlc_lru_cache_contains(cache, &key) && evictions == COUNT);
+
+    key = -1;
+    assert(hlc_lru_cache_count(cache) == 1 && hlc_lru_cache_contains(cache, &key));
+
+    value = 1;
+    ok = hlc_lru_cache_insert(cache, &key, &value, capacity, hlc_int_assign_instance, hlc_int_assign_instance);
+    assert(ok && hlc_lru_cache_count(cache) == 0 && hlc_lru_cache_charge(cache) == 0 && evictions == COUNT + 1);
+
+    hlc_lru_cache_destroy(cache);
+    HLC_STACK_FREE(cache);
+  }
+
+  puts("Testing hlc_Interval_map:");
+
+  {
+    hlc_Interval_map* map = HLC_STACK_ALLOCATE(hlc_interval_map_layout.size);
+    assert(map != NULL);
+
+    hlc_interval_map_create(
+      map,
+      HLC_LAYOUT_OF(int),
+      HLC_LAYOUT_OF(int),
+      hlc_int_compare_instance,
+      hlc_no_destroy_instance
+    );
+
+    // Intervals [lo, lo + length] with lo < 1000 and length < 100, checked against a table of those present:
+    bool* present = calloc(1000 * 100, sizeof(bool));
+    assert(present != NULL);
+
+    size_t count = 0;
+
+    for (size_t j = 0; j < COUNT; ++j) {
+      int lo = (int)hlc_random_uint_in(random, 0, 999);
+      int length = (int)hlc_random_uint_in(random, 0, 99);
+      int hi = lo + length;
+      bool* interval_present = &present[lo * 100 + length];
+
+      if (j % 3 == 2) {
+        assert(hlc_interval_map_remove(map, &lo, &hi) == *interval_present);
+        count -= *interval_present;
+        *interval_present = false;
+      } else {
+        int value = lo * 100 + length;
+        bool ok = hlc_interval_map_insert(map, &lo, &hi, &value, hlc_int_assign_instance);
+        assert(ok);
+        count += !*interval_present;
+        *interval_present = true;
+      }
+
+      assert(hlc_interval_map_count(map) == count);
+    }
+
+    for (int lo = -10; lo < 1110; lo += 7) {
+      for (int length = 0; length < 30; length += 29) {
+        Interval_query query = {.lo = lo, .hi = lo + length, .count = 0};
+        size_t expected = 0;
+
+        for (int k = 0; k < 1000 * 100; ++k) {
+          expected += present[k] && k / 100 <= query.hi && k / 100 + k % 100 >= query.lo;
+        }
+
+        bool ok = length == 0
+          ? hlc_interval_map_stab(map, &lo, interval_check_overlap, &query)
+          : hlc_interval_map_overlaps(map, &query.lo, &query.hi, interval_check_overlap, &query);
+
+        assert(ok && query.count == expected);
+      }
+    }
+
+    int lo = 500;
+    int hi = 500;
+    hlc_interval_map_clear(map);
+    assert(hlc_interval_map_count(map) == 0 && hlc_interval_map_lookup(map, &lo, &hi) == NULL);
+
+    hlc_interval_map_destroy(map);
+    HLC_STACK_FREE(map);
+    free(present);
+  }
+
+  #ifdef HLC_TRACE
+    puts("Testing trace recording and replay:");
+
+    {
+      const char* path = "hlc_trace_test.bin";
+      hlc_Set* a = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+      hlc_Set* b = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+      hlc_Set* c = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+      assert(a != NULL && b != NULL && c != NULL);
+      assert(hlc_trace_start(path, 0x9E3779B97F4A7C15ULL));
+
+      hlc_set_create(a, HLC_LAYOUT_OF(int), hlc_int_compare_instance, hlc_no_destroy_instance);
+      hlc_set_create(b, HLC_LAYOUT_OF(int), hlc_int_compare_instance, hlc_no_destroy_instance);
+
+      for (int i = 0; i < 100; ++i) {
+        bool ok = hlc_set_insert(b, &i, hlc_int_assign_instance);
+        assert(ok);
+      }
+
+      // The moved contents must stay under the identifier of the target, even once the source is destroyed:
+      hlc_set_move_reassign(a, b);
+      hlc_set_destroy(b);
+
+      for (int i = 0; i < 150; ++i) {
+        assert(hlc_set_contains(a, &i) == (i < 100));
+      }
+
+      bool ok = hlc_set_clone(a, c, hlc_int_assign_instance);
+      assert(ok);
+      hlc_set_destroy(a);
+
+      for (int i = 50; i < 150; i += 2) {
+        assert(hlc_set_remove(c, &i) == (i < 100));
+        assert(!hlc_set_contains(c, &i) && hlc_set_contains(c, &(int){i - 1}) == (i <= 100));
+      }
+
+      hlc_set_destroy(c);
+      assert(hlc_trace_stop());
+      // The lookups of 0 to 99 in the moved set and of the odd numbers 49 to 99 in its clone hit:
+      assert(trace_replay_hits(path) == 100 + 26);
+      remove(path);
+
+      HLC_STACK_FREE(c);
+      HLC_STACK_FREE(b);
+      HLC_STACK_FREE(a);
+    }
+  #endif
+
+  #ifdef HLC_COUNTERS
+    puts("Testing counters:");
+
+    {
+      hlc_Set* set = HLC_STACK_ALLOCATE(hlc_set_layout.size);
+      hlc_Map* map = HLC_STACK_ALLOCATE(hlc_map_layout.size);
+      assert(set != NULL && map != NULL);
+
+      hlc_set_create(set, HLC_LAYOUT_OF(int), hlc_int_compare_instance, hlc_no_destroy_instance);
+      hlc_map_create(
+        map,
+        HLC_LAYOUT_OF(int),
+        HLC_LAYOUT_OF(int),
+        hlc_int_compare_instance,
+        hlc_no_destroy_instance,
+        hlc_no_destroy_instance
+      );
+
+      // Inserting 1, 2 and 3 rotates once, and 2 ends up at the root:
+      for (int i = 1; i <= 3; ++i) {
+        bool ok = hlc_set_insert(set, &i, hlc_int_assign_instance);
+        assert(ok);
+      }
+
+      assert(hlc_set_contains(set, &(int){3}) && !hlc_set_contains(set, &(int){4}));
+      assert(hlc_set_remove(set, &(int){1}));
+
+      hlc_Counters counters = hlc_set_counters(set);
+      assert(counters.lookups == 2 && counters.lookup_comparisons == 4);
+      assert(counters.insertions == 3 && counters.insertion_comparisons == 3);
+      assert(counters.removals == 1 && counters.removal_comparisons == 2);
+      assert(counters.rotations == 1 && counters.rebalance_iterations == 4);
+      assert(counters.allocations == 3 && counters.frees == 1 && counters.assigns == 3 && counters.reassigns == 0);
+
+      hlc_set_reset_counters(set);
+      counters = hlc_set_counters(set);
+      assert(counters.lookups == 0 && counters.insertions == 0 && counters.rotations == 0 && counters.allocations == 0);
+
+      // Assigning the values of the map inserts them into the set, which must not stop the map from counting the
+      // rotation which follows:
+      hlc_Assign_instance nested_assign_instance = {.trait = &nested_assign_trait, .context = set};
+
+      for (int i = 4; i <= 6; ++i) {
+        bool ok = hlc_map_insert(map, &i, &i, hlc_int_assign_instance, nested_assign_instance);
+        assert(ok);
+      }
+
+      counters = hlc_map_counters(map);
+      assert(counters.insertions == 3 && counters.insertion_comparisons == 3 && counters.rotations == 1);
+      assert(counters.allocations == 3 && counters.assigns == 3);
+
+      // The set held 2 and 3, and rotated when 4 and 6 were inserted:
+      counters = hlc_set_counters(set);
+      assert(counters.insertions == 3 && counters.insertion_comparisons == 7 && counters.rotations == 2);
+      assert(counters.allocations == 3 && counters.assigns == 3);
+
+      hlc_map_destroy(map);
+      hlc_set_destroy(set);
+      HLC_STACK_FREE(map);
+      HLC_STACK_FREE(set);
+    }
+  #endif
+
+  hlc_task_pool_destroy(pool);
+  HLC_STACK_FREE(pool);
+
   HLC_STACK_FREE(random);
 
   return EXIT_SUCCESS;
@@ -5,20 +5,33 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "avl.h"
+#include "counters.h"
+#include "eytzinger.h"
 #include "layout.h"
 #include "math.h"
-#include "stack.h"
+#include "prefetch.h"
+#include "scratch.h"
+#include "slab.h"
+#include "task.h"
+#include "trace.h"
 #include "traits/assign.h"
 #include "traits/compare.h"
 #include "traits/destroy.h"
+#include "traits/reduce.h"
 
 
 struct hlc_Map {
   hlc_AVL* root;
   size_t count;
+
+  // The nodes of the minimum and maximum keys, kept up to date so that they're reached without a descent.
+  hlc_AVL* leftmost;
+  hlc_AVL* rightmost;
+
   hlc_Layout key_layout;
   hlc_Layout value_layout;
   hlc_Compare_instance key_compare_instance;
@@ -28,11 +41,32 @@ struct hlc_Map {
   hlc_Layout kv_layout;
   size_t key_offset;
   size_t value_offset;
+
+  // If the compare trait has a prefix hook, nodes cache the prefixes of their keys before the keys, right after the
+  // links, and searches only call the compare trait when prefixes are equal.
+  bool key_prefixes;
+  size_t prefix_offset;
+
+  // With HLC_MAP_VALUES_OUT_OF_LINE, nodes hold pointers to values allocated from this slab allocator.
+  bool values_out_of_line;
+  hlc_Slab values;
+
+  #ifdef HLC_COUNTERS
+    hlc_Atomic_counters counters;
+  #endif
+
+  #ifdef HLC_TRACE
+    unsigned long trace_id;
+  #endif
 };
 
 const hlc_Layout hlc_map_layout = {.size = sizeof(hlc_Map), .alignment = alignof(hlc_Map)};
 
 
+/// @brief The number of searches hlc_map_lookup_batch advances in lockstep.
+#define HLC_MAP_BATCH 8
+
+
 struct hlc_Map_iterator {
   hlc_AVL* current;
   hlc_Layout key_layout;
@@ -41,11 +75,94 @@ struct hlc_Map_iterator {
   hlc_Layout kv_layout;
   size_t key_offset;
   size_t value_offset;
+  bool values_out_of_line;
 };
 
 const hlc_Layout hlc_map_iterator_layout = {.size = sizeof(hlc_Map_iterator), .alignment = alignof(hlc_Map_iterator)};
 
 
+struct hlc_Frozen_map {
+  char* keys;
+  char* values;
+  size_t count;
+  hlc_Layout key_layout;
+  hlc_Layout value_layout;
+  hlc_Compare_instance key_compare_instance;
+  hlc_Destroy_instance key_destroy_instance;
+  hlc_Destroy_instance value_destroy_instance;
+};
+
+const hlc_Layout hlc_frozen_map_layout = {.size = sizeof(hlc_Frozen_map), .alignment = alignof(hlc_Frozen_map)};
+
+
+struct hlc_Frozen_map_iterator {
+  const char* keys;
+  char* values;
+  size_t count;
+  size_t current;
+  size_t key_size;
+  size_t value_size;
+};
+
+const hlc_Layout hlc_frozen_map_iterator_layout = {
+  .size = sizeof(hlc_Frozen_map_iterator),
+  .alignment = alignof(hlc_Frozen_map_iterator),
+};
+
+
+/// @brief Returns the value of a key/value pair, which is either stored in the node or pointed to by it.
+static inline void* hlc_map_kv_value(const void* kv, size_t value_offset, bool values_out_of_line) {
+  void* value = (char*)kv + value_offset;
+  return values_out_of_line ? *(void**)value : value;
+}
+
+
+/// @brief Returns the prefix of a key, or 0 if the map doesn't cache prefixes.
+static inline unsigned long long hlc_map_key_prefix(const hlc_Map* map, const void* key) {
+  return map->key_prefixes ? hlc_compare_prefix(key, map->key_compare_instance) : 0;
+}
+
+
+/// @brief Compares a key with the key of a node, comparing their prefixes first if the map caches them.
+static inline signed char hlc_map_kv_compare(
+  const hlc_Map* map,
+  const void* key,
+  unsigned long long key_prefix,
+  const void* kv
+) {
+  if (map->key_prefixes) {
+    unsigned long long kv_prefix = *(const unsigned long long*)((const char*)kv + map->prefix_offset);
+
+    if (key_prefix != kv_prefix)
+      return key_prefix < kv_prefix ? -1 : +1;
+  }
+
+  return hlc_compare(key, (const char*)kv + map->key_offset, map->key_compare_instance);
+}
+
+
+/// @brief Updates the leftmost/rightmost nodes after a node was inserted to the left/right of a node.
+static inline void hlc_map_xmost_after_insertion(hlc_Map* map, hlc_AVL* node, signed char direction) {
+  if (direction < 0 && node == map->leftmost) {
+    map->leftmost = hlc_avl_xcessor(node, -1);
+  } else if (direction > 0 && node == map->rightmost) {
+    map->rightmost = hlc_avl_xcessor(node, +1);
+  }
+}
+
+
+/// @brief Updates the leftmost/rightmost nodes before a node is removed.
+static inline void hlc_map_xmost_before_removal(hlc_Map* map, hlc_AVL* node) {
+  if (node == map->leftmost) {
+    map->leftmost = hlc_avl_xcessor(node, +1);
+  }
+
+  if (node == map->rightmost) {
+    map->rightmost = hlc_avl_xcessor(node, -1);
+  }
+}
+
+
 void hlc_map_create(
   hlc_Map* map,
   hlc_Layout key_layout,
@@ -53,21 +170,65 @@ void hlc_map_create(
   hlc_Compare_instance key_compare_instance,
   hlc_Destroy_instance key_destroy_instance,
   hlc_Destroy_instance value_destroy_instance
+) {
+  hlc_map_create_with(
+    map,
+    key_layout,
+    value_layout,
+    key_compare_instance,
+    key_destroy_instance,
+    value_destroy_instance,
+    0
+  );
+}
+
+
+void hlc_map_create_with(
+  hlc_Map* map,
+  hlc_Layout key_layout,
+  hlc_Layout value_layout,
+  hlc_Compare_instance key_compare_instance,
+  hlc_Destroy_instance key_destroy_instance,
+  hlc_Destroy_instance value_destroy_instance,
+  unsigned flags
 ) {
   assert(map != NULL);
 
   map->root = NULL;
   map->count = 0;
+  map->leftmost = NULL;
+  map->rightmost = NULL;
   map->key_layout = key_layout;
   map->value_layout = value_layout;
   map->key_compare_instance = key_compare_instance;
   map->key_destroy_instance = key_destroy_instance;
   map->value_destroy_instance = value_destroy_instance;
 
+  map->values_out_of_line = (flags & HLC_MAP_VALUES_OUT_OF_LINE) != 0;
+  hlc_slab_create(&map->values, map->values_out_of_line ? value_layout : (hlc_Layout){.size = 0, .alignment = 1});
+
+  map->key_prefixes = key_compare_instance.trait->prefix != NULL;
+  map->prefix_offset = 0;
+
   map->kv_layout = (hlc_Layout){.size = 0, .alignment = 1};
+
+  if (map->key_prefixes) {
+    map->prefix_offset = hlc_layout_add(&map->kv_layout, HLC_LAYOUT_OF(unsigned long long));
+  }
+
   map->key_offset = hlc_layout_add(&map->kv_layout, key_layout);
-  map->value_offset = hlc_layout_add(&map->kv_layout, value_layout);
+  map->value_offset = hlc_layout_add(&map->kv_layout, map->values_out_of_line ? HLC_LAYOUT_OF(void*) : value_layout);
   hlc_layout_pad(&map->kv_layout);
+
+  #ifdef HLC_COUNTERS
+    hlc_counters_reset(&map->counters);
+  #endif
+
+  #ifdef HLC_TRACE
+    map->trace_id = HLC_TRACE_NEW_ID();
+  #endif
+
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CREATE, HLC_TRACE_MAP, map->trace_id, 0);
 }
 
 
@@ -77,16 +238,67 @@ size_t hlc_map_count(const hlc_Map* map) {
 }
 
 
+hlc_Map_stats hlc_map_stats(const hlc_Map* map) {
+  assert(map != NULL);
+
+  hlc_Layout node_layout = hlc_avl_layout(map->kv_layout);
+  size_t kv_size = map->key_layout.size + map->value_layout.size;
+  size_t element_size = node_layout.size + (map->values_out_of_line ? map->values.slot_layout.size : 0);
+
+  return (hlc_Map_stats){
+    .count = map->count,
+    .node_size = node_layout.size,
+    .kv_size = kv_size,
+    .total_size = map->count * node_layout.size + hlc_slab_reserved(&map->values),
+    .overhead = (double)(element_size - kv_size) / (double)element_size,
+    .height = hlc_avl_height(map->root),
+    .average_depth = map->count > 0 ? (double)hlc_avl_depth_sum(map->root) / (double)map->count : 0,
+  };
+}
+
+
 typedef struct hlc_Map_kv_assign_context {
   hlc_Layout kv_layout;
+  hlc_Layout key_layout;
   size_t key_offset;
   size_t value_offset;
   hlc_Assign_instance key_assign_instance;
   hlc_Destroy_instance key_destroy_instance;
   hlc_Assign_instance value_assign_instance;
+
+  /// @brief The allocator of values if they're out of line, or NULL.
+  hlc_Slab* values;
+  hlc_Layout value_layout;
+
+  /// @brief Whether key/value pairs cache the prefixes of their keys, and the prefix of the key to assign if so.
+  bool key_prefixes;
+  size_t prefix_offset;
+  unsigned long long key_prefix;
 } hlc_Map_kv_assign_context;
 
 
+/// @brief Assigns the value of a new key/value pair, allocating it first if values are out of line.
+static bool hlc_map_kv_assign_value(void* kv, const void* value, const hlc_Map_kv_assign_context* context) {
+  void* target = (char*)kv + context->value_offset;
+
+  if (context->values == NULL)
+    return hlc_assign_sized(target, value, context->value_layout.size, context->value_assign_instance);
+
+  void* slot = hlc_slab_allocate(context->values);
+
+  if (slot == NULL)
+    return false;
+
+  if (!hlc_assign_sized(slot, value, context->value_layout.size, context->value_assign_instance)) {
+    hlc_slab_free(context->values, slot);
+    return false;
+  }
+
+  *(void**)target = slot;
+  return true;
+}
+
+
 static bool hlc_map_kv_assign(void* target, const void* _source, const hlc_Assign_trait* trait, void* _context) {
   const hlc_Map_kv_ref* source = _source;
   (void)trait;
@@ -95,11 +307,17 @@ static bool hlc_map_kv_assign(void* target, const void* _source, const hlc_Assig
   assert(source != NULL);
   assert(target != NULL);
 
-  if (hlc_assign((char*)target + context->key_offset, source->key, context->key_assign_instance)) {
-    if (hlc_assign((char*)target + context->value_offset, source->value, context->value_assign_instance)) {
+  void* target_key = (char*)target + context->key_offset;
+
+  if (hlc_assign_sized(target_key, source->key, context->key_layout.size, context->key_assign_instance)) {
+    if (hlc_map_kv_assign_value(target, source->value, context)) {
+      if (context->key_prefixes) {
+        *(unsigned long long*)((char*)target + context->prefix_offset) = context->key_prefix;
+      }
+
       return true;
     } else {
-      hlc_destroy((char*)target + context->key_offset, context->key_destroy_instance);
+      hlc_destroy(target_key, context->key_destroy_instance);
     }
   }
 
@@ -107,6 +325,7 @@ static bool hlc_map_kv_assign(void* target, const void* _source, const hlc_Assig
 }
 
 
+/// @brief Reassigns the value of a pair whose key is equal to the given one, keeping the key already in the map.
 static bool hlc_map_kv_reassign(void* target, const void* _source, const hlc_Assign_trait* trait, void* _context) {
   const hlc_Map_kv_ref* source = _source;
   (void)trait;
@@ -115,26 +334,26 @@ static bool hlc_map_kv_reassign(void* target, const void* _source, const hlc_Ass
   assert(source != NULL);
   assert(target != NULL);
 
-  void* backup = HLC_STACK_ALLOCATE(context->kv_layout.size);
+  void* value = hlc_map_kv_value(target, context->value_offset, context->values != NULL);
 
-  if (backup != NULL) {
-    bool success = false;
+  // Trivial reassignments can't fail, so they need no backup.
+  if (context->value_assign_instance.trait->trivial) {
+    memcpy(value, source->value, context->value_layout.size);
+    return true;
+  }
 
-    memcpy(backup, target, context->kv_layout.size);
+  hlc_Scratch scratch;
+  void* backup = hlc_scratch_acquire(&scratch, context->value_layout.size);
 
-    if (hlc_reassign((char*)target + context->key_offset, source->key, context->key_assign_instance)) {
-      if (hlc_reassign((char*)target + context->value_offset, source->value, context->value_assign_instance)) {
-        success = true;
-      } else {
-        hlc_destroy((char*)target + context->key_offset, context->key_destroy_instance);
-      }
-    }
+  if (backup != NULL) {
+    memcpy(backup, value, context->value_layout.size);
+    bool success = hlc_reassign(value, source->value, context->value_assign_instance);
 
     if (!success) {
-      memcpy(target, backup, context->kv_layout.size);
+      memcpy(value, backup, context->value_layout.size);
     }
 
-    HLC_STACK_FREE(backup);
+    hlc_scratch_release(&scratch);
     return success;
   } else {
     return false;
@@ -142,6 +361,36 @@ static bool hlc_map_kv_reassign(void* target, const void* _source, const hlc_Ass
 }
 
 
+/// @brief Copies a key/value pair from another node, rather than from a hlc_Map_kv_ref.
+static bool hlc_map_kv_copy(void* target, const void* source, const hlc_Assign_trait* trait, void* _context) {
+  (void)trait;
+  const hlc_Map_kv_assign_context* context = _context;
+
+  assert(source != NULL);
+  assert(target != NULL);
+
+  void* target_key = (char*)target + context->key_offset;
+  const void* source_value = hlc_map_kv_value(source, context->value_offset, context->values != NULL);
+
+  const void* source_key = (const char*)source + context->key_offset;
+
+  if (hlc_assign_sized(target_key, source_key, context->key_layout.size, context->key_assign_instance)) {
+    if (hlc_map_kv_assign_value(target, source_value, context)) {
+      if (context->key_prefixes) {
+        const void* source_prefix = (const char*)source + context->prefix_offset;
+        memcpy((char*)target + context->prefix_offset, source_prefix, sizeof(unsigned long long));
+      }
+
+      return true;
+    } else {
+      hlc_destroy(target_key, context->key_destroy_instance);
+    }
+  }
+
+  return false;
+}
+
+
 bool hlc_map_insert(
   hlc_Map* map,
   const void* key,
@@ -150,6 +399,7 @@ bool hlc_map_insert(
   hlc_Assign_instance value_assign_instance
 ) {
   assert(map != NULL);
+  HLC_TRACE_RECORD(HLC_TRACE_INSERT, HLC_TRACE_MAP, map->trace_id, key, map->key_layout.size);
 
   hlc_Map_kv_ref kv_ref = {.key = key, .value = (void*)value};
 
@@ -160,11 +410,17 @@ bool hlc_map_insert(
 
   hlc_Map_kv_assign_context kv_assign_context = {
     .kv_layout = map->kv_layout,
+    .key_layout = map->key_layout,
     .key_offset = map->key_offset,
     .value_offset = map->value_offset,
     .key_assign_instance = key_assign_instance,
     .key_destroy_instance = map->key_destroy_instance,
     .value_assign_instance = value_assign_instance,
+    .values = map->values_out_of_line ? &map->values : NULL,
+    .value_layout = map->value_layout,
+    .key_prefixes = map->key_prefixes,
+    .prefix_offset = map->prefix_offset,
+    .key_prefix = hlc_map_key_prefix(map, key),
   };
 
   hlc_Assign_instance kv_assign_instance = {
@@ -172,22 +428,33 @@ bool hlc_map_insert(
     .context = &kv_assign_context,
   };
 
+  HLC_COUNT(&map->counters, insertions);
+
   if (map->root != NULL) {
     hlc_AVL* node = map->root;
 
     while (true) {
       void* node_kv = hlc_avl_element(node, map->kv_layout);
-      signed char ordering = hlc_compare(key, (char*)node_kv + map->key_offset, map->key_compare_instance);
+      signed char ordering = hlc_map_kv_compare(map, key, kv_assign_context.key_prefix, node_kv);
+      HLC_COUNT(&map->counters, insertion_comparisons);
 
-      if (ordering == 0)
+      if (ordering == 0) {
+        HLC_COUNT(&map->counters, reassigns);
         return hlc_reassign(node_kv, &kv_ref, kv_assign_instance);
+      }
 
       hlc_AVL* node_child = hlc_avl_link(node, ordering);
 
       if (node_child == NULL) {
+        hlc_AVL* parent = node;
+
+        HLC_COUNTERS_ENTER(&map->counters);
         node = hlc_avl_insert(node, ordering, &kv_ref, map->kv_layout, kv_assign_instance);
+        HLC_COUNTERS_LEAVE();
 
         if (node != NULL) {
+          hlc_map_xmost_after_insertion(map, parent, ordering);
+
           if (hlc_avl_link(node, 0) == NULL) {
             map->root = node;
           }
@@ -203,10 +470,14 @@ bool hlc_map_insert(
       node = node_child;
     }
   } else {
+    HLC_COUNTERS_ENTER(&map->counters);
     hlc_AVL* node = hlc_avl_new(&kv_ref, map->kv_layout, kv_assign_instance);
+    HLC_COUNTERS_LEAVE();
 
     if (node != NULL) {
       map->root = node;
+      map->leftmost = node;
+      map->rightmost = node;
       map->count += 1;
       return true;
     } else {
@@ -221,9 +492,21 @@ typedef struct hlc_Map_element_destroy_context {
   size_t value_offset;
   hlc_Destroy_instance key_destroy_instance;
   hlc_Destroy_instance value_destroy_instance;
+
+  /// @brief The allocator of values if they're out of line, or NULL.
+  hlc_Slab* values;
 } hlc_Map_element_destroy_context;
 
 
+/// @brief Whether destroying the key/value pairs of a map does nothing. Out of line values must still be given back to
+/// the slab, unless the whole slab is destroyed along with the pairs.
+static bool hlc_map_element_destroy_is_trivial(const hlc_Map* map, bool destroying_values) {
+  return map->key_destroy_instance.trait->trivial
+    && map->value_destroy_instance.trait->trivial
+    && (!map->values_out_of_line || destroying_values);
+}
+
+
 static void hlc_map_element_destroy(void* target, const hlc_Destroy_trait* trait, void* _context) {
   (void)trait;
   const hlc_Map_element_destroy_context* context = _context;
@@ -231,16 +514,23 @@ static void hlc_map_element_destroy(void* target, const hlc_Destroy_trait* trait
   assert(target != NULL);
   assert(context != NULL);
 
+  void* value = hlc_map_kv_value(target, context->value_offset, context->values != NULL);
   hlc_destroy((char*)target + context->key_offset, context->key_destroy_instance);
-  hlc_destroy((char*)target + context->value_offset, context->value_destroy_instance);
+  hlc_destroy(value, context->value_destroy_instance);
+
+  if (context->values != NULL) {
+    hlc_slab_free(context->values, value);
+  }
 }
 
 
 bool hlc_map_remove(hlc_Map* map, const void* key) {
   assert(map != NULL);
+  HLC_TRACE_RECORD(HLC_TRACE_REMOVE, HLC_TRACE_MAP, map->trace_id, key, map->key_layout.size);
 
   hlc_Destroy_trait element_destroy_trait = {
     .destroy = hlc_map_element_destroy,
+    .trivial = hlc_map_element_destroy_is_trivial(map, false),
   };
 
   hlc_Map_element_destroy_context element_destroy_context = {
@@ -248,6 +538,7 @@ bool hlc_map_remove(hlc_Map* map, const void* key) {
     .value_offset = map->value_offset,
     .key_destroy_instance = map->key_destroy_instance,
     .value_destroy_instance = map->value_destroy_instance,
+    .values = map->values_out_of_line ? &map->values : NULL,
   };
 
   hlc_Destroy_instance element_destroy_instance = {
@@ -255,14 +546,21 @@ bool hlc_map_remove(hlc_Map* map, const void* key) {
     .context = &element_destroy_context,
   };
 
+  HLC_COUNT(&map->counters, removals);
+  unsigned long long key_prefix = hlc_map_key_prefix(map, key);
   hlc_AVL* node = map->root;
 
   while (node != NULL) {
     void* node_kv = hlc_avl_element(node, map->kv_layout);
-    signed char ordering = hlc_compare(key, (char*)node_kv + map->key_offset, map->key_compare_instance);
+    signed char ordering = hlc_map_kv_compare(map, key, key_prefix, node_kv);
+    HLC_COUNT(&map->counters, removal_comparisons);
 
     if (ordering == 0) {
+      hlc_map_xmost_before_removal(map, node);
+
+      HLC_COUNTERS_ENTER(&map->counters);
       node = hlc_avl_remove(node, map->kv_layout, element_destroy_instance);
+      HLC_COUNTERS_LEAVE();
 
       if (node == NULL || hlc_avl_link(node, 0) == NULL) {
         map->root = node;
@@ -282,15 +580,19 @@ bool hlc_map_remove(hlc_Map* map, const void* key) {
 
 void* (hlc_map_lookup)(const hlc_Map* map, const void* key) {
   assert(map != NULL);
+  HLC_COUNT(&map->counters, lookups);
+  HLC_TRACE_RECORD(HLC_TRACE_LOOKUP, HLC_TRACE_MAP, map->trace_id, key, map->key_layout.size);
 
+  unsigned long long key_prefix = hlc_map_key_prefix(map, key);
   hlc_AVL* node = map->root;
 
   while (node != NULL) {
     void* node_kv = hlc_avl_element(node, map->kv_layout);
-    signed char ordering = hlc_compare(key, (char*)node_kv + map->key_offset, map->key_compare_instance);
+    signed char ordering = hlc_map_kv_compare(map, key, key_prefix, node_kv);
+    HLC_COUNT(&map->counters, lookup_comparisons);
 
     if (ordering == 0) {
-      return (char*)node_kv + map->value_offset;
+      return hlc_map_kv_value(node_kv, map->value_offset, map->values_out_of_line);
     } else {
       node = hlc_avl_link(node, ordering);
     }
@@ -305,20 +607,296 @@ bool hlc_map_contains(const hlc_Map* map, const void* key) {
 }
 
 
+void hlc_map_lookup_batch(const hlc_Map* map, const void* keys, size_t count, void** values) {
+  assert(map != NULL);
+  assert(count == 0 || (keys != NULL && values != NULL));
+
+  const char* key_bytes = keys;
+
+  #ifdef HLC_TRACE
+    for (size_t i = 0; i < count; ++i) {
+      const void* key = key_bytes + i * map->key_layout.size;
+      HLC_TRACE_RECORD(HLC_TRACE_LOOKUP, HLC_TRACE_MAP, map->trace_id, key, map->key_layout.size);
+    }
+  #endif
+
+  if (map->root == NULL) {
+    for (size_t i = 0; i < count; ++i) {
+      HLC_COUNT(&map->counters, lookups);
+      values[i] = NULL;
+    }
+
+    return;
+  }
+
+  // Each slot holds an ongoing search. Every pass advances each search by one node and prefetches the next one, so
+  // that by the time a slot is visited again its node is likely to be cached. Finished slots take the next key.
+
+  size_t slot_keys[HLC_MAP_BATCH];
+  unsigned long long slot_prefixes[HLC_MAP_BATCH];
+  const hlc_AVL* slot_nodes[HLC_MAP_BATCH];
+  size_t active = HLC_MIN(count, HLC_MAP_BATCH);
+  size_t next = active;
+
+  for (size_t j = 0; j < active; ++j) {
+    slot_keys[j] = j;
+    slot_prefixes[j] = hlc_map_key_prefix(map, key_bytes + j * map->key_layout.size);
+    slot_nodes[j] = map->root;
+  }
+
+  for (size_t j = active; j < HLC_MAP_BATCH; ++j) {
+    slot_nodes[j] = NULL;
+  }
+
+  while (active > 0) {
+    for (size_t j = 0; j < HLC_MAP_BATCH; ++j) {
+      const hlc_AVL* node = slot_nodes[j];
+
+      if (node == NULL)
+        continue;
+
+      size_t i = slot_keys[j];
+      const void* key = key_bytes + i * map->key_layout.size;
+      const void* node_kv = hlc_avl_element(node, map->kv_layout);
+      signed char ordering = hlc_map_kv_compare(map, key, slot_prefixes[j], node_kv);
+      HLC_COUNT(&map->counters, lookup_comparisons);
+
+      if (ordering != 0) {
+        node = hlc_avl_link(node, ordering);
+      }
+
+      if (ordering != 0 && node != NULL) {
+        HLC_PREFETCH(node);
+        HLC_PREFETCH(hlc_avl_element(node, map->kv_layout));
+      } else {
+        HLC_COUNT(&map->counters, lookups);
+        values[i] = ordering == 0 ? hlc_map_kv_value(node_kv, map->value_offset, map->values_out_of_line) : NULL;
+
+        if (next < count) {
+          slot_keys[j] = next;
+          slot_prefixes[j] = hlc_map_key_prefix(map, key_bytes + next * map->key_layout.size);
+          node = map->root;
+          next += 1;
+        } else {
+          node = NULL;
+          active -= 1;
+        }
+      }
+
+      slot_nodes[j] = node;
+    }
+  }
+}
+
+
+/// @brief Returns the key/value pair of a node, or a pair of NULLs if there's none.
+static hlc_Map_kv_ref hlc_map_node_kv_ref(const hlc_Map* map, const hlc_AVL* node) {
+  if (node == NULL)
+    return (hlc_Map_kv_ref){.key = NULL, .value = NULL};
+
+  const void* kv = hlc_avl_element(node, map->kv_layout);
+
+  return (hlc_Map_kv_ref){
+    .key = (const char*)kv + map->key_offset,
+    .value = hlc_map_kv_value(kv, map->value_offset, map->values_out_of_line),
+  };
+}
+
+
+hlc_Map_kv_ref hlc_map_min(const hlc_Map* map) {
+  assert(map != NULL);
+  return hlc_map_node_kv_ref(map, map->leftmost);
+}
+
+
+hlc_Map_kv_ref hlc_map_max(const hlc_Map* map) {
+  assert(map != NULL);
+  return hlc_map_node_kv_ref(map, map->rightmost);
+}
+
+
+/// @brief Removes the key/value pair with the minimum/maximum key, whose key and value are moved to key and value
+/// unless they're NULL.
+static bool hlc_map_pop(hlc_Map* map, signed char direction, void* key, void* value) {
+  hlc_AVL* node = direction < 0 ? map->leftmost : map->rightmost;
+
+  if (node == NULL)
+    return false;
+
+  hlc_Map_kv_ref kv_ref = hlc_map_node_kv_ref(map, node);
+  HLC_COUNT(&map->counters, removals);
+  HLC_TRACE_RECORD(HLC_TRACE_REMOVE, HLC_TRACE_MAP, map->trace_id, kv_ref.key, map->key_layout.size);
+
+  hlc_Map_element_destroy_context element_destroy_context = {
+    .key_offset = map->key_offset,
+    .value_offset = map->value_offset,
+    .key_destroy_instance = map->key_destroy_instance,
+    .value_destroy_instance = map->value_destroy_instance,
+    .values = map->values_out_of_line ? &map->values : NULL,
+  };
+
+  if (key != NULL) {
+    memcpy(key, kv_ref.key, map->key_layout.size);
+    element_destroy_context.key_destroy_instance = hlc_no_destroy_instance;
+  }
+
+  if (value != NULL) {
+    memcpy(value, kv_ref.value, map->value_layout.size);
+    element_destroy_context.value_destroy_instance = hlc_no_destroy_instance;
+  }
+
+  hlc_Destroy_trait element_destroy_trait = {
+    .destroy = hlc_map_element_destroy,
+    .trivial = element_destroy_context.key_destroy_instance.trait->trivial
+      && element_destroy_context.value_destroy_instance.trait->trivial
+      && !map->values_out_of_line,
+  };
+
+  hlc_Destroy_instance element_destroy_instance = {
+    .trait = &element_destroy_trait,
+    .context = &element_destroy_context,
+  };
+
+  hlc_map_xmost_before_removal(map, node);
+
+  HLC_COUNTERS_ENTER(&map->counters);
+  node = hlc_avl_remove(node, map->kv_layout, element_destroy_instance);
+  HLC_COUNTERS_LEAVE();
+
+  if (node == NULL || hlc_avl_link(node, 0) == NULL) {
+    map->root = node;
+  }
+
+  map->count -= 1;
+  assert(map->count == hlc_avl_count(map->root));
+  return true;
+}
+
+
+bool hlc_map_pop_min(hlc_Map* map, void* key, void* value) {
+  assert(map != NULL);
+  return hlc_map_pop(map, -1, key, value);
+}
+
+
+bool hlc_map_pop_max(hlc_Map* map, void* key, void* value) {
+  assert(map != NULL);
+  return hlc_map_pop(map, +1, key, value);
+}
+
+
+/// @brief Searches for the first/last node whose key doesn't precede/follow a key.
+/// @param direction +1 for the first node not preceding the key, -1 for the last node not following it.
+/// @return The node, or NULL if there's none.
+static hlc_AVL* hlc_map_bound(hlc_Map* map, const void* key, signed char direction) {
+  unsigned long long key_prefix = hlc_map_key_prefix(map, key);
+  hlc_AVL* node = map->root;
+  hlc_AVL* bound = NULL;
+
+  while (node != NULL) {
+    void* node_kv = hlc_avl_element(node, map->kv_layout);
+    signed char ordering = hlc_map_kv_compare(map, key, key_prefix, node_kv);
+    HLC_COUNT(&map->counters, removal_comparisons);
+
+    if (ordering == 0)
+      return node;
+
+    if (ordering == -direction) {
+      bound = node;
+    }
+
+    node = hlc_avl_link(node, ordering);
+  }
+
+  return bound;
+}
+
+
+size_t hlc_map_remove_range(hlc_Map* map, const void* lo, const void* hi) {
+  assert(map != NULL);
+  HLC_COUNT(&map->counters, removals);
+
+  hlc_AVL* first = hlc_map_bound(map, lo, +1);
+  hlc_AVL* last = hlc_map_bound(map, hi, -1);
+
+  if (first == NULL || last == NULL)
+    return 0;
+
+  if (first != last) {
+    const void* first_key = hlc_map_node_kv_ref(map, first).key;
+    const void* last_key = hlc_map_node_kv_ref(map, last).key;
+    HLC_COUNT(&map->counters, removal_comparisons);
+
+    if (hlc_compare(first_key, last_key, map->key_compare_instance) > 0)
+      return 0;
+  }
+
+  #ifdef HLC_TRACE
+    for (const hlc_AVL* node = first; node != hlc_avl_xcessor(last, +1); node = hlc_avl_xcessor(node, +1)) {
+      const void* node_key = hlc_map_node_kv_ref(map, node).key;
+      HLC_TRACE_RECORD(HLC_TRACE_REMOVE, HLC_TRACE_MAP, map->trace_id, node_key, map->key_layout.size);
+    }
+  #endif
+
+  hlc_Destroy_trait element_destroy_trait = {
+    .destroy = hlc_map_element_destroy,
+    .trivial = hlc_map_element_destroy_is_trivial(map, false),
+  };
+
+  hlc_Map_element_destroy_context element_destroy_context = {
+    .key_offset = map->key_offset,
+    .value_offset = map->value_offset,
+    .key_destroy_instance = map->key_destroy_instance,
+    .value_destroy_instance = map->value_destroy_instance,
+    .values = map->values_out_of_line ? &map->values : NULL,
+  };
+
+  hlc_Destroy_instance element_destroy_instance = {
+    .trait = &element_destroy_trait,
+    .context = &element_destroy_context,
+  };
+
+  // Nodes outside of the range stay where they are in memory, so the minimum/maximum only changes if it's removed:
+
+  if (first == map->leftmost) {
+    map->leftmost = hlc_avl_xcessor(last, +1);
+  }
+
+  if (last == map->rightmost) {
+    map->rightmost = hlc_avl_xcessor(first, -1);
+  }
+
+  size_t removed_count;
+
+  HLC_COUNTERS_ENTER(&map->counters);
+  map->root = hlc_avl_remove_range(first, last, map->kv_layout, element_destroy_instance, &removed_count);
+  HLC_COUNTERS_LEAVE();
+
+  map->count -= removed_count;
+  assert(map->count == hlc_avl_count(map->root));
+  return removed_count;
+}
+
+
 void hlc_map_clear(hlc_Map* map) {
   assert(map != NULL);
 
   hlc_map_destroy(map);
   map->root = NULL;
   map->count = 0;
+  map->leftmost = NULL;
+  map->rightmost = NULL;
+  hlc_slab_create(&map->values, map->values.slot_layout);
 }
 
 
 void hlc_map_destroy(hlc_Map* map) {
   assert(map != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_DESTROY, HLC_TRACE_MAP, map->trace_id, 0);
 
   hlc_Destroy_trait element_destroy_trait = {
     .destroy = hlc_map_element_destroy,
+    .trivial = hlc_map_element_destroy_is_trivial(map, true),
   };
 
   hlc_Map_element_destroy_context element_destroy_context = {
@@ -326,6 +904,7 @@ void hlc_map_destroy(hlc_Map* map) {
     .value_offset = map->value_offset,
     .key_destroy_instance = map->key_destroy_instance,
     .value_destroy_instance = map->value_destroy_instance,
+    .values = map->values_out_of_line ? &map->values : NULL,
   };
 
   hlc_Destroy_instance element_destroy_instance = {
@@ -333,7 +912,11 @@ void hlc_map_destroy(hlc_Map* map) {
     .context = &element_destroy_context,
   };
 
+  HLC_COUNTERS_ENTER(&map->counters);
   hlc_avl_delete(map->root, map->kv_layout, element_destroy_instance);
+  HLC_COUNTERS_LEAVE();
+
+  hlc_slab_destroy(&map->values);
 }
 
 
@@ -343,6 +926,7 @@ void hlc_map_move_reassign(hlc_Map* target, hlc_Map* source) {
 
   hlc_Destroy_trait element_destroy_trait = {
     .destroy = hlc_map_element_destroy,
+    .trivial = hlc_map_element_destroy_is_trivial(target, true),
   };
 
   hlc_Map_element_destroy_context element_destroy_context = {
@@ -350,6 +934,7 @@ void hlc_map_move_reassign(hlc_Map* target, hlc_Map* source) {
     .value_offset = target->value_offset,
     .key_destroy_instance = target->key_destroy_instance,
     .value_destroy_instance = target->value_destroy_instance,
+    .values = target->values_out_of_line ? &target->values : NULL,
   };
 
   hlc_Destroy_instance element_destroy_instance = {
@@ -357,11 +942,166 @@ void hlc_map_move_reassign(hlc_Map* target, hlc_Map* source) {
     .context = &element_destroy_context,
   };
 
+  HLC_COUNTERS_ENTER(&target->counters);
   hlc_avl_delete(target->root, target->kv_layout, element_destroy_instance);
+  HLC_COUNTERS_LEAVE();
+  hlc_slab_destroy(&target->values);
+
+  #ifdef HLC_TRACE
+    unsigned long trace_id = target->trace_id;
+  #endif
+
   *target = *source;
 
+  // Each container keeps its own identifier. The move is traced as a clone of the source into the target followed by a
+  // new, empty source, which leaves the same contents under each identifier.
+  #ifdef HLC_TRACE
+    target->trace_id = trace_id;
+  #endif
+
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CLONE, HLC_TRACE_MAP, target->trace_id, source->trace_id);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CREATE, HLC_TRACE_MAP, source->trace_id, 0);
+
   source->root = NULL;
   source->count = 0;
+  source->leftmost = NULL;
+  source->rightmost = NULL;
+  hlc_slab_create(&source->values, source->values.slot_layout);
+}
+
+
+static bool hlc_map_clone_with(
+  const hlc_Map* map,
+  hlc_Map* clone,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance,
+  hlc_Task_pool* pool
+) {
+  assert(map != NULL);
+  assert(clone != NULL);
+
+  hlc_map_create_with(
+    clone,
+    map->key_layout,
+    map->value_layout,
+    map->key_compare_instance,
+    map->key_destroy_instance,
+    map->value_destroy_instance,
+    map->values_out_of_line ? HLC_MAP_VALUES_OUT_OF_LINE : 0
+  );
+
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CLONE, HLC_TRACE_MAP, clone->trace_id, map->trace_id);
+
+  hlc_Assign_trait kv_copy_trait = {
+    .assign = hlc_map_kv_copy,
+  };
+
+  hlc_Map_kv_assign_context kv_copy_context = {
+    .kv_layout = map->kv_layout,
+    .key_layout = map->key_layout,
+    .key_offset = map->key_offset,
+    .value_offset = map->value_offset,
+    .key_assign_instance = key_assign_instance,
+    .key_destroy_instance = map->key_destroy_instance,
+    .value_assign_instance = value_assign_instance,
+    .values = clone->values_out_of_line ? &clone->values : NULL,
+    .value_layout = map->value_layout,
+    .key_prefixes = map->key_prefixes,
+    .prefix_offset = map->prefix_offset,
+  };
+
+  hlc_Assign_instance kv_copy_instance = {
+    .trait = &kv_copy_trait,
+    .context = &kv_copy_context,
+  };
+
+  hlc_Destroy_trait element_destroy_trait = {
+    .destroy = hlc_map_element_destroy,
+    .trivial = hlc_map_element_destroy_is_trivial(map, false),
+  };
+
+  hlc_Map_element_destroy_context element_destroy_context = {
+    .key_offset = map->key_offset,
+    .value_offset = map->value_offset,
+    .key_destroy_instance = map->key_destroy_instance,
+    .value_destroy_instance = map->value_destroy_instance,
+    .values = clone->values_out_of_line ? &clone->values : NULL,
+  };
+
+  hlc_Destroy_instance element_destroy_instance = {
+    .trait = &element_destroy_trait,
+    .context = &element_destroy_context,
+  };
+
+  // The slab allocator of the clone isn't thread-safe, so maps with out of line values are cloned sequentially.
+  if (clone->values_out_of_line) {
+    pool = NULL;
+  }
+
+  HLC_COUNTERS_ENTER(&clone->counters);
+
+  bool success = pool != NULL
+    ? hlc_avl_parallel_clone(map->root, &clone->root, map->kv_layout, kv_copy_instance, element_destroy_instance, pool)
+    : hlc_avl_clone(map->root, &clone->root, map->kv_layout, kv_copy_instance, element_destroy_instance);
+
+  HLC_COUNTERS_LEAVE();
+
+  if (!success)
+    return false;
+
+  clone->count = map->count;
+
+  if (clone->root != NULL) {
+    clone->leftmost = hlc_avl_xmost(clone->root, -1);
+    clone->rightmost = hlc_avl_xmost(clone->root, +1);
+  }
+
+  return true;
+}
+
+
+bool hlc_map_clone(
+  const hlc_Map* map,
+  hlc_Map* clone,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance
+) {
+  return hlc_map_clone_with(map, clone, key_assign_instance, value_assign_instance, NULL);
+}
+
+
+bool hlc_map_parallel_clone(
+  const hlc_Map* map,
+  hlc_Map* clone,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance,
+  hlc_Task_pool* pool
+) {
+  assert(pool != NULL);
+  return hlc_map_clone_with(map, clone, key_assign_instance, value_assign_instance, pool);
+}
+
+
+hlc_Counters hlc_map_counters(const hlc_Map* map) {
+  assert(map != NULL);
+
+  #ifdef HLC_COUNTERS
+    return hlc_counters_load(&map->counters);
+  #else
+    (void)map;
+    return (hlc_Counters){0};
+  #endif
+}
+
+
+void hlc_map_reset_counters(hlc_Map* map) {
+  assert(map != NULL);
+
+  #ifdef HLC_COUNTERS
+    hlc_counters_reset(&map->counters);
+  #else
+    (void)map;
+  #endif
 }
 
 
@@ -399,17 +1139,240 @@ signed char hlc_map_compare(
 }
 
 
+typedef struct hlc_Map_for_each_context {
+  size_t key_offset;
+  size_t value_offset;
+  bool values_out_of_line;
+  bool (*callback)(hlc_Map_kv_ref kv_ref, void* context);
+  void* context;
+} hlc_Map_for_each_context;
+
+
+static bool hlc_map_for_each_visit(const void* element, void* _context) {
+  const hlc_Map_for_each_context* context = _context;
+
+  assert(element != NULL);
+  assert(context != NULL);
+
+  hlc_Map_kv_ref kv_ref = {
+    .key = (const char*)element + context->key_offset,
+    .value = hlc_map_kv_value(element, context->value_offset, context->values_out_of_line),
+  };
+
+  return context->callback(kv_ref, context->context);
+}
+
+
+bool hlc_map_for_each(
+  const hlc_Map* map,
+  bool (*callback)(hlc_Map_kv_ref kv_ref, void* context),
+  void* context
+) {
+  assert(map != NULL);
+  assert(callback != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_MAP, map->trace_id, 0);
+
+  hlc_Map_for_each_context for_each_context = {
+    .key_offset = map->key_offset,
+    .value_offset = map->value_offset,
+    .values_out_of_line = map->values_out_of_line,
+    .callback = callback,
+    .context = context,
+  };
+
+  return hlc_avl_for_each(map->root, map->kv_layout, hlc_map_for_each_visit, &for_each_context);
+}
+
+
+typedef struct hlc_Map_copy_context {
+  char* array;
+  size_t count;
+  size_t offset;
+  bool indirect;
+  hlc_Layout layout;
+  hlc_Assign_instance assign_instance;
+} hlc_Map_copy_context;
+
+
+static bool hlc_map_copy(const void* element, void* _context) {
+  hlc_Map_copy_context* context = _context;
+
+  assert(element != NULL);
+  assert(context != NULL);
+
+  void* target = context->array + context->count * context->layout.size;
+
+  const void* source = hlc_map_kv_value(element, context->offset, context->indirect);
+
+  if (hlc_assign_sized(target, source, context->layout.size, context->assign_instance)) {
+    context->count += 1;
+    return true;
+  } else {
+    return false;
+  }
+}
+
+
+bool hlc_map_copy_keys(const hlc_Map* map, void* keys, hlc_Assign_instance key_assign_instance) {
+  assert(map != NULL);
+  assert(keys != NULL || map->count == 0);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_MAP, map->trace_id, 0);
+
+  hlc_Map_copy_context copy_context = {
+    .array = keys,
+    .count = 0,
+    .offset = map->key_offset,
+    .indirect = false,
+    .layout = map->key_layout,
+    .assign_instance = key_assign_instance,
+  };
+
+  if (hlc_avl_for_each(map->root, map->kv_layout, hlc_map_copy, &copy_context))
+    return true;
+
+  for (size_t i = 0; i < copy_context.count; ++i) {
+    hlc_destroy(copy_context.array + i * map->key_layout.size, map->key_destroy_instance);
+  }
+
+  return false;
+}
+
+
+bool hlc_map_copy_values(const hlc_Map* map, void* values, hlc_Assign_instance value_assign_instance) {
+  assert(map != NULL);
+  assert(values != NULL || map->count == 0);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_MAP, map->trace_id, 0);
+
+  hlc_Map_copy_context copy_context = {
+    .array = values,
+    .count = 0,
+    .offset = map->value_offset,
+    .indirect = map->values_out_of_line,
+    .layout = map->value_layout,
+    .assign_instance = value_assign_instance,
+  };
+
+  if (hlc_avl_for_each(map->root, map->kv_layout, hlc_map_copy, &copy_context))
+    return true;
+
+  for (size_t i = 0; i < copy_context.count; ++i) {
+    hlc_destroy(copy_context.array + i * map->value_layout.size, map->value_destroy_instance);
+  }
+
+  return false;
+}
+
+
+bool hlc_map_parallel_for_each(
+  const hlc_Map* map,
+  hlc_Task_pool* pool,
+  bool (*callback)(hlc_Map_kv_ref kv_ref, void* context),
+  void* context
+) {
+  assert(map != NULL);
+  assert(pool != NULL);
+  assert(callback != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_MAP, map->trace_id, 0);
+
+  hlc_Map_for_each_context for_each_context = {
+    .key_offset = map->key_offset,
+    .value_offset = map->value_offset,
+    .values_out_of_line = map->values_out_of_line,
+    .callback = callback,
+    .context = context,
+  };
+
+  return hlc_avl_parallel_for_each(map->root, map->kv_layout, pool, hlc_map_for_each_visit, &for_each_context);
+}
+
+
+typedef struct hlc_Map_kv_reduce_context {
+  size_t key_offset;
+  size_t value_offset;
+  bool values_out_of_line;
+  hlc_Reduce_instance reduce_instance;
+} hlc_Map_kv_reduce_context;
+
+
+static bool hlc_map_kv_reduce_initialize(void* accumulator, const hlc_Reduce_trait* trait, void* _context) {
+  (void)trait;
+  const hlc_Map_kv_reduce_context* context = _context;
+  return hlc_reduce_initialize(accumulator, context->reduce_instance);
+}
+
+
+static void hlc_map_kv_reduce_accumulate(
+  void* accumulator,
+  const void* element,
+  const hlc_Reduce_trait* trait,
+  void* _context
+) {
+  (void)trait;
+  const hlc_Map_kv_reduce_context* context = _context;
+
+  hlc_Map_kv_ref kv_ref = {
+    .key = (const char*)element + context->key_offset,
+    .value = hlc_map_kv_value(element, context->value_offset, context->values_out_of_line),
+  };
+
+  hlc_reduce_accumulate(accumulator, &kv_ref, context->reduce_instance);
+}
+
+
+static void hlc_map_kv_reduce_combine(void* accumulator, void* other, const hlc_Reduce_trait* trait, void* _context) {
+  (void)trait;
+  const hlc_Map_kv_reduce_context* context = _context;
+  hlc_reduce_combine(accumulator, other, context->reduce_instance);
+}
+
+
+bool hlc_map_parallel_reduce(
+  const hlc_Map* map,
+  hlc_Task_pool* pool,
+  void* accumulator,
+  hlc_Layout accumulator_layout,
+  hlc_Reduce_instance reduce_instance
+) {
+  assert(map != NULL);
+  assert(pool != NULL);
+  assert(accumulator != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_MAP, map->trace_id, 0);
+
+  hlc_Reduce_trait kv_reduce_trait = {
+    .initialize = hlc_map_kv_reduce_initialize,
+    .accumulate = hlc_map_kv_reduce_accumulate,
+    .combine = hlc_map_kv_reduce_combine,
+  };
+
+  hlc_Map_kv_reduce_context kv_reduce_context = {
+    .key_offset = map->key_offset,
+    .value_offset = map->value_offset,
+    .values_out_of_line = map->values_out_of_line,
+    .reduce_instance = reduce_instance,
+  };
+
+  hlc_Reduce_instance kv_reduce_instance = {
+    .trait = &kv_reduce_trait,
+    .context = &kv_reduce_context,
+  };
+
+  return hlc_avl_parallel_reduce(map->root, map->kv_layout, pool, accumulator, accumulator_layout, kv_reduce_instance);
+}
+
+
 void hlc_map_iterator(const hlc_Map* map, hlc_Map_iterator* iterator) {
   assert(map != NULL);
   assert(iterator != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_MAP, map->trace_id, 0);
 
-  iterator->current = map->root != NULL ? hlc_avl_xmost(map->root, -1) : NULL;
+  iterator->current = map->leftmost;
   iterator->key_layout = map->key_layout;
   iterator->value_layout = map->value_layout;
 
   iterator->kv_layout = map->kv_layout;
   iterator->key_offset = map->key_offset;
   iterator->value_offset = map->value_offset;
+  iterator->values_out_of_line = map->values_out_of_line;
 }
 
 
@@ -422,7 +1385,168 @@ hlc_Map_kv_ref hlc_map_iterator_next(hlc_Map_iterator* iterator) {
 
     return (hlc_Map_kv_ref){
       .key = (const char*)element + iterator->key_offset,
-      .value = (char*)element + iterator->value_offset,
+      .value = hlc_map_kv_value(element, iterator->value_offset, iterator->values_out_of_line),
+    };
+  } else {
+    return (hlc_Map_kv_ref){.key = NULL, .value = NULL};
+  }
+}
+
+
+bool hlc_map_freeze(
+  const hlc_Map* map,
+  hlc_Frozen_map* frozen,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance
+) {
+  assert(map != NULL);
+  assert(frozen != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_MAP, map->trace_id, 0);
+
+  hlc_Layout key_layout = map->key_layout;
+  hlc_layout_pad(&key_layout);
+
+  hlc_Layout value_layout = map->value_layout;
+  hlc_layout_pad(&value_layout);
+
+  frozen->keys = NULL;
+  frozen->values = NULL;
+  frozen->count = map->count;
+  frozen->key_layout = key_layout;
+  frozen->value_layout = value_layout;
+  frozen->key_compare_instance = map->key_compare_instance;
+  frozen->key_destroy_instance = map->key_destroy_instance;
+  frozen->value_destroy_instance = map->value_destroy_instance;
+
+  if (map->count == 0)
+    return true;
+
+  // Keys and values are stored in separate arrays, so that searches only ever touch keys. Arrays of zero-sized keys or
+  // values still take a byte, so that lookups and iterators find them at valid addresses, and NULL only means failure:
+
+  frozen->keys = malloc(HLC_MAX(map->count * key_layout.size, 1));
+  frozen->values = malloc(HLC_MAX(map->count * value_layout.size, 1));
+
+  if (frozen->keys == NULL || frozen->values == NULL) {
+    free(frozen->keys);
+    free(frozen->values);
+    frozen->keys = NULL;
+    frozen->values = NULL;
+    frozen->count = 0;
+    return false;
+  }
+
+  hlc_Map_iterator iterator;
+  hlc_map_iterator(map, &iterator);
+
+  size_t index = hlc_eytzinger_first(map->count);
+
+  while (index != 0) {
+    hlc_Map_kv_ref kv_ref = hlc_map_iterator_next(&iterator);
+    assert(kv_ref.key != NULL);
+
+    char* key = frozen->keys + (index - 1) * key_layout.size;
+    char* value = frozen->values + (index - 1) * value_layout.size;
+
+    if (!hlc_assign_sized(key, kv_ref.key, map->key_layout.size, key_assign_instance)) {
+      break;
+    } else if (!hlc_assign_sized(value, kv_ref.value, map->value_layout.size, value_assign_instance)) {
+      hlc_destroy(key, map->key_destroy_instance);
+      break;
+    }
+
+    index = hlc_eytzinger_next(index, map->count);
+  }
+
+  if (index != 0) {
+    for (size_t i = hlc_eytzinger_first(map->count); i != index; i = hlc_eytzinger_next(i, map->count)) {
+      hlc_destroy(frozen->keys + (i - 1) * key_layout.size, map->key_destroy_instance);
+      hlc_destroy(frozen->values + (i - 1) * value_layout.size, map->value_destroy_instance);
+    }
+
+    free(frozen->keys);
+    free(frozen->values);
+    frozen->keys = NULL;
+    frozen->values = NULL;
+    frozen->count = 0;
+    return false;
+  }
+
+  return true;
+}
+
+
+size_t hlc_frozen_map_count(const hlc_Frozen_map* frozen) {
+  assert(frozen != NULL);
+  return frozen->count;
+}
+
+
+void* (hlc_frozen_map_lookup)(const hlc_Frozen_map* frozen, const void* key) {
+  assert(frozen != NULL);
+
+  size_t index = hlc_eytzinger_search(
+    frozen->keys,
+    frozen->count,
+    frozen->key_layout,
+    key,
+    frozen->key_compare_instance
+  );
+
+  if (index == 0)
+    return NULL;
+
+  const void* frozen_key = frozen->keys + (index - 1) * frozen->key_layout.size;
+
+  if (hlc_compare(key, frozen_key, frozen->key_compare_instance) == 0) {
+    return frozen->values + (index - 1) * frozen->value_layout.size;
+  } else {
+    return NULL;
+  }
+}
+
+
+bool hlc_frozen_map_contains(const hlc_Frozen_map* frozen, const void* key) {
+  return hlc_frozen_map_lookup(frozen, key) != NULL;
+}
+
+
+void hlc_frozen_map_destroy(hlc_Frozen_map* frozen) {
+  assert(frozen != NULL);
+
+  for (size_t i = 0; i < frozen->count; ++i) {
+    hlc_destroy(frozen->keys + i * frozen->key_layout.size, frozen->key_destroy_instance);
+    hlc_destroy(frozen->values + i * frozen->value_layout.size, frozen->value_destroy_instance);
+  }
+
+  free(frozen->keys);
+  free(frozen->values);
+}
+
+
+void hlc_frozen_map_iterator(const hlc_Frozen_map* frozen, hlc_Frozen_map_iterator* iterator) {
+  assert(frozen != NULL);
+  assert(iterator != NULL);
+
+  iterator->keys = frozen->keys;
+  iterator->values = frozen->values;
+  iterator->count = frozen->count;
+  iterator->current = hlc_eytzinger_first(frozen->count);
+  iterator->key_size = frozen->key_layout.size;
+  iterator->value_size = frozen->value_layout.size;
+}
+
+
+hlc_Map_kv_ref hlc_frozen_map_iterator_next(hlc_Frozen_map_iterator* iterator) {
+  assert(iterator != NULL);
+
+  if (iterator->current != 0) {
+    size_t i = iterator->current - 1;
+    iterator->current = hlc_eytzinger_next(iterator->current, iterator->count);
+
+    return (hlc_Map_kv_ref){
+      .key = iterator->keys + i * iterator->key_size,
+      .value = iterator->values + i * iterator->value_size,
     };
   } else {
     return (hlc_Map_kv_ref){.key = NULL, .value = NULL};
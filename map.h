@@ -6,10 +6,13 @@
 #include <stdio.h>
 
 #include "api.h"
+#include "counters.h"
 #include "layout.h"
+#include "task.h"
 #include "traits/assign.h"
 #include "traits/compare.h"
 #include "traits/destroy.h"
+#include "traits/reduce.h"
 
 HLC_DECLARATIONS_BEGIN
 
@@ -24,12 +27,59 @@ typedef struct hlc_Map_iterator hlc_Map_iterator;
 /// @memberof hlc_Map_iterator
 extern HLC_API const hlc_Layout hlc_map_iterator_layout;
 
+/// @brief A read-only map stored contiguously in Eytzinger (breadth-first) order, with keys and values kept apart.
+typedef struct hlc_Frozen_map hlc_Frozen_map;
+
+/// @memberof hlc_Frozen_map
+extern HLC_API const hlc_Layout hlc_frozen_map_layout;
+
+/// @relates hlc_Frozen_map
+typedef struct hlc_Frozen_map_iterator hlc_Frozen_map_iterator;
+
+/// @memberof hlc_Frozen_map_iterator
+extern HLC_API const hlc_Layout hlc_frozen_map_iterator_layout;
+
 /// @relates hlc_Map_iterator
 typedef struct hlc_Map_kv_ref {
   const void* key;
   void* value;
 } hlc_Map_kv_ref;
 
+/// @relates hlc_Map
+/// @brief Options of hlc_map_create_with, which can be combined with |.
+typedef enum hlc_Map_flags {
+  /// @brief Stores each value apart from its node, which then only holds a pointer to it. Searches touch fewer cache
+  /// lines when values are large, but reaching the value of a key takes one more memory access.
+  HLC_MAP_VALUES_OUT_OF_LINE = 1,
+} hlc_Map_flags;
+
+/// @relates hlc_Map
+/// @brief Memory usage and shape of a map.
+typedef struct hlc_Map_stats {
+  /// @brief The number of key/value pairs, and thus of nodes.
+  size_t count;
+
+  /// @brief The size of a node, including its header, the key, the value (or a pointer to it) and padding.
+  size_t node_size;
+
+  /// @brief The combined size of a key and a value, without the padding between them.
+  size_t kv_size;
+
+  /// @brief The memory taken by all nodes and out of line values, not counting allocator overhead.
+  size_t total_size;
+
+  /// @brief The fraction of the memory of each key/value pair not taken by the key and value, such as node headers,
+  /// padding and pointers to out of line values.
+  double overhead;
+
+  /// @brief The height of the tree.
+  size_t height;
+
+  /// @brief The average number of nodes from the root to a node, that is, the average number of comparisons done by
+  /// a successful search.
+  double average_depth;
+} hlc_Map_stats;
+
 /// @memberof hlc_Map
 /// @brief Creates an empty map.
 /// @pre map != NULL
@@ -42,14 +92,33 @@ HLC_API void hlc_map_create(
   hlc_Destroy_instance value_destroy_instance
 );
 
+/// @memberof hlc_Map
+/// @brief Creates an empty map, with a combination of hlc_Map_flags.
+/// @pre map != NULL, and value_layout.alignment <= alignof(max_align_t) if flags has HLC_MAP_VALUES_OUT_OF_LINE
+HLC_API void hlc_map_create_with(
+  hlc_Map* map,
+  hlc_Layout key_layout,
+  hlc_Layout value_layout,
+  hlc_Compare_instance key_compare_instance,
+  hlc_Destroy_instance key_destroy_instance,
+  hlc_Destroy_instance value_destroy_instance,
+  unsigned flags
+);
+
 /// @memberof hlc_Map
 /// @brief Returns the number of elements in this map.
 /// @pre map != NULL
 HLC_API size_t hlc_map_count(const hlc_Map* map);
 
 /// @memberof hlc_Map
-/// @brief Inserts a key/value pair into this map.
-/// @return true on success, false on insufficient memory.
+/// @brief Computes memory usage and shape statistics of this map.
+/// @details Takes time proportional to the number of elements, because of average_depth.
+/// @pre map != NULL
+HLC_API hlc_Map_stats hlc_map_stats(const hlc_Map* map);
+
+/// @memberof hlc_Map
+/// @brief Inserts a key/value pair into this map, or reassigns the value if the key is already in it, keeping the key.
+/// @return true on success, false on insufficient memory, in which case this map is left unchanged.
 /// @pre map != NULL
 HLC_API bool hlc_map_insert(
   hlc_Map* map,
@@ -86,6 +155,50 @@ HLC_API void* hlc_map_lookup(const hlc_Map* map, const void* key);
 /// @pre map != NULL
 HLC_API bool hlc_map_contains(const hlc_Map* map, const void* key);
 
+/// @memberof hlc_Map
+/// @brief Looks up each of the given keys. The results match those of repeated hlc_map_lookup.
+/// @details Several searches are advanced in lockstep, so that the memory accesses of each can overlap.
+/// @param keys An array of count keys, each taking key_layout.size bytes.
+/// @param values An array of count pointers, receiving the values (or NULL for keys which aren't in this map).
+/// @pre map != NULL && (count == 0 || (keys != NULL && values != NULL))
+HLC_API void hlc_map_lookup_batch(const hlc_Map* map, const void* keys, size_t count, void** values);
+
+/// @memberof hlc_Map
+/// @brief Returns the key/value pair of this map with the minimum key, in O(1).
+/// @return Pointers to the key and value, or a pair of NULLs if this map is empty.
+/// @pre map != NULL
+HLC_API hlc_Map_kv_ref hlc_map_min(const hlc_Map* map);
+
+/// @memberof hlc_Map
+/// @brief Returns the key/value pair of this map with the maximum key, in O(1).
+/// @return Pointers to the key and value, or a pair of NULLs if this map is empty.
+/// @pre map != NULL
+HLC_API hlc_Map_kv_ref hlc_map_max(const hlc_Map* map);
+
+/// @memberof hlc_Map
+/// @brief Removes the key/value pair of this map with the minimum key, without searching for it.
+/// @param key Receives the key, which is then moved out of this map rather than destroyed, unless it's NULL.
+/// @param value Receives the value, which is then moved out of this map rather than destroyed, unless it's NULL.
+/// @return true on success, false if this map is empty.
+/// @pre map != NULL
+HLC_API bool hlc_map_pop_min(hlc_Map* map, void* key, void* value);
+
+/// @memberof hlc_Map
+/// @brief Removes the key/value pair of this map with the maximum key, without searching for it.
+/// @param key Receives the key, which is then moved out of this map rather than destroyed, unless it's NULL.
+/// @param value Receives the value, which is then moved out of this map rather than destroyed, unless it's NULL.
+/// @return true on success, false if this map is empty.
+/// @pre map != NULL
+HLC_API bool hlc_map_pop_max(hlc_Map* map, void* key, void* value);
+
+/// @memberof hlc_Map
+/// @brief Removes the keys from lo to hi, inclusive, without searching for each of them.
+/// @details Two descents find the ends of the range, which is then cut out of the tree as a whole, so that this takes
+/// O(log n + k) time to remove k keys.
+/// @return The number of removed key/value pairs, which is 0 if lo follows hi.
+/// @pre map != NULL
+HLC_API size_t hlc_map_remove_range(hlc_Map* map, const void* lo, const void* hi);
+
 /// @memberof hlc_Map
 /// @brief Clears this map.
 /// @pre map != NULL
@@ -100,6 +213,41 @@ HLC_API void hlc_map_destroy(hlc_Map* map);
 /// @pre target != NULL && source != NULL
 HLC_API void hlc_map_move_reassign(hlc_Map* target, hlc_Map* source);
 
+/// @memberof hlc_Map
+/// @brief Creates a copy of this map with the same tree shape, without any comparison or rebalancing.
+/// @return true on success, false on insufficient memory.
+/// @pre map != NULL && clone != NULL
+HLC_API bool hlc_map_clone(
+  const hlc_Map* map,
+  hlc_Map* clone,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance
+);
+
+/// @memberof hlc_Map
+/// @brief Creates a copy of this map with the same tree shape, copying sibling subtrees in parallel.
+/// @details The assign instances may be called concurrently from several threads. Maps with out of line values are
+/// copied sequentially.
+/// @return true on success, false on insufficient memory.
+/// @pre map != NULL && clone != NULL && pool != NULL
+HLC_API bool hlc_map_parallel_clone(
+  const hlc_Map* map,
+  hlc_Map* clone,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance,
+  hlc_Task_pool* pool
+);
+
+/// @memberof hlc_Map
+/// @brief Returns the operations counted for this map. All counters are zero unless HLC_COUNTERS is defined.
+/// @pre map != NULL
+HLC_API hlc_Counters hlc_map_counters(const hlc_Map* map);
+
+/// @memberof hlc_Map
+/// @brief Resets the operations counted for this map.
+/// @pre map != NULL
+HLC_API void hlc_map_reset_counters(hlc_Map* map);
+
 /// @brief hlc_Map
 /// @brief Compares two maps.
 /// @pre map1 != NULL && map2 != NULL
@@ -110,6 +258,58 @@ HLC_API signed char hlc_map_compare(
   hlc_Compare_instance value_compare_instance
 );
 
+/// @memberof hlc_Map
+/// @brief Calls the callback on each key/value pair of this map in order, until the callback returns false.
+/// @details Faster than a hlc_Map_iterator when the whole map is scanned.
+/// @return true if all key/value pairs were visited, false if the callback stopped the iteration.
+/// @pre map != NULL && callback != NULL
+HLC_API bool hlc_map_for_each(
+  const hlc_Map* map,
+  bool (*callback)(hlc_Map_kv_ref kv_ref, void* context),
+  void* context
+);
+
+/// @memberof hlc_Map
+/// @brief Copies the keys of this map, in order, to an array.
+/// @param keys An array of hlc_map_count(map) keys, each taking key_layout.size bytes.
+/// @return true on success, false on insufficient memory (in which case no key is left in the array).
+/// @pre map != NULL && (keys != NULL || hlc_map_count(map) == 0)
+HLC_API bool hlc_map_copy_keys(const hlc_Map* map, void* keys, hlc_Assign_instance key_assign_instance);
+
+/// @memberof hlc_Map
+/// @brief Copies the values of this map, in key order, to an array.
+/// @param values An array of hlc_map_count(map) values, each taking value_layout.size bytes.
+/// @return true on success, false on insufficient memory (in which case no value is left in the array).
+/// @pre map != NULL && (values != NULL || hlc_map_count(map) == 0)
+HLC_API bool hlc_map_copy_values(const hlc_Map* map, void* values, hlc_Assign_instance value_assign_instance);
+
+/// @memberof hlc_Map
+/// @brief Calls the callback on each key/value pair of this map, in parallel and in no particular order.
+/// @details The callback may be called concurrently from several threads. Once it returns false, no new calls start.
+/// @return true if all key/value pairs were visited, false if the callback stopped the iteration.
+/// @pre map != NULL && pool != NULL && callback != NULL
+HLC_API bool hlc_map_parallel_for_each(
+  const hlc_Map* map,
+  hlc_Task_pool* pool,
+  bool (*callback)(hlc_Map_kv_ref kv_ref, void* context),
+  void* context
+);
+
+/// @memberof hlc_Map
+/// @brief Reduces the key/value pairs of this map in parallel. Partial results are combined in key order, and the
+/// way the map is split doesn't depend on the number of threads.
+/// @details The elements passed to the reduce instance are pointers to hlc_Map_kv_ref.
+/// @param accumulator Uninitialized memory for an accumulator, which receives the result.
+/// @return true on success, false if the accumulator couldn't be initialized.
+/// @pre map != NULL && pool != NULL && accumulator != NULL
+HLC_API bool hlc_map_parallel_reduce(
+  const hlc_Map* map,
+  hlc_Task_pool* pool,
+  void* accumulator,
+  hlc_Layout accumulator_layout,
+  hlc_Reduce_instance reduce_instance
+);
+
 /// @memberof hlc_Map
 /// @relates hlc_Map_iterator
 /// @brief Creates an iterator for this map.
@@ -122,6 +322,61 @@ HLC_API void hlc_map_iterator(const hlc_Map* map, hlc_Map_iterator* iterator);
 /// @pre iterator != NULL
 HLC_API hlc_Map_kv_ref hlc_map_iterator_next(hlc_Map_iterator* iterator);
 
+/// @memberof hlc_Map
+/// @relates hlc_Frozen_map
+/// @brief Creates a frozen copy of this map. The map itself is left unchanged.
+/// @return true on success, false on insufficient memory.
+/// @pre map != NULL && frozen != NULL
+HLC_API bool hlc_map_freeze(
+  const hlc_Map* map,
+  hlc_Frozen_map* frozen,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance
+);
+
+/// @memberof hlc_Frozen_map
+/// @brief Returns the number of elements in this frozen map.
+/// @pre frozen != NULL
+HLC_API size_t hlc_frozen_map_count(const hlc_Frozen_map* frozen);
+
+/// @memberof hlc_Frozen_map
+/// @brief Returns the value corresponding to the given key, if any.
+/// @return The value on success, or NULL if the key wasn't in this frozen map.
+/// @pre frozen != NULL
+HLC_API void* hlc_frozen_map_lookup(const hlc_Frozen_map* frozen, const void* key);
+
+/// @memberof hlc_Frozen_map
+/// @brief Returns the value corresponding to the given key, if any.
+/// @return The value on success, or NULL if the key wasn't in this frozen map.
+/// @pre frozen != NULL
+#define hlc_frozen_map_lookup(frozen, key) _Generic(               \
+  true ? (frozen) : (void*)(frozen),                               \
+  void*: hlc_frozen_map_lookup((frozen), (key)),                   \
+  const void*: (const void*)hlc_frozen_map_lookup((frozen), (key)) \
+)
+
+/// @memberof hlc_Frozen_map
+/// @brief Checks if this frozen map contains the given key.
+/// @pre frozen != NULL
+HLC_API bool hlc_frozen_map_contains(const hlc_Frozen_map* frozen, const void* key);
+
+/// @memberof hlc_Frozen_map
+/// @brief Destroys this frozen map.
+/// @pre frozen != NULL
+HLC_API void hlc_frozen_map_destroy(hlc_Frozen_map* frozen);
+
+/// @memberof hlc_Frozen_map
+/// @relates hlc_Frozen_map_iterator
+/// @brief Creates an iterator for this frozen map.
+/// @pre frozen != NULL && iterator != NULL
+HLC_API void hlc_frozen_map_iterator(const hlc_Frozen_map* frozen, hlc_Frozen_map_iterator* iterator);
+
+/// @memberof hlc_Frozen_map_iterator
+/// @brief Returns the current key/value pair and advances the iterator.
+/// @return Pointers to the current key and value, or a pair of NULLs if the last key/value pair was reached.
+/// @pre iterator != NULL
+HLC_API hlc_Map_kv_ref hlc_frozen_map_iterator_next(hlc_Frozen_map_iterator* iterator);
+
 HLC_DECLARATIONS_END
 
 #endif
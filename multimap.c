@@ -0,0 +1,380 @@
+#include "multimap.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avl.h"
+#include "layout.h"
+#include "math.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+
+/// @brief The values of a key, allocated in a single array which grows geometrically.
+typedef struct hlc_Multimap_values {
+  char* data;
+  size_t count;
+  size_t capacity;
+} hlc_Multimap_values;
+
+
+struct hlc_Multimap {
+  hlc_AVL* root;
+  size_t count;
+  size_t key_count;
+  hlc_Layout key_layout;
+  hlc_Layout value_layout;
+  hlc_Compare_instance key_compare_instance;
+  hlc_Destroy_instance key_destroy_instance;
+  hlc_Destroy_instance value_destroy_instance;
+
+  // Nodes hold entries made of a key followed by its values. Keys come first, so that they can be compared as they are.
+  hlc_Layout entry_layout;
+  size_t values_offset;
+};
+
+const hlc_Layout hlc_multimap_layout = {.size = sizeof(hlc_Multimap), .alignment = alignof(hlc_Multimap)};
+
+
+static inline hlc_Multimap_values* hlc_multimap_entry_values(const hlc_Multimap* multimap, const hlc_AVL* node) {
+  return (hlc_Multimap_values*)((char*)hlc_avl_element(node, multimap->entry_layout) + multimap->values_offset);
+}
+
+
+/// @brief Searches for a key.
+/// @param ordering Receives 0 if the key was found, or else the side of the returned node where it would be inserted.
+/// @return The node holding the key if it was found, else the last node visited, or NULL if the multimap is empty.
+static hlc_AVL* hlc_multimap_search(const hlc_Multimap* multimap, const void* key, signed char* ordering) {
+  return hlc_avl_search(multimap->root, multimap->entry_layout, key, 0, multimap->key_compare_instance, ordering);
+}
+
+
+void hlc_multimap_create(
+  hlc_Multimap* multimap,
+  hlc_Layout key_layout,
+  hlc_Layout value_layout,
+  hlc_Compare_instance key_compare_instance,
+  hlc_Destroy_instance key_destroy_instance,
+  hlc_Destroy_instance value_destroy_instance
+) {
+  assert(multimap != NULL);
+  assert(value_layout.alignment <= alignof(max_align_t));
+
+  multimap->root = NULL;
+  multimap->count = 0;
+  multimap->key_count = 0;
+  multimap->key_layout = key_layout;
+  multimap->value_layout = value_layout;
+  multimap->key_compare_instance = key_compare_instance;
+  multimap->key_destroy_instance = key_destroy_instance;
+  multimap->value_destroy_instance = value_destroy_instance;
+
+  // Values are laid out in arrays, so their size must be a multiple of their alignment:
+  hlc_layout_pad(&multimap->value_layout);
+
+  multimap->entry_layout = key_layout;
+  multimap->values_offset = hlc_layout_add(&multimap->entry_layout, HLC_LAYOUT_OF(hlc_Multimap_values));
+  hlc_layout_pad(&multimap->entry_layout);
+}
+
+
+size_t hlc_multimap_count(const hlc_Multimap* multimap) {
+  assert(multimap != NULL);
+  return multimap->count;
+}
+
+
+size_t hlc_multimap_key_count(const hlc_Multimap* multimap) {
+  assert(multimap != NULL);
+  return multimap->key_count;
+}
+
+
+typedef struct hlc_Multimap_entry_assign_context {
+  const hlc_Multimap* multimap;
+  hlc_Assign_instance key_assign_instance;
+  hlc_Assign_instance value_assign_instance;
+
+  /// @brief The first value of the key to assign.
+  const void* value;
+} hlc_Multimap_entry_assign_context;
+
+
+/// @brief Assigns the entry of a new node, from a key with the value in the context.
+static bool hlc_multimap_entry_assign(void* target, const void* source, const hlc_Assign_trait* trait, void* _context) {
+  (void)trait;
+  const hlc_Multimap_entry_assign_context* context = _context;
+  const hlc_Multimap* multimap = context->multimap;
+
+  assert(target != NULL);
+  assert(source != NULL);
+
+  // Most keys of a multimap with few duplicates keep a single value, so arrays start with room for one.
+  size_t value_size = multimap->value_layout.size;
+  char* data = malloc(HLC_MAX(value_size, 1));
+
+  if (data == NULL)
+    return false;
+
+  if (hlc_assign_sized(target, source, multimap->key_layout.size, context->key_assign_instance)) {
+    if (hlc_assign_sized(data, context->value, value_size, context->value_assign_instance)) {
+      hlc_Multimap_values* values = (hlc_Multimap_values*)((char*)target + multimap->values_offset);
+      *values = (hlc_Multimap_values){.data = data, .count = 1, .capacity = 1};
+      return true;
+    }
+
+    hlc_destroy(target, multimap->key_destroy_instance);
+  }
+
+  free(data);
+  return false;
+}
+
+
+static const hlc_Assign_trait hlc_multimap_entry_assign_trait = {
+  .assign = hlc_multimap_entry_assign,
+};
+
+
+/// @brief Destroys an entry, in the context of its multimap.
+static void hlc_multimap_entry_destroy(void* target, const hlc_Destroy_trait* trait, void* context) {
+  (void)trait;
+  const hlc_Multimap* multimap = context;
+
+  assert(target != NULL);
+  assert(multimap != NULL);
+
+  hlc_Multimap_values* values = (hlc_Multimap_values*)((char*)target + multimap->values_offset);
+
+  if (!multimap->value_destroy_instance.trait->trivial) {
+    for (size_t i = 0; i < values->count; ++i) {
+      hlc_destroy(values->data + i * multimap->value_layout.size, multimap->value_destroy_instance);
+    }
+  }
+
+  hlc_destroy(target, multimap->key_destroy_instance);
+  free(values->data);
+}
+
+
+static const hlc_Destroy_trait hlc_multimap_entry_destroy_trait = {
+  .destroy = hlc_multimap_entry_destroy,
+};
+
+
+static inline hlc_Destroy_instance hlc_multimap_entry_destroy_instance(const hlc_Multimap* multimap) {
+  return (hlc_Destroy_instance){.trait = &hlc_multimap_entry_destroy_trait, .context = (void*)multimap};
+}
+
+
+bool hlc_multimap_insert(
+  hlc_Multimap* multimap,
+  const void* key,
+  const void* value,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance
+) {
+  assert(multimap != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_multimap_search(multimap, key, &ordering);
+  size_t value_size = multimap->value_layout.size;
+
+  if (node != NULL && ordering == 0) {
+    hlc_Multimap_values* values = hlc_multimap_entry_values(multimap, node);
+
+    if (values->count == values->capacity) {
+      size_t capacity = values->capacity * 2;
+      char* data = realloc(values->data, HLC_MAX(capacity * value_size, 1));
+
+      if (data == NULL)
+        return false;
+
+      values->data = data;
+      values->capacity = capacity;
+    }
+
+    if (!hlc_assign_sized(values->data + values->count * value_size, value, value_size, value_assign_instance))
+      return false;
+
+    values->count += 1;
+    multimap->count += 1;
+    return true;
+  }
+
+  hlc_Multimap_entry_assign_context entry_assign_context = {
+    .multimap = multimap,
+    .key_assign_instance = key_assign_instance,
+    .value_assign_instance = value_assign_instance,
+    .value = value,
+  };
+
+  hlc_Assign_instance entry_assign_instance = {
+    .trait = &hlc_multimap_entry_assign_trait,
+    .context = &entry_assign_context,
+  };
+
+  if (node != NULL) {
+    node = hlc_avl_insert(node, ordering, key, multimap->entry_layout, entry_assign_instance);
+  } else {
+    node = hlc_avl_new(key, multimap->entry_layout, entry_assign_instance);
+  }
+
+  if (node == NULL)
+    return false;
+
+  if (hlc_avl_link(node, 0) == NULL) {
+    multimap->root = node;
+  }
+
+  multimap->count += 1;
+  multimap->key_count += 1;
+  assert(multimap->key_count == hlc_avl_count(multimap->root));
+  return true;
+}
+
+
+/// @brief Removes a node along with its key and values.
+static void hlc_multimap_remove_node(hlc_Multimap* multimap, hlc_AVL* node) {
+  multimap->count -= hlc_multimap_entry_values(multimap, node)->count;
+  node = hlc_avl_remove(node, multimap->entry_layout, hlc_multimap_entry_destroy_instance(multimap));
+
+  if (node == NULL || hlc_avl_link(node, 0) == NULL) {
+    multimap->root = node;
+  }
+
+  multimap->key_count -= 1;
+  assert(multimap->key_count == hlc_avl_count(multimap->root));
+}
+
+
+size_t hlc_multimap_remove(hlc_Multimap* multimap, const void* key) {
+  assert(multimap != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_multimap_search(multimap, key, &ordering);
+
+  if (node == NULL || ordering != 0)
+    return 0;
+
+  size_t value_count = hlc_multimap_entry_values(multimap, node)->count;
+  hlc_multimap_remove_node(multimap, node);
+  return value_count;
+}
+
+
+bool hlc_multimap_remove_at(hlc_Multimap* multimap, const void* key, size_t index) {
+  assert(multimap != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_multimap_search(multimap, key, &ordering);
+
+  if (node == NULL || ordering != 0)
+    return false;
+
+  hlc_Multimap_values* values = hlc_multimap_entry_values(multimap, node);
+  assert(index < values->count);
+
+  if (values->count == 1) {
+    hlc_multimap_remove_node(multimap, node);
+    return true;
+  }
+
+  size_t value_size = multimap->value_layout.size;
+  char* value = values->data + index * value_size;
+
+  hlc_destroy(value, multimap->value_destroy_instance);
+  memmove(value, value + value_size, (values->count - index - 1) * value_size);
+  values->count -= 1;
+  multimap->count -= 1;
+  return true;
+}
+
+
+void* (hlc_multimap_lookup)(const hlc_Multimap* multimap, const void* key, size_t* value_count) {
+  assert(multimap != NULL);
+  assert(value_count != NULL);
+
+  signed char ordering;
+  const hlc_AVL* node = hlc_multimap_search(multimap, key, &ordering);
+
+  if (node == NULL || ordering != 0) {
+    *value_count = 0;
+    return NULL;
+  }
+
+  const hlc_Multimap_values* values = hlc_multimap_entry_values(multimap, node);
+  *value_count = values->count;
+  return values->data;
+}
+
+
+size_t hlc_multimap_value_count(const hlc_Multimap* multimap, const void* key) {
+  assert(multimap != NULL);
+
+  signed char ordering;
+  const hlc_AVL* node = hlc_multimap_search(multimap, key, &ordering);
+  return node != NULL && ordering == 0 ? hlc_multimap_entry_values(multimap, node)->count : 0;
+}
+
+
+bool hlc_multimap_contains(const hlc_Multimap* multimap, const void* key) {
+  assert(multimap != NULL);
+
+  signed char ordering;
+  return hlc_multimap_search(multimap, key, &ordering) != NULL && ordering == 0;
+}
+
+
+void hlc_multimap_clear(hlc_Multimap* multimap) {
+  assert(multimap != NULL);
+
+  hlc_multimap_destroy(multimap);
+  multimap->root = NULL;
+  multimap->count = 0;
+  multimap->key_count = 0;
+}
+
+
+void hlc_multimap_destroy(hlc_Multimap* multimap) {
+  assert(multimap != NULL);
+
+  hlc_avl_delete(multimap->root, multimap->entry_layout, hlc_multimap_entry_destroy_instance(multimap));
+}
+
+
+typedef struct hlc_Multimap_for_each_context {
+  size_t values_offset;
+  bool (*callback)(const void* key, void* values, size_t value_count, void* context);
+  void* context;
+} hlc_Multimap_for_each_context;
+
+
+static bool hlc_multimap_visit(const void* entry, void* _context) {
+  const hlc_Multimap_for_each_context* context = _context;
+  const hlc_Multimap_values* values = (const hlc_Multimap_values*)((const char*)entry + context->values_offset);
+  return context->callback(entry, values->data, values->count, context->context);
+}
+
+
+bool hlc_multimap_for_each(
+  const hlc_Multimap* multimap,
+  bool (*callback)(const void* key, void* values, size_t value_count, void* context),
+  void* context
+) {
+  assert(multimap != NULL);
+  assert(callback != NULL);
+
+  hlc_Multimap_for_each_context for_each_context = {
+    .values_offset = multimap->values_offset,
+    .callback = callback,
+    .context = context,
+  };
+
+  return hlc_avl_for_each(multimap->root, multimap->entry_layout, hlc_multimap_visit, &for_each_context);
+}
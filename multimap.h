@@ -0,0 +1,122 @@
+#ifndef HLC_MULTIMAP_H
+#define HLC_MULTIMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief A map which may associate several values with a key.
+/// @details Each key is stored once, in a node which holds the values of the key in an array, in insertion order.
+/// Duplicate keys thus take neither nodes nor rebalancing, and the values of a key are contiguous.
+typedef struct hlc_Multimap hlc_Multimap;
+
+/// @memberof hlc_Multimap
+extern HLC_API const hlc_Layout hlc_multimap_layout;
+
+/// @memberof hlc_Multimap
+/// @brief Creates an empty multimap.
+/// @pre multimap != NULL && value_layout.alignment <= alignof(max_align_t)
+HLC_API void hlc_multimap_create(
+  hlc_Multimap* multimap,
+  hlc_Layout key_layout,
+  hlc_Layout value_layout,
+  hlc_Compare_instance key_compare_instance,
+  hlc_Destroy_instance key_destroy_instance,
+  hlc_Destroy_instance value_destroy_instance
+);
+
+/// @memberof hlc_Multimap
+/// @brief Returns the number of values in this multimap.
+/// @pre multimap != NULL
+HLC_API size_t hlc_multimap_count(const hlc_Multimap* multimap);
+
+/// @memberof hlc_Multimap
+/// @brief Returns the number of distinct keys in this multimap, and thus of nodes.
+/// @pre multimap != NULL
+HLC_API size_t hlc_multimap_key_count(const hlc_Multimap* multimap);
+
+/// @memberof hlc_Multimap
+/// @brief Appends a value to the values of a key. The key is only copied if it wasn't in this multimap yet.
+/// @details Appending may move the other values of the key, which must thus be relocatable with memcpy.
+/// @return true on success, false on insufficient memory.
+/// @pre multimap != NULL
+HLC_API bool hlc_multimap_insert(
+  hlc_Multimap* multimap,
+  const void* key,
+  const void* value,
+  hlc_Assign_instance key_assign_instance,
+  hlc_Assign_instance value_assign_instance
+);
+
+/// @memberof hlc_Multimap
+/// @brief Removes a key and all its values from this multimap.
+/// @return The number of values which were removed, which is 0 if the key was not in this multimap.
+/// @pre multimap != NULL
+HLC_API size_t hlc_multimap_remove(hlc_Multimap* multimap, const void* key);
+
+/// @memberof hlc_Multimap
+/// @brief Removes one of the values of a key, keeping the others in order. The key is removed with its last value.
+/// @param index The index of the value in the array returned by hlc_multimap_lookup.
+/// @return true on success, false if the key was not in this multimap.
+/// @pre multimap != NULL, and index < hlc_multimap_value_count(multimap, key) if the key is in this multimap
+HLC_API bool hlc_multimap_remove_at(hlc_Multimap* multimap, const void* key, size_t index);
+
+/// @memberof hlc_Multimap
+/// @brief Returns the values of the given key, if any, which are valid until the key is next inserted or removed.
+/// @param value_count Receives the number of values, which is 0 if the key wasn't in this multimap.
+/// @return The array of values on success, or NULL if the key wasn't in this multimap.
+/// @pre multimap != NULL && value_count != NULL
+HLC_API void* hlc_multimap_lookup(const hlc_Multimap* multimap, const void* key, size_t* value_count);
+
+/// @memberof hlc_Multimap
+/// @brief Returns the values of the given key, if any, which are valid until the key is next inserted or removed.
+/// @param value_count Receives the number of values, which is 0 if the key wasn't in this multimap.
+/// @return The array of values on success, or NULL if the key wasn't in this multimap.
+/// @pre multimap != NULL && value_count != NULL
+#define hlc_multimap_lookup(multimap, key, value_count) _Generic(                 \
+  true ? (multimap) : (void*)(multimap),                                          \
+  void*: hlc_multimap_lookup((multimap), (key), (value_count)),                   \
+  const void*: (const void*)hlc_multimap_lookup((multimap), (key), (value_count)) \
+)
+
+/// @memberof hlc_Multimap
+/// @brief Returns the number of values of the given key, which is 0 if the key isn't in this multimap.
+/// @pre multimap != NULL
+HLC_API size_t hlc_multimap_value_count(const hlc_Multimap* multimap, const void* key);
+
+/// @memberof hlc_Multimap
+/// @brief Checks if this multimap contains the given key.
+/// @pre multimap != NULL
+HLC_API bool hlc_multimap_contains(const hlc_Multimap* multimap, const void* key);
+
+/// @memberof hlc_Multimap
+/// @brief Clears this multimap.
+/// @pre multimap != NULL
+HLC_API void hlc_multimap_clear(hlc_Multimap* multimap);
+
+/// @memberof hlc_Multimap
+/// @brief Destroys this multimap.
+/// @pre multimap != NULL
+HLC_API void hlc_multimap_destroy(hlc_Multimap* multimap);
+
+/// @memberof hlc_Multimap
+/// @brief Calls the callback on each key of this multimap in order, with the array of its values, until the callback
+/// returns false.
+/// @return true if all keys were visited, false if the callback stopped the iteration.
+/// @pre multimap != NULL && callback != NULL
+HLC_API bool hlc_multimap_for_each(
+  const hlc_Multimap* multimap,
+  bool (*callback)(const void* key, void* values, size_t value_count, void* context),
+  void* context
+);
+
+HLC_DECLARATIONS_END
+
+#endif
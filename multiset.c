@@ -0,0 +1,265 @@
+#include "multiset.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "avl.h"
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+
+struct hlc_Multiset {
+  hlc_AVL* root;
+  size_t count;
+  size_t distinct_count;
+  hlc_Layout element_layout;
+  hlc_Compare_instance element_compare_instance;
+  hlc_Destroy_instance element_destroy_instance;
+
+  // Nodes hold entries made of an element followed by its number of occurrences. Elements come first, so that the
+  // element destroy instance can be given entries as they are.
+  hlc_Layout entry_layout;
+  size_t multiplicity_offset;
+};
+
+const hlc_Layout hlc_multiset_layout = {.size = sizeof(hlc_Multiset), .alignment = alignof(hlc_Multiset)};
+
+
+static inline size_t* hlc_multiset_entry_multiplicity(const hlc_Multiset* multiset, const hlc_AVL* node) {
+  return (size_t*)((char*)hlc_avl_element(node, multiset->entry_layout) + multiset->multiplicity_offset);
+}
+
+
+/// @brief Searches for a key.
+/// @param ordering Receives 0 if the key was found, or else the side of the returned node where it would be inserted.
+/// @return The node holding the key if it was found, else the last node visited, or NULL if the multiset is empty.
+static hlc_AVL* hlc_multiset_search(const hlc_Multiset* multiset, const void* key, signed char* ordering) {
+  return hlc_avl_search(multiset->root, multiset->entry_layout, key, 0, multiset->element_compare_instance, ordering);
+}
+
+
+void hlc_multiset_create(
+  hlc_Multiset* multiset,
+  hlc_Layout element_layout,
+  hlc_Compare_instance element_compare_instance,
+  hlc_Destroy_instance element_destroy_instance
+) {
+  assert(multiset != NULL);
+
+  multiset->root = NULL;
+  multiset->count = 0;
+  multiset->distinct_count = 0;
+  multiset->element_layout = element_layout;
+  multiset->element_compare_instance = element_compare_instance;
+  multiset->element_destroy_instance = element_destroy_instance;
+
+  multiset->entry_layout = element_layout;
+  multiset->multiplicity_offset = hlc_layout_add(&multiset->entry_layout, HLC_LAYOUT_OF(size_t));
+  hlc_layout_pad(&multiset->entry_layout);
+}
+
+
+size_t hlc_multiset_count(const hlc_Multiset* multiset) {
+  assert(multiset != NULL);
+  return multiset->count;
+}
+
+
+size_t hlc_multiset_distinct_count(const hlc_Multiset* multiset) {
+  assert(multiset != NULL);
+  return multiset->distinct_count;
+}
+
+
+typedef struct hlc_Multiset_entry_assign_context {
+  const hlc_Multiset* multiset;
+  hlc_Assign_instance element_assign_instance;
+} hlc_Multiset_entry_assign_context;
+
+
+/// @brief Assigns the entry of a new node, from an element which occurs once.
+static bool hlc_multiset_entry_assign(void* target, const void* source, const hlc_Assign_trait* trait, void* _context) {
+  (void)trait;
+  const hlc_Multiset_entry_assign_context* context = _context;
+  const hlc_Multiset* multiset = context->multiset;
+
+  assert(target != NULL);
+  assert(source != NULL);
+
+  if (!hlc_assign_sized(target, source, multiset->element_layout.size, context->element_assign_instance))
+    return false;
+
+  *(size_t*)((char*)target + multiset->multiplicity_offset) = 1;
+  return true;
+}
+
+
+static const hlc_Assign_trait hlc_multiset_entry_assign_trait = {
+  .assign = hlc_multiset_entry_assign,
+};
+
+
+bool hlc_multiset_insert(
+  hlc_Multiset* multiset,
+  const void* element,
+  hlc_Assign_instance element_assign_instance
+) {
+  assert(multiset != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_multiset_search(multiset, element, &ordering);
+
+  if (node != NULL && ordering == 0) {
+    *hlc_multiset_entry_multiplicity(multiset, node) += 1;
+    multiset->count += 1;
+    return true;
+  }
+
+  hlc_Multiset_entry_assign_context entry_assign_context = {
+    .multiset = multiset,
+    .element_assign_instance = element_assign_instance,
+  };
+
+  hlc_Assign_instance entry_assign_instance = {
+    .trait = &hlc_multiset_entry_assign_trait,
+    .context = &entry_assign_context,
+  };
+
+  if (node != NULL) {
+    node = hlc_avl_insert(node, ordering, element, multiset->entry_layout, entry_assign_instance);
+  } else {
+    node = hlc_avl_new(element, multiset->entry_layout, entry_assign_instance);
+  }
+
+  if (node == NULL)
+    return false;
+
+  if (hlc_avl_link(node, 0) == NULL) {
+    multiset->root = node;
+  }
+
+  multiset->count += 1;
+  multiset->distinct_count += 1;
+  assert(multiset->distinct_count == hlc_avl_count(multiset->root));
+  return true;
+}
+
+
+/// @brief Removes a node and all the occurrences of its element.
+static void hlc_multiset_remove_node(hlc_Multiset* multiset, hlc_AVL* node) {
+  multiset->count -= *hlc_multiset_entry_multiplicity(multiset, node);
+  node = hlc_avl_remove(node, multiset->entry_layout, multiset->element_destroy_instance);
+
+  if (node == NULL || hlc_avl_link(node, 0) == NULL) {
+    multiset->root = node;
+  }
+
+  multiset->distinct_count -= 1;
+  assert(multiset->distinct_count == hlc_avl_count(multiset->root));
+}
+
+
+bool hlc_multiset_remove(hlc_Multiset* multiset, const void* element) {
+  assert(multiset != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_multiset_search(multiset, element, &ordering);
+
+  if (node == NULL || ordering != 0)
+    return false;
+
+  size_t* multiplicity = hlc_multiset_entry_multiplicity(multiset, node);
+
+  if (*multiplicity > 1) {
+    *multiplicity -= 1;
+    multiset->count -= 1;
+  } else {
+    hlc_multiset_remove_node(multiset, node);
+  }
+
+  return true;
+}
+
+
+size_t hlc_multiset_remove_all(hlc_Multiset* multiset, const void* element) {
+  assert(multiset != NULL);
+
+  signed char ordering;
+  hlc_AVL* node = hlc_multiset_search(multiset, element, &ordering);
+
+  if (node == NULL || ordering != 0)
+    return 0;
+
+  size_t multiplicity = *hlc_multiset_entry_multiplicity(multiset, node);
+  hlc_multiset_remove_node(multiset, node);
+  return multiplicity;
+}
+
+
+size_t hlc_multiset_multiplicity(const hlc_Multiset* multiset, const void* key) {
+  assert(multiset != NULL);
+
+  signed char ordering;
+  const hlc_AVL* node = hlc_multiset_search(multiset, key, &ordering);
+  return node != NULL && ordering == 0 ? *hlc_multiset_entry_multiplicity(multiset, node) : 0;
+}
+
+
+bool hlc_multiset_contains(const hlc_Multiset* multiset, const void* key) {
+  assert(multiset != NULL);
+
+  signed char ordering;
+  return hlc_multiset_search(multiset, key, &ordering) != NULL && ordering == 0;
+}
+
+
+void hlc_multiset_clear(hlc_Multiset* multiset) {
+  assert(multiset != NULL);
+
+  hlc_multiset_destroy(multiset);
+  multiset->root = NULL;
+  multiset->count = 0;
+  multiset->distinct_count = 0;
+}
+
+
+void hlc_multiset_destroy(hlc_Multiset* multiset) {
+  assert(multiset != NULL);
+  hlc_avl_delete(multiset->root, multiset->entry_layout, multiset->element_destroy_instance);
+}
+
+
+typedef struct hlc_Multiset_for_each_context {
+  size_t multiplicity_offset;
+  bool (*callback)(const void* element, size_t multiplicity, void* context);
+  void* context;
+} hlc_Multiset_for_each_context;
+
+
+static bool hlc_multiset_visit(const void* entry, void* _context) {
+  const hlc_Multiset_for_each_context* context = _context;
+  size_t multiplicity = *(const size_t*)((const char*)entry + context->multiplicity_offset);
+  return context->callback(entry, multiplicity, context->context);
+}
+
+
+bool hlc_multiset_for_each(
+  const hlc_Multiset* multiset,
+  bool (*callback)(const void* element, size_t multiplicity, void* context),
+  void* context
+) {
+  assert(multiset != NULL);
+  assert(callback != NULL);
+
+  hlc_Multiset_for_each_context for_each_context = {
+    .multiplicity_offset = multiset->multiplicity_offset,
+    .callback = callback,
+    .context = context,
+  };
+
+  return hlc_avl_for_each(multiset->root, multiset->entry_layout, hlc_multiset_visit, &for_each_context);
+}
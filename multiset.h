@@ -0,0 +1,98 @@
+#ifndef HLC_MULTISET_H
+#define HLC_MULTISET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief A set which may contain an element several times.
+/// @details Each distinct element is stored once, in a node which counts its occurrences, so that duplicates take
+/// neither nodes nor rebalancing.
+typedef struct hlc_Multiset hlc_Multiset;
+
+/// @memberof hlc_Multiset
+extern HLC_API const hlc_Layout hlc_multiset_layout;
+
+/// @memberof hlc_Multiset
+/// @brief Creates an empty multiset.
+/// @pre multiset != NULL
+HLC_API void hlc_multiset_create(
+  hlc_Multiset* multiset,
+  hlc_Layout element_layout,
+  hlc_Compare_instance element_compare_instance,
+  hlc_Destroy_instance element_destroy_instance
+);
+
+/// @memberof hlc_Multiset
+/// @brief Returns the number of elements in this multiset, counting each occurrence.
+/// @pre multiset != NULL
+HLC_API size_t hlc_multiset_count(const hlc_Multiset* multiset);
+
+/// @memberof hlc_Multiset
+/// @brief Returns the number of distinct elements in this multiset, and thus of nodes.
+/// @pre multiset != NULL
+HLC_API size_t hlc_multiset_distinct_count(const hlc_Multiset* multiset);
+
+/// @memberof hlc_Multiset
+/// @brief Inserts an occurrence of an element into this multiset. The element is only copied if it wasn't in it yet.
+/// @return true on success, false on insufficient memory.
+/// @pre multiset != NULL
+HLC_API bool hlc_multiset_insert(
+  hlc_Multiset* multiset,
+  const void* element,
+  hlc_Assign_instance element_assign_instance
+);
+
+/// @memberof hlc_Multiset
+/// @brief Removes an occurrence of an element from this multiset. The element is destroyed with its last occurrence.
+/// @return true on success, false if the element was not an element of this multiset.
+/// @pre multiset != NULL
+HLC_API bool hlc_multiset_remove(hlc_Multiset* multiset, const void* element);
+
+/// @memberof hlc_Multiset
+/// @brief Removes all occurrences of an element from this multiset.
+/// @return The number of occurrences which were removed.
+/// @pre multiset != NULL
+HLC_API size_t hlc_multiset_remove_all(hlc_Multiset* multiset, const void* element);
+
+/// @memberof hlc_Multiset
+/// @brief Returns the number of occurrences of the given key in this multiset.
+/// @pre multiset != NULL
+HLC_API size_t hlc_multiset_multiplicity(const hlc_Multiset* multiset, const void* key);
+
+/// @memberof hlc_Multiset
+/// @brief Checks if this multiset contains the given key.
+/// @pre multiset != NULL
+HLC_API bool hlc_multiset_contains(const hlc_Multiset* multiset, const void* key);
+
+/// @memberof hlc_Multiset
+/// @brief Clears this multiset.
+/// @pre multiset != NULL
+HLC_API void hlc_multiset_clear(hlc_Multiset* multiset);
+
+/// @memberof hlc_Multiset
+/// @brief Destroys this multiset.
+/// @pre multiset != NULL
+HLC_API void hlc_multiset_destroy(hlc_Multiset* multiset);
+
+/// @memberof hlc_Multiset
+/// @brief Calls the callback on each distinct element of this multiset in order, with its number of occurrences, until
+/// the callback returns false.
+/// @return true if all elements were visited, false if the callback stopped the iteration.
+/// @pre multiset != NULL && callback != NULL
+HLC_API bool hlc_multiset_for_each(
+  const hlc_Multiset* multiset,
+  bool (*callback)(const void* element, size_t multiplicity, void* context),
+  void* context
+);
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef HLC_PREFETCH_H
+#define HLC_PREFETCH_H
+
+#if defined(__GNUC__)
+  #define HLC_PREFETCH(address) __builtin_prefetch((address))
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+  #include <xmmintrin.h>
+
+  #define HLC_PREFETCH(address) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#else
+  #define HLC_PREFETCH(address) (void)(address)
+#endif
+
+#endif
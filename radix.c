@@ -0,0 +1,1166 @@
+#include "radix.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/destroy.h"
+
+#if defined(__SSE2__) && defined(__GNUC__)
+  #include <emmintrin.h>
+
+  #define HLC_RADIX_SSE2
+#endif
+
+
+/// @brief The number of prefix bytes stored in a node. Longer prefixes are skipped by searches, which compare the
+/// whole key with the leaf they end at, and read from a leaf below the node by updates.
+#define HLC_RADIX_PREFIX_CAPACITY 14
+
+
+typedef enum hlc_Radix_node_type {
+  HLC_RADIX_NODE4,
+  HLC_RADIX_NODE16,
+  HLC_RADIX_NODE48,
+  HLC_RADIX_NODE256,
+} hlc_Radix_node_type;
+
+
+/// @brief A key/value pair, followed by the value (at value_offset) and the bytes of the key (at key_offset).
+typedef struct hlc_Radix_leaf {
+  size_t key_size;
+} hlc_Radix_leaf;
+
+
+/// @brief The header of inner nodes.
+/// @details Children are either inner nodes or leaves, the latter being tagged by setting the lowest bit of pointers.
+/// The leaf of a node holds the key which ends right after its prefix, if any, and comes before all its children.
+/// Every node holds at least two keys, counting its leaf.
+typedef struct hlc_Radix_node {
+  hlc_Radix_leaf* leaf;
+  size_t prefix_size;
+  unsigned short count;
+  unsigned char type;
+  unsigned char prefix[HLC_RADIX_PREFIX_CAPACITY];
+} hlc_Radix_node;
+
+
+/// @brief A node with up to 4 children, sorted by byte.
+typedef struct hlc_Radix_node4 {
+  hlc_Radix_node header;
+  unsigned char bytes[4];
+  hlc_Radix_node* children[4];
+} hlc_Radix_node4;
+
+
+/// @brief A node with up to 16 children, sorted by byte.
+typedef struct hlc_Radix_node16 {
+  hlc_Radix_node header;
+  unsigned char bytes[16];
+  hlc_Radix_node* children[16];
+} hlc_Radix_node16;
+
+
+/// @brief A node with up to 48 children, in any order, whose indices plus one are given for each byte (or 0).
+typedef struct hlc_Radix_node48 {
+  hlc_Radix_node header;
+  unsigned char indices[256];
+  hlc_Radix_node* children[48];
+} hlc_Radix_node48;
+
+
+/// @brief A node with a child for each byte, which may be NULL.
+typedef struct hlc_Radix_node256 {
+  hlc_Radix_node header;
+  hlc_Radix_node* children[256];
+} hlc_Radix_node256;
+
+
+struct hlc_Radix_map {
+  hlc_Radix_node* root;
+  size_t count;
+  hlc_Layout value_layout;
+  hlc_Destroy_instance value_destroy_instance;
+
+  // Offsets in leaves:
+  size_t value_offset;
+  size_t key_offset;
+};
+
+const hlc_Layout hlc_radix_map_layout = {.size = sizeof(hlc_Radix_map), .alignment = alignof(hlc_Radix_map)};
+
+
+void hlc_radix_encode_ullong(unsigned long long x, unsigned char key[8]) {
+  assert(key != NULL);
+
+  for (size_t i = 0; i < 8; ++i) {
+    key[i] = (unsigned char)(x >> (56 - 8 * i));
+  }
+}
+
+
+void hlc_radix_encode_llong(long long x, unsigned char key[8]) {
+  assert(key != NULL);
+
+  // Flipping the sign bit orders negative integers before positive ones.
+  hlc_radix_encode_ullong((unsigned long long)x ^ 0x8000000000000000ULL, key);
+}
+
+
+static bool hlc_radix_is_leaf(const hlc_Radix_node* child) {
+  return ((uintptr_t)child & 1) != 0;
+}
+
+
+static hlc_Radix_leaf* hlc_radix_leaf(const hlc_Radix_node* child) {
+  return (hlc_Radix_leaf*)((uintptr_t)child & ~(uintptr_t)1);
+}
+
+
+static hlc_Radix_node* hlc_radix_tag(const hlc_Radix_leaf* leaf) {
+  return (hlc_Radix_node*)((uintptr_t)leaf | 1);
+}
+
+
+static unsigned char* hlc_radix_leaf_key(const hlc_Radix_map* map, const hlc_Radix_leaf* leaf) {
+  return (unsigned char*)leaf + map->key_offset;
+}
+
+
+static void* hlc_radix_leaf_value(const hlc_Radix_map* map, const hlc_Radix_leaf* leaf) {
+  return (unsigned char*)leaf + map->value_offset;
+}
+
+
+static bool hlc_radix_leaf_matches(
+  const hlc_Radix_map* map,
+  const hlc_Radix_leaf* leaf,
+  const unsigned char* key,
+  size_t key_size
+) {
+  return leaf->key_size == key_size && (key_size == 0 || memcmp(hlc_radix_leaf_key(map, leaf), key, key_size) == 0);
+}
+
+
+/// @return The new leaf on success, or NULL on insufficient memory.
+static hlc_Radix_leaf* hlc_radix_leaf_create(
+  const hlc_Radix_map* map,
+  const unsigned char* key,
+  size_t key_size,
+  const void* value,
+  hlc_Assign_instance value_assign_instance
+) {
+  hlc_Radix_leaf* leaf = malloc(map->key_offset + key_size);
+
+  if (leaf == NULL)
+    return NULL;
+
+  leaf->key_size = key_size;
+
+  if (key_size > 0) {
+    memcpy(hlc_radix_leaf_key(map, leaf), key, key_size);
+  }
+
+  if (!hlc_assign_sized(hlc_radix_leaf_value(map, leaf), value, map->value_layout.size, value_assign_instance)) {
+    free(leaf);
+    return NULL;
+  }
+
+  return leaf;
+}
+
+
+static bool hlc_radix_leaf_reassign(
+  const hlc_Radix_map* map,
+  hlc_Radix_leaf* leaf,
+  const void* value,
+  hlc_Assign_instance value_assign_instance
+) {
+  return hlc_reassign_sized(hlc_radix_leaf_value(map, leaf), value, map->value_layout.size, value_assign_instance);
+}
+
+
+static void hlc_radix_leaf_destroy(const hlc_Radix_map* map, hlc_Radix_leaf* leaf) {
+  hlc_destroy(hlc_radix_leaf_value(map, leaf), map->value_destroy_instance);
+  free(leaf);
+}
+
+
+/// @return The new node on success, or NULL on insufficient memory.
+static hlc_Radix_node* hlc_radix_node_create(hlc_Radix_node_type type) {
+  static const size_t sizes[] = {
+    [HLC_RADIX_NODE4] = sizeof(hlc_Radix_node4),
+    [HLC_RADIX_NODE16] = sizeof(hlc_Radix_node16),
+    [HLC_RADIX_NODE48] = sizeof(hlc_Radix_node48),
+    [HLC_RADIX_NODE256] = sizeof(hlc_Radix_node256),
+  };
+
+  hlc_Radix_node* node = malloc(sizes[type]);
+
+  if (node == NULL)
+    return NULL;
+
+  node->leaf = NULL;
+  node->prefix_size = 0;
+  node->count = 0;
+  node->type = (unsigned char)type;
+
+  if (type == HLC_RADIX_NODE48) {
+    hlc_Radix_node48* node48 = (hlc_Radix_node48*)node;
+    memset(node48->indices, 0, sizeof(node48->indices));
+
+    for (size_t i = 0; i < 48; ++i) {
+      node48->children[i] = NULL;
+    }
+  } else if (type == HLC_RADIX_NODE256) {
+    hlc_Radix_node256* node256 = (hlc_Radix_node256*)node;
+
+    for (size_t i = 0; i < 256; ++i) {
+      node256->children[i] = NULL;
+    }
+  }
+
+  return node;
+}
+
+
+/// @brief Returns the position of a byte in the sorted bytes of a Node16, or count if it isn't there.
+static size_t hlc_radix_node16_find(const hlc_Radix_node16* node, unsigned char byte) {
+  size_t count = node->header.count;
+
+  #ifdef HLC_RADIX_SSE2
+    // Compares the 16 bytes at once, ignoring the unused ones.
+    __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte), _mm_loadu_si128((const __m128i*)node->bytes));
+    unsigned mask = (unsigned)_mm_movemask_epi8(matches) & ((1U << count) - 1);
+    return mask != 0 ? (size_t)__builtin_ctz(mask) : count;
+  #else
+    for (size_t i = 0; i < count; ++i) {
+      if (node->bytes[i] == byte)
+        return i;
+    }
+
+    return count;
+  #endif
+}
+
+
+/// @brief Returns the child of a node for the given byte.
+/// @return A pointer to the child, or NULL if there's none.
+static hlc_Radix_node** hlc_radix_node_find(hlc_Radix_node* node, unsigned char byte) {
+  switch (node->type) {
+  case HLC_RADIX_NODE4: {
+    hlc_Radix_node4* node4 = (hlc_Radix_node4*)node;
+
+    for (size_t i = 0; i < node->count; ++i) {
+      if (node4->bytes[i] == byte)
+        return &node4->children[i];
+    }
+
+    return NULL;
+  }
+  case HLC_RADIX_NODE16: {
+    hlc_Radix_node16* node16 = (hlc_Radix_node16*)node;
+    size_t i = hlc_radix_node16_find(node16, byte);
+    return i < node->count ? &node16->children[i] : NULL;
+  }
+  case HLC_RADIX_NODE48: {
+    hlc_Radix_node48* node48 = (hlc_Radix_node48*)node;
+    unsigned char index = node48->indices[byte];
+    return index != 0 ? &node48->children[index - 1] : NULL;
+  }
+  default: {
+    hlc_Radix_node256* node256 = (hlc_Radix_node256*)node;
+    return node256->children[byte] != NULL ? &node256->children[byte] : NULL;
+  }
+  }
+}
+
+
+/// @brief Returns the first child of a node, and its byte.
+static hlc_Radix_node* hlc_radix_node_first(const hlc_Radix_node* node, unsigned char* byte) {
+  switch (node->type) {
+  case HLC_RADIX_NODE4:
+    *byte = ((const hlc_Radix_node4*)node)->bytes[0];
+    return ((const hlc_Radix_node4*)node)->children[0];
+  case HLC_RADIX_NODE16:
+    *byte = ((const hlc_Radix_node16*)node)->bytes[0];
+    return ((const hlc_Radix_node16*)node)->children[0];
+  case HLC_RADIX_NODE48: {
+    const hlc_Radix_node48* node48 = (const hlc_Radix_node48*)node;
+    size_t i = 0;
+
+    while (node48->indices[i] == 0) {
+      i += 1;
+    }
+
+    *byte = (unsigned char)i;
+    return node48->children[node48->indices[i] - 1];
+  }
+  default: {
+    const hlc_Radix_node256* node256 = (const hlc_Radix_node256*)node;
+    size_t i = 0;
+
+    while (node256->children[i] == NULL) {
+      i += 1;
+    }
+
+    *byte = (unsigned char)i;
+    return node256->children[i];
+  }
+  }
+}
+
+
+/// @brief Returns the lowest leaf below a child, whose key holds the prefixes of all the nodes on the way.
+static const hlc_Radix_leaf* hlc_radix_minimum(const hlc_Radix_node* child) {
+  while (!hlc_radix_is_leaf(child)) {
+    if (child->leaf != NULL)
+      return child->leaf;
+
+    unsigned char byte;
+    child = hlc_radix_node_first(child, &byte);
+  }
+
+  return hlc_radix_leaf(child);
+}
+
+
+/// @brief Gathers the children of a node and their bytes, in byte order.
+/// @return The number of children.
+static size_t hlc_radix_node_children(
+  const hlc_Radix_node* node,
+  unsigned char bytes[static 256],
+  hlc_Radix_node* children[static 256]
+) {
+  switch (node->type) {
+  case HLC_RADIX_NODE4:
+    memcpy(bytes, ((const hlc_Radix_node4*)node)->bytes, node->count);
+    memcpy(children, ((const hlc_Radix_node4*)node)->children, node->count * sizeof(hlc_Radix_node*));
+    return node->count;
+  case HLC_RADIX_NODE16:
+    memcpy(bytes, ((const hlc_Radix_node16*)node)->bytes, node->count);
+    memcpy(children, ((const hlc_Radix_node16*)node)->children, node->count * sizeof(hlc_Radix_node*));
+    return node->count;
+  case HLC_RADIX_NODE48: {
+    const hlc_Radix_node48* node48 = (const hlc_Radix_node48*)node;
+    size_t count = 0;
+
+    for (size_t byte = 0; byte < 256; ++byte) {
+      if (node48->indices[byte] != 0) {
+        bytes[count] = (unsigned char)byte;
+        children[count++] = node48->children[node48->indices[byte] - 1];
+      }
+    }
+
+    return count;
+  }
+  default: {
+    const hlc_Radix_node256* node256 = (const hlc_Radix_node256*)node;
+    size_t count = 0;
+
+    for (size_t byte = 0; byte < 256; ++byte) {
+      if (node256->children[byte] != NULL) {
+        bytes[count] = (unsigned char)byte;
+        children[count++] = node256->children[byte];
+      }
+    }
+
+    return count;
+  }
+  }
+}
+
+
+/// @brief Moves the header and the children of a node to a new node of another type, then frees it.
+static void hlc_radix_node_move(hlc_Radix_node* target, hlc_Radix_node* source) {
+  unsigned char bytes[256];
+  hlc_Radix_node* children[256];
+  size_t count = hlc_radix_node_children(source, bytes, children);
+
+  hlc_Radix_node_type type = target->type;
+  *target = *source;
+  target->type = (unsigned char)type;
+
+  for (size_t i = 0; i < count; ++i) {
+    switch (type) {
+    case HLC_RADIX_NODE4:
+      ((hlc_Radix_node4*)target)->bytes[i] = bytes[i];
+      ((hlc_Radix_node4*)target)->children[i] = children[i];
+      break;
+    case HLC_RADIX_NODE16:
+      ((hlc_Radix_node16*)target)->bytes[i] = bytes[i];
+      ((hlc_Radix_node16*)target)->children[i] = children[i];
+      break;
+    case HLC_RADIX_NODE48:
+      ((hlc_Radix_node48*)target)->indices[bytes[i]] = (unsigned char)(i + 1);
+      ((hlc_Radix_node48*)target)->children[i] = children[i];
+      break;
+    default:
+      ((hlc_Radix_node256*)target)->children[bytes[i]] = children[i];
+      break;
+    }
+  }
+
+  free(source);
+}
+
+
+/// @brief Adds a child to the node pointed to by the given pointer, which is updated if the node grows.
+/// @return true on success, false on insufficient memory.
+/// @pre The node has no child for the byte.
+static bool hlc_radix_node_add(hlc_Radix_node** node_pointer, unsigned char byte, hlc_Radix_node* child) {
+  hlc_Radix_node* node = *node_pointer;
+  static const unsigned short capacities[] = {
+    [HLC_RADIX_NODE4] = 4,
+    [HLC_RADIX_NODE16] = 16,
+    [HLC_RADIX_NODE48] = 48,
+    [HLC_RADIX_NODE256] = 256,
+  };
+
+  if (node->count == capacities[node->type]) {
+    hlc_Radix_node* larger = hlc_radix_node_create(node->type + 1);
+
+    if (larger == NULL)
+      return false;
+
+    hlc_radix_node_move(larger, node);
+    *node_pointer = node = larger;
+  }
+
+  switch (node->type) {
+  case HLC_RADIX_NODE4:
+  case HLC_RADIX_NODE16: {
+    unsigned char* bytes = node->type == HLC_RADIX_NODE4
+      ? ((hlc_Radix_node4*)node)->bytes
+      : ((hlc_Radix_node16*)node)->bytes;
+    hlc_Radix_node** children = node->type == HLC_RADIX_NODE4
+      ? ((hlc_Radix_node4*)node)->children
+      : ((hlc_Radix_node16*)node)->children;
+    size_t i = node->count;
+
+    while (i > 0 && bytes[i - 1] > byte) {
+      bytes[i] = bytes[i - 1];
+      children[i] = children[i - 1];
+      i -= 1;
+    }
+
+    bytes[i] = byte;
+    children[i] = child;
+    break;
+  }
+  case HLC_RADIX_NODE48: {
+    hlc_Radix_node48* node48 = (hlc_Radix_node48*)node;
+    size_t i = 0;
+
+    // Removals leave holes, so the first free slot may be anywhere.
+    while (node48->children[i] != NULL) {
+      i += 1;
+    }
+
+    node48->indices[byte] = (unsigned char)(i + 1);
+    node48->children[i] = child;
+    break;
+  }
+  default:
+    ((hlc_Radix_node256*)node)->children[byte] = child;
+    break;
+  }
+
+  node->count += 1;
+  return true;
+}
+
+
+/// @brief Removes the child of a node for the given byte.
+static void hlc_radix_node_remove(hlc_Radix_node* node, unsigned char byte, hlc_Radix_node** child) {
+  switch (node->type) {
+  case HLC_RADIX_NODE4:
+  case HLC_RADIX_NODE16: {
+    unsigned char* bytes = node->type == HLC_RADIX_NODE4
+      ? ((hlc_Radix_node4*)node)->bytes
+      : ((hlc_Radix_node16*)node)->bytes;
+    hlc_Radix_node** children = node->type == HLC_RADIX_NODE4
+      ? ((hlc_Radix_node4*)node)->children
+      : ((hlc_Radix_node16*)node)->children;
+    size_t i = (size_t)(child - children);
+
+    memmove(bytes + i, bytes + i + 1, node->count - i - 1);
+    memmove(children + i, children + i + 1, (node->count - i - 1) * sizeof(hlc_Radix_node*));
+    break;
+  }
+  case HLC_RADIX_NODE48:
+    ((hlc_Radix_node48*)node)->indices[byte] = 0;
+    *child = NULL;
+    break;
+  default:
+    *child = NULL;
+    break;
+  }
+
+  node->count -= 1;
+}
+
+
+/// @brief Restores the invariants of the node pointed to by the given pointer after a removal: nodes with a single key
+/// are replaced by it, merging prefixes, and sparse nodes shrink. Shrinking is skipped on insufficient memory.
+static void hlc_radix_node_compact(hlc_Radix_node** node_pointer) {
+  hlc_Radix_node* node = *node_pointer;
+
+  if (node->count == 0) {
+    assert(node->leaf != NULL);
+    *node_pointer = hlc_radix_tag(node->leaf);
+    free(node);
+    return;
+  }
+
+  if (node->count == 1 && node->leaf == NULL) {
+    unsigned char byte;
+    hlc_Radix_node* child = hlc_radix_node_first(node, &byte);
+
+    if (!hlc_radix_is_leaf(child)) {
+      // The child's prefix becomes the node's prefix, followed by the byte and its own prefix.
+      unsigned char prefix[HLC_RADIX_PREFIX_CAPACITY];
+      size_t size = node->prefix_size < HLC_RADIX_PREFIX_CAPACITY ? node->prefix_size : HLC_RADIX_PREFIX_CAPACITY;
+      memcpy(prefix, node->prefix, size);
+
+      if (size < HLC_RADIX_PREFIX_CAPACITY) {
+        prefix[size++] = byte;
+      }
+
+      size_t child_size = child->prefix_size < HLC_RADIX_PREFIX_CAPACITY
+        ? child->prefix_size
+        : HLC_RADIX_PREFIX_CAPACITY;
+
+      for (size_t i = 0; i < child_size && size < HLC_RADIX_PREFIX_CAPACITY; ++i) {
+        prefix[size++] = child->prefix[i];
+      }
+
+      memcpy(child->prefix, prefix, size);
+      child->prefix_size += node->prefix_size + 1;
+    }
+
+    *node_pointer = child;
+    free(node);
+    return;
+  }
+
+  hlc_Radix_node_type type;
+
+  if (node->type == HLC_RADIX_NODE16 && node->count <= 3) {
+    type = HLC_RADIX_NODE4;
+  } else if (node->type == HLC_RADIX_NODE48 && node->count <= 12) {
+    type = HLC_RADIX_NODE16;
+  } else if (node->type == HLC_RADIX_NODE256 && node->count <= 37) {
+    type = HLC_RADIX_NODE48;
+  } else {
+    return;
+  }
+
+  hlc_Radix_node* smaller = hlc_radix_node_create(type);
+
+  if (smaller != NULL) {
+    hlc_radix_node_move(smaller, node);
+    *node_pointer = smaller;
+  }
+}
+
+
+/// @brief Returns the length of the common part of a node's prefix and a key from the given depth.
+static size_t hlc_radix_prefix_mismatch(
+  const hlc_Radix_map* map,
+  const hlc_Radix_node* node,
+  const unsigned char* key,
+  size_t key_size,
+  size_t depth
+) {
+  size_t size = node->prefix_size < key_size - depth ? node->prefix_size : key_size - depth;
+  size_t stored_size = size < HLC_RADIX_PREFIX_CAPACITY ? size : HLC_RADIX_PREFIX_CAPACITY;
+  size_t i = 0;
+
+  for (; i < stored_size; ++i) {
+    if (node->prefix[i] != key[depth + i])
+      return i;
+  }
+
+  if (i < size) {
+    const unsigned char* leaf_key = hlc_radix_leaf_key(map, hlc_radix_minimum(node)) + depth;
+
+    for (; i < size; ++i) {
+      if (leaf_key[i] != key[depth + i])
+        return i;
+    }
+  }
+
+  return size;
+}
+
+
+/// @brief Splits the prefix of a node where a new key differs from it, adding a Node4 above it.
+/// @pre mismatch < node->prefix_size
+static void hlc_radix_split_prefix(
+  const hlc_Radix_map* map,
+  hlc_Radix_node** node_pointer,
+  hlc_Radix_node* parent,
+  size_t mismatch,
+  size_t depth,
+  const unsigned char* key,
+  hlc_Radix_leaf* leaf
+) {
+  hlc_Radix_node* node = *node_pointer;
+  size_t stored_size = mismatch < HLC_RADIX_PREFIX_CAPACITY ? mismatch : HLC_RADIX_PREFIX_CAPACITY;
+  unsigned char byte;
+
+  parent->prefix_size = mismatch;
+  memcpy(parent->prefix, node->prefix, stored_size);
+
+  if (node->prefix_size <= HLC_RADIX_PREFIX_CAPACITY) {
+    byte = node->prefix[mismatch];
+    node->prefix_size -= mismatch + 1;
+    memmove(node->prefix, node->prefix + mismatch + 1, node->prefix_size);
+  } else {
+    const unsigned char* leaf_key = hlc_radix_leaf_key(map, hlc_radix_minimum(node)) + depth + mismatch;
+    byte = leaf_key[0];
+    node->prefix_size -= mismatch + 1;
+    memcpy(
+      node->prefix,
+      leaf_key + 1,
+      node->prefix_size < HLC_RADIX_PREFIX_CAPACITY ? node->prefix_size : HLC_RADIX_PREFIX_CAPACITY
+    );
+  }
+
+  *node_pointer = parent;
+  hlc_radix_node_add(node_pointer, byte, node);
+
+  if (leaf->key_size == depth + mismatch) {
+    parent->leaf = leaf;
+  } else {
+    hlc_radix_node_add(node_pointer, key[depth + mismatch], hlc_radix_tag(leaf));
+  }
+}
+
+
+void hlc_radix_map_create(
+  hlc_Radix_map* map,
+  hlc_Layout value_layout,
+  hlc_Destroy_instance value_destroy_instance
+) {
+  assert(map != NULL);
+  assert(value_layout.alignment <= alignof(max_align_t));
+
+  hlc_Layout leaf_layout = HLC_LAYOUT_OF(hlc_Radix_leaf);
+  map->value_offset = hlc_layout_add(&leaf_layout, value_layout);
+  map->key_offset = leaf_layout.size;
+
+  map->root = NULL;
+  map->count = 0;
+  map->value_layout = value_layout;
+  map->value_destroy_instance = value_destroy_instance;
+}
+
+
+size_t hlc_radix_map_count(const hlc_Radix_map* map) {
+  assert(map != NULL);
+  return map->count;
+}
+
+
+bool hlc_radix_map_insert(
+  hlc_Radix_map* map,
+  const void* _key,
+  size_t key_size,
+  const void* value,
+  hlc_Assign_instance value_assign_instance
+) {
+  const unsigned char* key = _key;
+
+  assert(map != NULL);
+  assert(key != NULL || key_size == 0);
+
+  hlc_Radix_node** child_pointer = &map->root;
+  size_t depth = 0;
+
+  while (true) {
+    hlc_Radix_node* child = *child_pointer;
+
+    if (child == NULL) {
+      hlc_Radix_leaf* leaf = hlc_radix_leaf_create(map, key, key_size, value, value_assign_instance);
+
+      if (leaf == NULL)
+        return false;
+
+      *child_pointer = hlc_radix_tag(leaf);
+      break;
+    }
+
+    if (hlc_radix_is_leaf(child)) {
+      hlc_Radix_leaf* existing = hlc_radix_leaf(child);
+
+      if (hlc_radix_leaf_matches(map, existing, key, key_size))
+        return hlc_radix_leaf_reassign(map, existing, value, value_assign_instance);
+
+      // Both keys go below a new Node4, whose prefix is their common part.
+      const unsigned char* existing_key = hlc_radix_leaf_key(map, existing);
+      size_t size = existing->key_size < key_size ? existing->key_size : key_size;
+      size_t common = depth;
+
+      while (common < size && existing_key[common] == key[common]) {
+        common += 1;
+      }
+
+      hlc_Radix_leaf* leaf = hlc_radix_leaf_create(map, key, key_size, value, value_assign_instance);
+
+      if (leaf == NULL)
+        return false;
+
+      hlc_Radix_node* node = hlc_radix_node_create(HLC_RADIX_NODE4);
+
+      if (node == NULL) {
+        hlc_radix_leaf_destroy(map, leaf);
+        return false;
+      }
+
+      node->prefix_size = common - depth;
+      memcpy(
+        node->prefix,
+        key + depth,
+        node->prefix_size < HLC_RADIX_PREFIX_CAPACITY ? node->prefix_size : HLC_RADIX_PREFIX_CAPACITY
+      );
+
+      *child_pointer = node;
+
+      if (existing->key_size == common) {
+        node->leaf = existing;
+      } else {
+        hlc_radix_node_add(child_pointer, existing_key[common], child);
+      }
+
+      if (key_size == common) {
+        node->leaf = leaf;
+      } else {
+        hlc_radix_node_add(child_pointer, key[common], hlc_radix_tag(leaf));
+      }
+
+      break;
+    }
+
+    if (child->prefix_size > 0) {
+      size_t mismatch = hlc_radix_prefix_mismatch(map, child, key, key_size, depth);
+
+      if (mismatch < child->prefix_size) {
+        hlc_Radix_leaf* leaf = hlc_radix_leaf_create(map, key, key_size, value, value_assign_instance);
+
+        if (leaf == NULL)
+          return false;
+
+        hlc_Radix_node* parent = hlc_radix_node_create(HLC_RADIX_NODE4);
+
+        if (parent == NULL) {
+          hlc_radix_leaf_destroy(map, leaf);
+          return false;
+        }
+
+        hlc_radix_split_prefix(map, child_pointer, parent, mismatch, depth, key, leaf);
+        break;
+      }
+
+      depth += child->prefix_size;
+    }
+
+    if (depth == key_size) {
+      // The whole prefix was compared, so a leaf here holds the key.
+      if (child->leaf != NULL)
+        return hlc_radix_leaf_reassign(map, child->leaf, value, value_assign_instance);
+
+      hlc_Radix_leaf* leaf = hlc_radix_leaf_create(map, key, key_size, value, value_assign_instance);
+
+      if (leaf == NULL)
+        return false;
+
+      child->leaf = leaf;
+      break;
+    }
+
+    hlc_Radix_node** next = hlc_radix_node_find(child, key[depth]);
+
+    if (next == NULL) {
+      hlc_Radix_leaf* leaf = hlc_radix_leaf_create(map, key, key_size, value, value_assign_instance);
+
+      if (leaf == NULL)
+        return false;
+
+      if (!hlc_radix_node_add(child_pointer, key[depth], hlc_radix_tag(leaf))) {
+        hlc_radix_leaf_destroy(map, leaf);
+        return false;
+      }
+
+      break;
+    }
+
+    child_pointer = next;
+    depth += 1;
+  }
+
+  map->count += 1;
+  return true;
+}
+
+
+bool hlc_radix_map_remove(hlc_Radix_map* map, const void* _key, size_t key_size) {
+  const unsigned char* key = _key;
+
+  assert(map != NULL);
+  assert(key != NULL || key_size == 0);
+
+  hlc_Radix_node** child_pointer = &map->root;
+  size_t depth = 0;
+
+  while (*child_pointer != NULL) {
+    hlc_Radix_node* child = *child_pointer;
+
+    if (hlc_radix_is_leaf(child)) {
+      // Only the root is reached this way: other leaves are removed from their node below.
+      hlc_Radix_leaf* leaf = hlc_radix_leaf(child);
+
+      if (!hlc_radix_leaf_matches(map, leaf, key, key_size))
+        return false;
+
+      *child_pointer = NULL;
+      hlc_radix_leaf_destroy(map, leaf);
+      map->count -= 1;
+      return true;
+    }
+
+    if (child->prefix_size > 0) {
+      if (child->prefix_size > key_size - depth)
+        return false;
+
+      size_t size = child->prefix_size < HLC_RADIX_PREFIX_CAPACITY ? child->prefix_size : HLC_RADIX_PREFIX_CAPACITY;
+
+      if (memcmp(child->prefix, key + depth, size) != 0)
+        return false;
+
+      depth += child->prefix_size;
+    }
+
+    if (depth == key_size) {
+      hlc_Radix_leaf* leaf = child->leaf;
+
+      if (leaf == NULL || !hlc_radix_leaf_matches(map, leaf, key, key_size))
+        return false;
+
+      child->leaf = NULL;
+      hlc_radix_leaf_destroy(map, leaf);
+      hlc_radix_node_compact(child_pointer);
+      map->count -= 1;
+      return true;
+    }
+
+    hlc_Radix_node** next = hlc_radix_node_find(child, key[depth]);
+
+    if (next == NULL)
+      return false;
+
+    if (hlc_radix_is_leaf(*next)) {
+      hlc_Radix_leaf* leaf = hlc_radix_leaf(*next);
+
+      if (!hlc_radix_leaf_matches(map, leaf, key, key_size))
+        return false;
+
+      hlc_radix_node_remove(child, key[depth], next);
+      hlc_radix_leaf_destroy(map, leaf);
+      hlc_radix_node_compact(child_pointer);
+      map->count -= 1;
+      return true;
+    }
+
+    child_pointer = next;
+    depth += 1;
+  }
+
+  return false;
+}
+
+
+void* (hlc_radix_map_lookup)(const hlc_Radix_map* map, const void* _key, size_t key_size) {
+  const unsigned char* key = _key;
+
+  assert(map != NULL);
+  assert(key != NULL || key_size == 0);
+
+  hlc_Radix_node* child = map->root;
+  size_t depth = 0;
+
+  // Prefix bytes beyond the stored ones are skipped, since the leaf is compared with the whole key.
+  while (child != NULL && !hlc_radix_is_leaf(child)) {
+    if (child->prefix_size > 0) {
+      if (child->prefix_size > key_size - depth)
+        return NULL;
+
+      size_t size = child->prefix_size < HLC_RADIX_PREFIX_CAPACITY ? child->prefix_size : HLC_RADIX_PREFIX_CAPACITY;
+
+      if (memcmp(child->prefix, key + depth, size) != 0)
+        return NULL;
+
+      depth += child->prefix_size;
+    }
+
+    if (depth == key_size) {
+      child = child->leaf != NULL ? hlc_radix_tag(child->leaf) : NULL;
+      break;
+    }
+
+    hlc_Radix_node** next = hlc_radix_node_find(child, key[depth]);
+    child = next != NULL ? *next : NULL;
+    depth += 1;
+  }
+
+  if (child == NULL)
+    return NULL;
+
+  hlc_Radix_leaf* leaf = hlc_radix_leaf(child);
+  return hlc_radix_leaf_matches(map, leaf, key, key_size) ? hlc_radix_leaf_value(map, leaf) : NULL;
+}
+
+
+bool hlc_radix_map_contains(const hlc_Radix_map* map, const void* key, size_t key_size) {
+  return hlc_radix_map_lookup(map, key, key_size) != NULL;
+}
+
+
+/// @brief Destroys the keys and nodes below a child, without recursion so that deep maps fit the stack. Inner nodes
+/// waiting for their children to be destroyed are chained through their leaf pointer, once their leaf is destroyed.
+static void hlc_radix_destroy(const hlc_Radix_map* map, hlc_Radix_node* child) {
+  hlc_Radix_node* pending = NULL;
+  unsigned char bytes[256];
+  hlc_Radix_node* children[256] = {child};
+  size_t count = 1;
+
+  while (true) {
+    for (size_t i = 0; i < count; ++i) {
+      child = children[i];
+
+      if (hlc_radix_is_leaf(child)) {
+        hlc_radix_leaf_destroy(map, hlc_radix_leaf(child));
+        continue;
+      }
+
+      if (child->leaf != NULL) {
+        hlc_radix_leaf_destroy(map, child->leaf);
+      }
+
+      child->leaf = (hlc_Radix_leaf*)pending;
+      pending = child;
+    }
+
+    if (pending == NULL)
+      return;
+
+    hlc_Radix_node* node = pending;
+    pending = (hlc_Radix_node*)node->leaf;
+    count = hlc_radix_node_children(node, bytes, children);
+    free(node);
+  }
+}
+
+
+void hlc_radix_map_clear(hlc_Radix_map* map) {
+  assert(map != NULL);
+
+  if (map->root != NULL) {
+    hlc_radix_destroy(map, map->root);
+  }
+
+  map->root = NULL;
+  map->count = 0;
+}
+
+
+void hlc_radix_map_destroy(hlc_Radix_map* map) {
+  hlc_radix_map_clear(map);
+}
+
+
+typedef struct hlc_Radix_visit_context {
+  const hlc_Radix_map* map;
+  bool (*callback)(hlc_Radix_map_kv_ref kv_ref, void* context);
+  void* context;
+} hlc_Radix_visit_context;
+
+
+static bool hlc_radix_visit_leaf(const hlc_Radix_visit_context* context, const hlc_Radix_leaf* leaf) {
+  hlc_Radix_map_kv_ref kv_ref = {
+    .key = hlc_radix_leaf_key(context->map, leaf),
+    .key_size = leaf->key_size,
+    .value = hlc_radix_leaf_value(context->map, leaf),
+  };
+
+  return context->callback(kv_ref, context->context);
+}
+
+
+/// @brief Returns the next child of a node in byte order, from a position which starts at 0 and is moved past it.
+/// @return The child, or NULL if there are no more.
+static const hlc_Radix_node* hlc_radix_node_next(const hlc_Radix_node* node, size_t* position) {
+  switch (node->type) {
+  case HLC_RADIX_NODE4:
+  case HLC_RADIX_NODE16: {
+    hlc_Radix_node* const* children = node->type == HLC_RADIX_NODE4
+      ? ((const hlc_Radix_node4*)node)->children
+      : ((const hlc_Radix_node16*)node)->children;
+
+    return *position < node->count ? children[(*position)++] : NULL;
+  }
+  case HLC_RADIX_NODE48: {
+    const hlc_Radix_node48* node48 = (const hlc_Radix_node48*)node;
+
+    while (*position < 256) {
+      unsigned char index = node48->indices[(*position)++];
+
+      if (index != 0)
+        return node48->children[index - 1];
+    }
+
+    return NULL;
+  }
+  default: {
+    const hlc_Radix_node256* node256 = (const hlc_Radix_node256*)node;
+
+    while (*position < 256) {
+      const hlc_Radix_node* child = node256->children[(*position)++];
+
+      if (child != NULL)
+        return child;
+    }
+
+    return NULL;
+  }
+  }
+}
+
+
+/// @brief An inner node being visited, and the position of its next child.
+typedef struct hlc_Radix_visit_frame {
+  const hlc_Radix_node* node;
+  size_t position;
+} hlc_Radix_visit_frame;
+
+
+/// @brief The number of frames hlc_radix_visit keeps on the stack, before moving them to the heap.
+#define HLC_RADIX_VISIT_FRAMES 32
+
+
+/// @brief Visits the keys below a child in order: the leaf of a node comes first, then its children by byte.
+/// @details The inner nodes on the way are kept in frames rather than on the call stack, so that deep maps fit it.
+/// @return false if the callback stopped the iteration, or if the frames of a deep map ran out of memory.
+static bool hlc_radix_visit(const hlc_Radix_visit_context* context, const hlc_Radix_node* child) {
+  hlc_Radix_visit_frame small_frames[HLC_RADIX_VISIT_FRAMES];
+  hlc_Radix_visit_frame* frames = small_frames;
+  size_t capacity = HLC_RADIX_VISIT_FRAMES;
+  size_t depth = 0;
+  bool visited = true;
+
+  while (child != NULL) {
+    if (hlc_radix_is_leaf(child)) {
+      visited = hlc_radix_visit_leaf(context, hlc_radix_leaf(child));
+    } else if (child->leaf == NULL || (visited = hlc_radix_visit_leaf(context, child->leaf))) {
+      if (depth == capacity) {
+        hlc_Radix_visit_frame* new_frames = frames == small_frames
+          ? malloc(2 * capacity * sizeof(hlc_Radix_visit_frame))
+          : realloc(frames, 2 * capacity * sizeof(hlc_Radix_visit_frame));
+
+        if (new_frames == NULL) {
+          visited = false;
+          break;
+        }
+
+        if (frames == small_frames) {
+          memcpy(new_frames, small_frames, sizeof(small_frames));
+        }
+
+        frames = new_frames;
+        capacity *= 2;
+      }
+
+      frames[depth++] = (hlc_Radix_visit_frame){.node = child, .position = 0};
+    }
+
+    if (!visited)
+      break;
+
+    child = NULL;
+
+    while (depth > 0 && (child = hlc_radix_node_next(frames[depth - 1].node, &frames[depth - 1].position)) == NULL) {
+      depth -= 1;
+    }
+  }
+
+  if (frames != small_frames) {
+    free(frames);
+  }
+
+  return visited;
+}
+
+
+bool hlc_radix_map_for_each(
+  const hlc_Radix_map* map,
+  bool (*callback)(hlc_Radix_map_kv_ref kv_ref, void* context),
+  void* context
+) {
+  return hlc_radix_map_for_each_prefix(map, NULL, 0, callback, context);
+}
+
+
+bool hlc_radix_map_for_each_prefix(
+  const hlc_Radix_map* map,
+  const void* _prefix,
+  size_t prefix_size,
+  bool (*callback)(hlc_Radix_map_kv_ref kv_ref, void* context),
+  void* context
+) {
+  const unsigned char* prefix = _prefix;
+
+  assert(map != NULL);
+  assert(prefix != NULL || prefix_size == 0);
+  assert(callback != NULL);
+
+  hlc_Radix_visit_context visit_context = {.map = map, .callback = callback, .context = context};
+  const hlc_Radix_node* child = map->root;
+  size_t depth = 0;
+
+  // Finds the first child whose keys all start with the prefix.
+  while (child != NULL && depth < prefix_size) {
+    if (hlc_radix_is_leaf(child)) {
+      const hlc_Radix_leaf* leaf = hlc_radix_leaf(child);
+
+      if (leaf->key_size < prefix_size || memcmp(hlc_radix_leaf_key(map, leaf), prefix, prefix_size) != 0)
+        return true;
+
+      break;
+    }
+
+    if (child->prefix_size > 0) {
+      size_t size = child->prefix_size < prefix_size - depth ? child->prefix_size : prefix_size - depth;
+
+      if (hlc_radix_prefix_mismatch(map, child, prefix, prefix_size, depth) < size)
+        return true;
+
+      depth += child->prefix_size;
+
+      if (depth >= prefix_size)
+        break;
+    }
+
+    hlc_Radix_node* const* next = hlc_radix_node_find((hlc_Radix_node*)child, prefix[depth]);
+    child = next != NULL ? *next : NULL;
+    depth += 1;
+  }
+
+  return child == NULL || hlc_radix_visit(&visit_context, child);
+}
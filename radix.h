@@ -0,0 +1,133 @@
+#ifndef HLC_RADIX_H
+#define HLC_RADIX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+#include "traits/assign.h"
+#include "traits/destroy.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief A map from byte strings to values, stored in an adaptive radix tree (V. Leis, A. Kemper and T. Neumann, "The
+/// adaptive radix tree: ARTful indexing for main-memory databases", 2013).
+/// @details Inner nodes branch on one byte of the keys, and take 4, 16, 48 or 256 children depending on how many they
+/// have. Chains of nodes with a single child are compressed into a prefix of their child. Searches thus take time
+/// proportional to the length of the key, regardless of the number of keys, and never call a comparison function.
+/// Keys are ordered like memcmp, a key which is a prefix of another one being lower. Other types of keys must be
+/// encoded into bytes which compare in the same order, such as with hlc_radix_encode_ullong.
+typedef struct hlc_Radix_map hlc_Radix_map;
+
+/// @memberof hlc_Radix_map
+extern HLC_API const hlc_Layout hlc_radix_map_layout;
+
+/// @relates hlc_Radix_map
+typedef struct hlc_Radix_map_kv_ref {
+  const void* key;
+  size_t key_size;
+  void* value;
+} hlc_Radix_map_kv_ref;
+
+/// @relates hlc_Radix_map
+/// @brief Encodes an unsigned integer into 8 bytes which compare like the integer (in big endian order).
+/// @pre key != NULL
+HLC_API void hlc_radix_encode_ullong(unsigned long long x, unsigned char key[8]);
+
+/// @relates hlc_Radix_map
+/// @brief Encodes a signed integer into 8 bytes which compare like the integer.
+/// @pre key != NULL
+HLC_API void hlc_radix_encode_llong(long long x, unsigned char key[8]);
+
+/// @memberof hlc_Radix_map
+/// @brief Creates an empty radix map.
+/// @pre map != NULL && value_layout.alignment <= alignof(max_align_t)
+HLC_API void hlc_radix_map_create(
+  hlc_Radix_map* map,
+  hlc_Layout value_layout,
+  hlc_Destroy_instance value_destroy_instance
+);
+
+/// @memberof hlc_Radix_map
+/// @brief Returns the number of keys in this radix map.
+/// @pre map != NULL
+HLC_API size_t hlc_radix_map_count(const hlc_Radix_map* map);
+
+/// @memberof hlc_Radix_map
+/// @brief Inserts a key/value pair into this radix map, or reassigns the value if the key is already in it.
+/// @return true on success, false on insufficient memory.
+/// @pre map != NULL && (key != NULL || key_size == 0)
+HLC_API bool hlc_radix_map_insert(
+  hlc_Radix_map* map,
+  const void* key,
+  size_t key_size,
+  const void* value,
+  hlc_Assign_instance value_assign_instance
+);
+
+/// @memberof hlc_Radix_map
+/// @brief Removes a key from this radix map.
+/// @return true on success, false if the key was not in this radix map.
+/// @pre map != NULL && (key != NULL || key_size == 0)
+HLC_API bool hlc_radix_map_remove(hlc_Radix_map* map, const void* key, size_t key_size);
+
+/// @memberof hlc_Radix_map
+/// @brief Returns the value corresponding to the given key, if any.
+/// @return The value on success, or NULL if the key wasn't in this radix map.
+/// @pre map != NULL && (key != NULL || key_size == 0)
+HLC_API void* hlc_radix_map_lookup(const hlc_Radix_map* map, const void* key, size_t key_size);
+
+/// @memberof hlc_Radix_map
+/// @brief Returns the value corresponding to the given key, if any.
+/// @return The value on success, or NULL if the key wasn't in this radix map.
+/// @pre map != NULL && (key != NULL || key_size == 0)
+#define hlc_radix_map_lookup(map, key, key_size) _Generic(                 \
+  true ? (map) : (void*)(map),                                             \
+  void*: hlc_radix_map_lookup((map), (key), (key_size)),                   \
+  const void*: (const void*)hlc_radix_map_lookup((map), (key), (key_size)) \
+)
+
+/// @memberof hlc_Radix_map
+/// @brief Checks if this radix map contains the given key.
+/// @pre map != NULL && (key != NULL || key_size == 0)
+HLC_API bool hlc_radix_map_contains(const hlc_Radix_map* map, const void* key, size_t key_size);
+
+/// @memberof hlc_Radix_map
+/// @brief Clears this radix map.
+/// @pre map != NULL
+HLC_API void hlc_radix_map_clear(hlc_Radix_map* map);
+
+/// @memberof hlc_Radix_map
+/// @brief Destroys this radix map.
+/// @pre map != NULL
+HLC_API void hlc_radix_map_destroy(hlc_Radix_map* map);
+
+/// @memberof hlc_Radix_map
+/// @brief Calls the callback on each key/value pair of this radix map in key order, until the callback returns false.
+/// @return true if all key/value pairs were visited, false if the callback stopped the iteration or on insufficient
+/// memory, which visits of maps with very long keys need to track the nodes on the way.
+/// @pre map != NULL && callback != NULL
+HLC_API bool hlc_radix_map_for_each(
+  const hlc_Radix_map* map,
+  bool (*callback)(hlc_Radix_map_kv_ref kv_ref, void* context),
+  void* context
+);
+
+/// @memberof hlc_Radix_map
+/// @brief Calls the callback on each key/value pair whose key starts with the given prefix, in key order, until the
+/// callback returns false. Only the subtree of the prefix is visited.
+/// @return true if all matching key/value pairs were visited, false if the callback stopped the iteration or on
+/// insufficient memory, as for hlc_radix_map_for_each.
+/// @pre map != NULL && (prefix != NULL || prefix_size == 0) && callback != NULL
+HLC_API bool hlc_radix_map_for_each_prefix(
+  const hlc_Radix_map* map,
+  const void* prefix,
+  size_t prefix_size,
+  bool (*callback)(hlc_Radix_map_kv_ref kv_ref, void* context),
+  void* context
+);
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -1,4 +1,7 @@
-// hlc_Random implements MT19937 (http://www.math.sci.hiroshima-u.ac.jp/m-mat/MT/ARTICLES/mt.pdf).
+// hlc_Random implements several engines behind a single interface:
+// - MT19937 and MT19937-64 (http://www.math.sci.hiroshima-u.ac.jp/m-mat/MT/ARTICLES/mt.pdf),
+// - xoshiro256** (https://prng.di.unimi.it/),
+// - PCG64, that is PCG XSL RR 128/64 (https://www.pcg-random.org/pdf/hmc-cs-2014-0905.pdf).
 
 #include "random.h"
 
@@ -6,7 +9,11 @@
 #include <limits.h>
 #include <math.h>
 #include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
 
 #include "layout.h"
@@ -24,7 +31,8 @@
 #define HLC_RANDOM_C 0xEFC60000
 #define HLC_RANDOM_L 18
 
-static_assert(HLC_RANDOM_W >= 2 && HLC_RANDOM_W <= 32, "HLC_RANDOM_W >= 2 && HLC_RANDOM_W <= 32");
+// Bounded draws consume whole 32-bit outputs.
+static_assert(HLC_RANDOM_W == 32, "HLC_RANDOM_W == 32");
 static_assert(HLC_RANDOM_N >= 1, "HLC_RANDOM_N >= 1");
 static_assert(HLC_RANDOM_M >= 1 && HLC_RANDOM_M <= HLC_RANDOM_N, "HLC_RANDOM_M >= 1 && HLC_RANDOM_M <= HLC_RANDOM_N");
 static_assert(HLC_RANDOM_R >= 0 && HLC_RANDOM_R < HLC_RANDOM_W, "HLC_RANDOM_R >= 0 && HLC_RANDOM_R < HLC_RANDOM_W");
@@ -36,90 +44,638 @@ static_assert(HLC_RANDOM_L >= 0, "HLC_RANDOM_L >= 0");
 #define HLC_RANDOM_HI ((unsigned long)((~0ULL << HLC_RANDOM_R) & ~(~0ULL << HLC_RANDOM_W)))
 #define HLC_RANDOM_LO ((unsigned long)(~(~0ULL << HLC_RANDOM_R) & ~(~0ULL << HLC_RANDOM_W)))
 
+#define HLC_RANDOM_64_N 312
+#define HLC_RANDOM_64_M 156
+#define HLC_RANDOM_64_A 0xB5026F5AA96619E9ULL
+#define HLC_RANDOM_64_HI 0xFFFFFFFF80000000ULL
+#define HLC_RANDOM_64_LO 0x000000007FFFFFFFULL
 
-struct hlc_Random {
-  unsigned long x[HLC_RANDOM_N];
+#define HLC_RANDOM_PCG_MULTIPLIER_HI 0x2360ED051FC65DA4ULL
+#define HLC_RANDOM_PCG_MULTIPLIER_LO 0x4385DF649FCCF645ULL
+
+static_assert(ULLONG_MAX == 0xFFFFFFFFFFFFFFFFULL, "unsigned long long is 64 bits wide");
+
+
+/// @brief The number of generators created by hlc_random_create so far, which tells apart those created at once.
+static atomic_ullong hlc_random_created;
+
+
+// MT19937 regenerates its state HLC_RANDOM_N words at a time, then tempers it into a buffer which outputs are served
+// from. Both passes are free of modulos and branches, so that compilers can vectorize them. MT19937-64 does the same.
+
+typedef struct hlc_Random_mt19937 {
+  uint_least32_t x[HLC_RANDOM_N];
+  uint_least32_t y[HLC_RANDOM_N];
   size_t i;
+} hlc_Random_mt19937;
+
+typedef struct hlc_Random_mt19937_64 {
+  uint64_t x[HLC_RANDOM_64_N];
+  uint64_t y[HLC_RANDOM_64_N];
+  size_t i;
+} hlc_Random_mt19937_64;
+
+typedef struct hlc_Random_xoshiro256 {
+  uint64_t s[4];
+} hlc_Random_xoshiro256;
+
+typedef struct hlc_Random_pcg64 {
+  uint64_t state_hi;
+  uint64_t state_lo;
+  uint64_t increment_hi;
+  uint64_t increment_lo;
+} hlc_Random_pcg64;
+
+
+// Generators may be allocated with the smaller layout of their engine, so the state must remain the last member.
+
+struct hlc_Random {
+  hlc_Random_engine engine;
+
+  union {
+    hlc_Random_mt19937 mt19937;
+    hlc_Random_mt19937_64 mt19937_64;
+    hlc_Random_xoshiro256 xoshiro256;
+    hlc_Random_pcg64 pcg64;
+  } state;
 };
 
 const hlc_Layout hlc_random_layout = {.size = sizeof(hlc_Random), .alignment = alignof(hlc_Random)};
 
 
-void hlc_random_create(hlc_Random* random) {
-  time_t t = time(NULL);
+/// @brief Zipf's law, prepared for rejection-inversion (W. Hörmann and G. Derflinger, "Rejection-inversion to generate
+/// variates from monotone discrete distributions", 1996). Ranks k in [1, count] have the density h(k) = k^-exponent,
+/// and draws invert the integral H of h, from which they're rejected with a small probability only.
+struct hlc_Random_zipf {
+  double exponent;
+  double count;
+  double h_integral_x1;
+  double h_integral_count;
+  double s;
+};
+
+
+const hlc_Layout hlc_random_zipf_layout = {
+  .size = sizeof(hlc_Random_zipf),
+  .alignment = alignof(hlc_Random_zipf),
+};
+
+
+hlc_Layout hlc_random_engine_layout(hlc_Random_engine engine) {
+  size_t state_size = 0;
+
+  switch (engine) {
+    case HLC_RANDOM_MT19937:
+      state_size = sizeof(hlc_Random_mt19937);
+      break;
+    case HLC_RANDOM_MT19937_64:
+      state_size = sizeof(hlc_Random_mt19937_64);
+      break;
+    case HLC_RANDOM_XOSHIRO256:
+      state_size = sizeof(hlc_Random_xoshiro256);
+      break;
+    case HLC_RANDOM_PCG64:
+      state_size = sizeof(hlc_Random_pcg64);
+      break;
+  }
+
+  assert(state_size != 0);
+
+  hlc_Layout layout = {.size = offsetof(hlc_Random, state) + state_size, .alignment = alignof(hlc_Random)};
+  hlc_layout_pad(&layout);
+  return layout;
+}
+
+
+/// @brief Produces the next output of splitmix64, which expands seeds into the states of the 64-bit engines.
+static uint64_t hlc_random_splitmix64(uint64_t* x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 hlc_Random_u128;
+#endif
+
+
+/// @brief Multiplies two 64-bit integers into a 128-bit product.
+/// @return The low 64 bits of the product. The high ones are stored in *hi.
+static inline uint64_t hlc_random_multiply(uint64_t x, uint64_t y, uint64_t* hi) {
+  #ifdef __SIZEOF_INT128__
+    hlc_Random_u128 product = (hlc_Random_u128)x * y;
+    *hi = (uint64_t)(product >> 64);
+    return (uint64_t)product;
+  #else
+    uint64_t x_lo = x & 0xFFFFFFFF, x_hi = x >> 32;
+    uint64_t y_lo = y & 0xFFFFFFFF, y_hi = y >> 32;
+    uint64_t lo_lo = x_lo * y_lo;
+    uint64_t hi_lo = x_hi * y_lo;
+    uint64_t lo_hi = x_lo * y_hi;
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    *hi = x_hi * y_hi + (hi_lo >> 32) + (cross >> 32);
+    return (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  #endif
+}
+
+
+static void hlc_random_mt19937_create(hlc_Random_mt19937* mt, unsigned long seed) {
+  mt->x[0] = (uint_least32_t)(seed & ~(~0ULL << HLC_RANDOM_W));
 
-  if (t != (time_t)-1) {
-    double diff = t >= 0 ? difftime(t, 0) : difftime(0, t);
+  for (size_t i = 1; i < HLC_RANDOM_N; ++i) {
+    unsigned long x = mt->x[i - 1];
+    x = (unsigned long)((size_t)1812433253 * (x ^ (x >> (HLC_RANDOM_W - 2))) + i);
+    mt->x[i] = (uint_least32_t)(x & ~(~0ULL << HLC_RANDOM_W));
+  }
 
-    if (isfinite(diff)) {
-      assert(diff >= 0);
-      hlc_random_create_with(random, (unsigned long)fmod(diff, pow(2.0, CHAR_BIT * sizeof(unsigned long))));
-      return;
+  mt->i = HLC_RANDOM_N;
+}
+
+
+/// @brief Initializes the state from an array of 32-bit words, following init_by_array of the reference implementation.
+static void hlc_random_mt19937_create_by_array(hlc_Random_mt19937* mt, const uint32_t* key, size_t length) {
+  assert(length >= 1);
+
+  uint_least32_t* x = mt->x;
+  hlc_random_mt19937_create(mt, 19650218);
+
+  size_t i = 1;
+  size_t j = 0;
+
+  for (size_t k = HLC_RANDOM_N > length ? HLC_RANDOM_N : length; k > 0; --k) {
+    x[i] = (uint_least32_t)(((x[i] ^ ((x[i - 1] ^ (x[i - 1] >> 30)) * 1664525UL)) + key[j] + j) & 0xFFFFFFFF);
+    i += 1;
+    j += 1;
+
+    if (i >= HLC_RANDOM_N) {
+      x[0] = x[HLC_RANDOM_N - 1];
+      i = 1;
+    }
+
+    if (j >= length) {
+      j = 0;
+    }
+  }
+
+  for (size_t k = HLC_RANDOM_N - 1; k > 0; --k) {
+    x[i] = (uint_least32_t)(((x[i] ^ ((x[i - 1] ^ (x[i - 1] >> 30)) * 1566083941UL)) - i) & 0xFFFFFFFF);
+    i += 1;
+
+    if (i >= HLC_RANDOM_N) {
+      x[0] = x[HLC_RANDOM_N - 1];
+      i = 1;
     }
   }
 
-  hlc_random_create_with(random, 0);
+  x[0] = 0x80000000;
+}
+
+
+/// @brief Combines the high bits of one state word with the low bits of the next one, and multiplies by the matrix A.
+static inline uint_least32_t hlc_random_mt19937_twist(uint_least32_t x, uint_least32_t next) {
+  uint_least32_t y = (uint_least32_t)((x & HLC_RANDOM_HI) | (next & HLC_RANDOM_LO));
+  return (uint_least32_t)((y >> 1) ^ (-(unsigned long)(y & 1) & HLC_RANDOM_A));
+}
+
+
+/// @brief Regenerates the whole state, and tempers it into the output buffer.
+static void hlc_random_mt19937_generate(hlc_Random_mt19937* mt) {
+  uint_least32_t* x = mt->x;
+  size_t k = 0;
+
+  // Split the state where the indices wrap around, instead of reducing every index modulo HLC_RANDOM_N.
+
+  for (; k < HLC_RANDOM_N - HLC_RANDOM_M; ++k) {
+    x[k] = x[k + HLC_RANDOM_M] ^ hlc_random_mt19937_twist(x[k], x[k + 1]);
+  }
+
+  for (; k < HLC_RANDOM_N - 1; ++k) {
+    x[k] = x[k + HLC_RANDOM_M - HLC_RANDOM_N] ^ hlc_random_mt19937_twist(x[k], x[k + 1]);
+  }
+
+  x[HLC_RANDOM_N - 1] = x[HLC_RANDOM_M - 1] ^ hlc_random_mt19937_twist(x[HLC_RANDOM_N - 1], x[0]);
+
+  for (k = 0; k < HLC_RANDOM_N; ++k) {
+    uint_least32_t y = x[k];
+    y ^= y >> HLC_RANDOM_U;
+    y ^= (y << HLC_RANDOM_S) & HLC_RANDOM_B;
+    y ^= (y << HLC_RANDOM_T) & HLC_RANDOM_C;
+    y ^= y >> HLC_RANDOM_L;
+    mt->y[k] = y;
+  }
+
+  mt->i = 0;
+}
+
+
+static inline uint32_t hlc_random_mt19937_next(hlc_Random_mt19937* mt) {
+  if (mt->i == HLC_RANDOM_N) {
+    hlc_random_mt19937_generate(mt);
+  }
+
+  return (uint32_t)mt->y[mt->i++];
+}
+
+
+static void hlc_random_mt19937_64_create(hlc_Random_mt19937_64* mt, uint64_t seed) {
+  mt->x[0] = seed;
+
+  for (size_t i = 1; i < HLC_RANDOM_64_N; ++i) {
+    mt->x[i] = 6364136223846793005ULL * (mt->x[i - 1] ^ (mt->x[i - 1] >> 62)) + i;
+  }
+
+  mt->i = HLC_RANDOM_64_N;
+}
+
+
+static inline uint64_t hlc_random_mt19937_64_twist(uint64_t x, uint64_t next) {
+  uint64_t y = (x & HLC_RANDOM_64_HI) | (next & HLC_RANDOM_64_LO);
+  return (y >> 1) ^ (-(y & 1) & HLC_RANDOM_64_A);
+}
+
+
+static void hlc_random_mt19937_64_generate(hlc_Random_mt19937_64* mt) {
+  uint64_t* x = mt->x;
+  size_t k = 0;
+
+  for (; k < HLC_RANDOM_64_N - HLC_RANDOM_64_M; ++k) {
+    x[k] = x[k + HLC_RANDOM_64_M] ^ hlc_random_mt19937_64_twist(x[k], x[k + 1]);
+  }
+
+  for (; k < HLC_RANDOM_64_N - 1; ++k) {
+    x[k] = x[k + HLC_RANDOM_64_M - HLC_RANDOM_64_N] ^ hlc_random_mt19937_64_twist(x[k], x[k + 1]);
+  }
+
+  x[HLC_RANDOM_64_N - 1] = x[HLC_RANDOM_64_M - 1] ^ hlc_random_mt19937_64_twist(x[HLC_RANDOM_64_N - 1], x[0]);
+
+  for (k = 0; k < HLC_RANDOM_64_N; ++k) {
+    uint64_t y = x[k];
+    y ^= (y >> 29) & 0x5555555555555555ULL;
+    y ^= (y << 17) & 0x71D67FFFEDA60000ULL;
+    y ^= (y << 37) & 0xFFF7EEE000000000ULL;
+    y ^= y >> 43;
+    mt->y[k] = y;
+  }
+
+  mt->i = 0;
+}
+
+
+static inline uint64_t hlc_random_mt19937_64_next(hlc_Random_mt19937_64* mt) {
+  if (mt->i == HLC_RANDOM_64_N) {
+    hlc_random_mt19937_64_generate(mt);
+  }
+
+  return mt->y[mt->i++];
+}
+
+
+static void hlc_random_xoshiro256_create(hlc_Random_xoshiro256* xoshiro, uint64_t seed) {
+  // splitmix64 never produces four zero words in a row, which is the one state xoshiro256** can't leave.
+  for (size_t i = 0; i < 4; ++i) {
+    xoshiro->s[i] = hlc_random_splitmix64(&seed);
+  }
+}
+
+
+static inline uint64_t hlc_random_rotate(uint64_t x, unsigned k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+
+static inline uint64_t hlc_random_xoshiro256_next(hlc_Random_xoshiro256* xoshiro) {
+  uint64_t* s = xoshiro->s;
+  uint64_t result = hlc_random_rotate(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = hlc_random_rotate(s[3], 45);
+
+  return result;
+}
+
+
+/// @brief Advances the state by 2^192 outputs, using the long jump polynomial of the reference implementation.
+static void hlc_random_xoshiro256_jump(hlc_Random_xoshiro256* xoshiro) {
+  static const uint64_t polynomial[4] = {
+    0x76E15D3EFEFDCBBFULL,
+    0xC5004E441C522FB3ULL,
+    0x77710069854EE241ULL,
+    0x39109BB02ACBE635ULL,
+  };
+
+  uint64_t s[4] = {0, 0, 0, 0};
+
+  for (size_t i = 0; i < 4; ++i) {
+    for (unsigned b = 0; b < 64; ++b) {
+      if ((polynomial[i] >> b) & 1) {
+        s[0] ^= xoshiro->s[0];
+        s[1] ^= xoshiro->s[1];
+        s[2] ^= xoshiro->s[2];
+        s[3] ^= xoshiro->s[3];
+      }
+
+      hlc_random_xoshiro256_next(xoshiro);
+    }
+  }
+
+  for (size_t i = 0; i < 4; ++i) {
+    xoshiro->s[i] = s[i];
+  }
+}
+
+
+/// @brief Multiplies the 128-bit integer (*hi, *lo) by (y_hi, y_lo), modulo 2^128.
+static inline void hlc_random_multiply128(uint64_t* hi, uint64_t* lo, uint64_t y_hi, uint64_t y_lo) {
+  uint64_t product_hi;
+  uint64_t product_lo = hlc_random_multiply(*lo, y_lo, &product_hi);
+  *hi = product_hi + *lo * y_hi + *hi * y_lo;
+  *lo = product_lo;
+}
+
+
+/// @brief Adds (y_hi, y_lo) to the 128-bit integer (*hi, *lo), modulo 2^128.
+static inline void hlc_random_add128(uint64_t* hi, uint64_t* lo, uint64_t y_hi, uint64_t y_lo) {
+  *lo += y_lo;
+  *hi += y_hi + (*lo < y_lo);
+}
+
+
+/// @brief Advances the 128-bit linear congruential state of PCG64 by one step.
+static inline void hlc_random_pcg64_step(hlc_Random_pcg64* pcg) {
+  hlc_random_multiply128(&pcg->state_hi, &pcg->state_lo, HLC_RANDOM_PCG_MULTIPLIER_HI, HLC_RANDOM_PCG_MULTIPLIER_LO);
+  hlc_random_add128(&pcg->state_hi, &pcg->state_lo, pcg->increment_hi, pcg->increment_lo);
+}
+
+
+/// @brief Advances the state by 2^64 steps in O(log) time (F. Brown, "Random number generation with arbitrary
+/// strides", 1994): the affine maps of 2^k steps are squared repeatedly, and composed into the state.
+static void hlc_random_pcg64_jump(hlc_Random_pcg64* pcg) {
+  uint64_t multiplier_hi = HLC_RANDOM_PCG_MULTIPLIER_HI;
+  uint64_t multiplier_lo = HLC_RANDOM_PCG_MULTIPLIER_LO;
+  uint64_t increment_hi = pcg->increment_hi;
+  uint64_t increment_lo = pcg->increment_lo;
+
+  // After k iterations, x -> multiplier * x + increment advances the state by 2^k steps.
+  for (unsigned k = 0; k < 64; ++k) {
+    uint64_t factor_hi = multiplier_hi;
+    uint64_t factor_lo = multiplier_lo;
+    hlc_random_add128(&factor_hi, &factor_lo, 0, 1);
+    hlc_random_multiply128(&increment_hi, &increment_lo, factor_hi, factor_lo);
+    hlc_random_multiply128(&multiplier_hi, &multiplier_lo, multiplier_hi, multiplier_lo);
+  }
+
+  hlc_random_multiply128(&pcg->state_hi, &pcg->state_lo, multiplier_hi, multiplier_lo);
+  hlc_random_add128(&pcg->state_hi, &pcg->state_lo, increment_hi, increment_lo);
+}
+
+
+static void hlc_random_pcg64_create(hlc_Random_pcg64* pcg, uint64_t seed) {
+  // Follow pcg64_srandom_r, with the initial state and the stream selector expanded from the seed.
+  uint64_t state_hi = hlc_random_splitmix64(&seed);
+  uint64_t state_lo = hlc_random_splitmix64(&seed);
+  uint64_t stream_hi = hlc_random_splitmix64(&seed);
+  uint64_t stream_lo = hlc_random_splitmix64(&seed);
+
+  pcg->state_hi = 0;
+  pcg->state_lo = 0;
+  pcg->increment_hi = (stream_hi << 1) | (stream_lo >> 63);
+  pcg->increment_lo = (stream_lo << 1) | 1;
+
+  hlc_random_pcg64_step(pcg);
+
+  hlc_random_add128(&pcg->state_hi, &pcg->state_lo, state_hi, state_lo);
+
+  hlc_random_pcg64_step(pcg);
+}
+
+
+static inline uint64_t hlc_random_pcg64_next(hlc_Random_pcg64* pcg) {
+  hlc_random_pcg64_step(pcg);
+
+  // XSL RR: fold the state in half, then rotate by its top 6 bits.
+  uint64_t folded = pcg->state_hi ^ pcg->state_lo;
+  unsigned rotation = (unsigned)(pcg->state_hi >> 58);
+  return (folded >> rotation) | (folded << ((64 - rotation) & 63));
+}
+
+
+/// @brief Produces 64 random bits.
+static inline uint64_t hlc_random_next64(hlc_Random* random) {
+  assert(random != NULL);
+
+  switch (random->engine) {
+    case HLC_RANDOM_MT19937: {
+      uint64_t hi = hlc_random_mt19937_next(&random->state.mt19937);
+      return (hi << 32) | hlc_random_mt19937_next(&random->state.mt19937);
+    }
+    case HLC_RANDOM_MT19937_64:
+      return hlc_random_mt19937_64_next(&random->state.mt19937_64);
+    case HLC_RANDOM_XOSHIRO256:
+      return hlc_random_xoshiro256_next(&random->state.xoshiro256);
+    case HLC_RANDOM_PCG64:
+      return hlc_random_pcg64_next(&random->state.pcg64);
+  }
+
+  assert(false);
+  return 0;
+}
+
+
+/// @brief Produces 32 random bits. The 64-bit engines provide their high bits, which are the strongest ones.
+static inline uint32_t hlc_random_next32(hlc_Random* random) {
+  assert(random != NULL);
+
+  if (random->engine == HLC_RANDOM_MT19937) {
+    return hlc_random_mt19937_next(&random->state.mt19937);
+  } else {
+    return (uint32_t)(hlc_random_next64(random) >> 32);
+  }
+}
+
+
+void hlc_random_create(hlc_Random* random) {
+  assert(random != NULL);
+
+  // Generators created within the resolution of the clock, possibly by different threads, would share the same seed.
+  // Mixing in the number of generators created so far, and the address of this one, tells them apart.
+
+  uint64_t x = atomic_fetch_add_explicit(&hlc_random_created, 1, memory_order_relaxed);
+  uint64_t seed = hlc_random_splitmix64(&x);
+  struct timespec t;
+
+  if (timespec_get(&t, TIME_UTC) == TIME_UTC) {
+    x ^= (uint64_t)t.tv_sec;
+    seed ^= hlc_random_splitmix64(&x);
+    x ^= (uint64_t)t.tv_nsec;
+    seed ^= hlc_random_splitmix64(&x);
+  } else {
+    x ^= (uint64_t)time(NULL);
+    seed ^= hlc_random_splitmix64(&x);
+  }
+
+  x ^= (uint64_t)(uintptr_t)random;
+  seed ^= hlc_random_splitmix64(&x);
+
+  hlc_random_create_with_engine(random, HLC_RANDOM_MT19937, seed);
 }
 
 
 void hlc_random_create_with(hlc_Random* random, unsigned long seed) {
+  hlc_random_create_with_engine(random, HLC_RANDOM_MT19937, seed);
+}
+
+
+void hlc_random_create_with_engine(hlc_Random* random, hlc_Random_engine engine, unsigned long long seed) {
   assert(random != NULL);
 
-  random->x[0] = seed;
-  random->x[0] &= (unsigned long)~(~0ULL << HLC_RANDOM_W);
+  random->engine = engine;
 
-  for (size_t i = 1; i < HLC_RANDOM_N; ++i) {
-    random->x[i] = ((size_t)1812433253 * (random->x[i - 1] ^ (random->x[i - 1] >> (HLC_RANDOM_W - 2))) + i);
-    random->x[i] &= (unsigned long)~(~0ULL << HLC_RANDOM_W);
+  switch (engine) {
+    case HLC_RANDOM_MT19937:
+      // Seeds of 32 bits keep the sequences of hlc_random_create_with, while wider ones use all their bits.
+      if (seed <= 0xFFFFFFFFULL) {
+        hlc_random_mt19937_create(&random->state.mt19937, (unsigned long)seed);
+      } else {
+        uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+        hlc_random_mt19937_create_by_array(&random->state.mt19937, key, 2);
+      }
+
+      break;
+    case HLC_RANDOM_MT19937_64:
+      hlc_random_mt19937_64_create(&random->state.mt19937_64, seed);
+      break;
+    case HLC_RANDOM_XOSHIRO256:
+      hlc_random_xoshiro256_create(&random->state.xoshiro256, seed);
+      break;
+    case HLC_RANDOM_PCG64:
+      hlc_random_pcg64_create(&random->state.pcg64, seed);
+      break;
   }
+}
 
-  random->i = 0;
+
+hlc_Random_engine hlc_random_engine(const hlc_Random* random) {
+  assert(random != NULL);
+  return random->engine;
+}
+
+
+bool hlc_random_jump(hlc_Random* random) {
+  assert(random != NULL);
+
+  switch (random->engine) {
+    case HLC_RANDOM_XOSHIRO256:
+      hlc_random_xoshiro256_jump(&random->state.xoshiro256);
+      return true;
+    case HLC_RANDOM_PCG64:
+      hlc_random_pcg64_jump(&random->state.pcg64);
+      return true;
+    default:
+      return false;
+  }
 }
 
 
-/// @brief Produces a random number of HLC_RANDOM_W bits.
-static unsigned long hlc_random_next(hlc_Random* random) {
+void hlc_random_split(hlc_Random* random, hlc_Random* const* children, size_t count) {
   assert(random != NULL);
+  assert(children != NULL || count == 0);
+
+  for (size_t i = 0; i < count; ++i) {
+    hlc_Random* child = children[i];
+    assert(child != NULL && child != random);
+
+    child->engine = random->engine;
 
-  unsigned long y = (random->x[random->i] & HLC_RANDOM_HI) | (random->x[(random->i + 1) % HLC_RANDOM_N] & HLC_RANDOM_LO);
-  y = random->x[(random->i + HLC_RANDOM_M) % HLC_RANDOM_N] ^ (y >> 1) ^ ((y & 1) != 0 ? HLC_RANDOM_A : 0);
-
-  random->x[random->i] = y;
-  random->i = (random->i + 1) % HLC_RANDOM_N;
-
-  y ^= y >> HLC_RANDOM_U;
-  y ^= (y << HLC_RANDOM_S) & HLC_RANDOM_B;
-  y ^= (y << HLC_RANDOM_T) & HLC_RANDOM_C;
-  y ^= y >> HLC_RANDOM_L;
-
-  return y;
-}
-
-#define HLC_DEFINE_RANDOM_UNSIGNED_IN(ut_name, ut)                      \
-  ut hlc_random_##ut_name##_in(hlc_Random* random, ut min, ut max) {    \
-    assert(max >= min);                                                 \
-                                                                        \
-    ut mask = 0;                                                        \
-    size_t bits = 0;                                                    \
-                                                                        \
-    while (mask < max - min) {                                          \
-      mask = (mask << 1) | 1;                                           \
-      bits += 1;                                                        \
-    }                                                                   \
-                                                                        \
-    ut n;                                                               \
-                                                                        \
-    do {                                                                \
-      n = 0;                                                            \
-                                                                        \
-      for (size_t i = 0; i < bits; i += HLC_RANDOM_W) {                 \
-        n = (ut)((n + 0ULL) << HLC_RANDOM_W) | hlc_random_next(random); \
-      }                                                                 \
-                                                                        \
-      n &= mask;                                                        \
-    } while (n > max - min);                                            \
-                                                                        \
-    return min + n;                                                     \
+    switch (random->engine) {
+      case HLC_RANDOM_MT19937: {
+        // The Mersenne Twisters can't jump cheaply, so seed children from 128 bits of the parent instead. Their
+        // streams may overlap in theory, but the odds are negligible given periods of 2^19937 - 1.
+        uint64_t hi = hlc_random_next64(random);
+        uint64_t lo = hlc_random_next64(random);
+        uint32_t key[4] = {(uint32_t)hi, (uint32_t)(hi >> 32), (uint32_t)lo, (uint32_t)(lo >> 32)};
+        hlc_random_mt19937_create_by_array(&child->state.mt19937, key, 4);
+        break;
+      }
+      case HLC_RANDOM_MT19937_64:
+        hlc_random_mt19937_64_create(&child->state.mt19937_64, hlc_random_next64(random));
+        break;
+      case HLC_RANDOM_XOSHIRO256:
+        // Each child takes the stream up to the next jump, so children never overlap with each other or the parent.
+        child->state.xoshiro256 = random->state.xoshiro256;
+        hlc_random_xoshiro256_jump(&random->state.xoshiro256);
+        break;
+      case HLC_RANDOM_PCG64:
+        child->state.pcg64 = random->state.pcg64;
+        hlc_random_pcg64_jump(&random->state.pcg64);
+        break;
+    }
+  }
+}
+
+
+/// @brief Produces a random number in the range [0, bound), by Lemire's multiply-shift method ("Fast random integer
+/// generation in an interval", 2019). The high half of x * bound is uniform over the range, except for the few x whose
+/// low half falls below threshold = 2^32 mod bound, which are rejected. Most draws need neither a division nor a retry.
+/// @pre bound >= 1 && bound <= 2^32
+static inline uint32_t hlc_random_bounded32(hlc_Random* random, uint64_t bound) {
+  uint64_t product = (uint64_t)hlc_random_next32(random) * bound;
+
+  if ((uint32_t)product < bound) {
+    uint32_t threshold = (uint32_t)((0x100000000ULL - bound) % bound);
+
+    while ((uint32_t)product < threshold) {
+      product = (uint64_t)hlc_random_next32(random) * bound;
+    }
+  }
+
+  return (uint32_t)(product >> 32);
+}
+
+
+/// @brief Produces a random number in the range [0, bound), like hlc_random_bounded32 with 64-bit words.
+/// @param threshold 2^64 mod bound if already known, or 0 to compute it when needed.
+/// @pre bound >= 1
+static inline uint64_t hlc_random_bounded64(hlc_Random* random, uint64_t bound, uint64_t threshold) {
+  uint64_t hi;
+  uint64_t lo = hlc_random_multiply(hlc_random_next64(random), bound, &hi);
+
+  if (lo < bound) {
+    if (threshold == 0) {
+      threshold = -bound % bound;
+    }
+
+    while (lo < threshold) {
+      lo = hlc_random_multiply(hlc_random_next64(random), bound, &hi);
+    }
+  }
+
+  return hi;
+}
+
+
+/// @brief Produces a random number in the range [0, range], using 32-bit draws whenever the range allows it.
+static inline unsigned long long hlc_random_draw(hlc_Random* random, unsigned long long range) {
+  if (range <= 0xFFFFFFFFULL) {
+    return hlc_random_bounded32(random, range + 1);
+  } else if (range < ULLONG_MAX) {
+    return hlc_random_bounded64(random, range + 1, 0);
+  } else {
+    return hlc_random_next64(random);
+  }
+}
+
+
+#define HLC_DEFINE_RANDOM_UNSIGNED_IN(ut_name, ut)                   \
+  ut hlc_random_##ut_name##_in(hlc_Random* random, ut min, ut max) { \
+    assert(max >= min);                                              \
+    return (ut)(min + hlc_random_draw(random, max - min));           \
   }
 
 
@@ -129,3 +685,261 @@ HLC_DEFINE_RANDOM_UNSIGNED_IN(uint, unsigned)
 HLC_DEFINE_RANDOM_UNSIGNED_IN(ulong, unsigned long)
 HLC_DEFINE_RANDOM_UNSIGNED_IN(ullong, unsigned long long)
 HLC_DEFINE_RANDOM_UNSIGNED_IN(size, size_t)
+
+
+void hlc_random_fill(hlc_Random* random, void* buffer, size_t size) {
+  assert(random != NULL);
+  assert(buffer != NULL || size == 0);
+
+  unsigned char* bytes = buffer;
+
+  // Extracting bytes arithmetically, rather than copying outputs, produces the same bytes regardless of endianness.
+
+  while (size > 0) {
+    uint64_t x = hlc_random_next64(random);
+
+    for (size_t i = 0; i < 64 && size > 0; i += CHAR_BIT) {
+      *bytes++ = (unsigned char)(x >> i);
+      size -= 1;
+    }
+  }
+}
+
+
+void hlc_random_fill_size_in(hlc_Random* random, size_t* values, size_t count, size_t min, size_t max) {
+  assert(random != NULL);
+  assert(values != NULL || count == 0);
+  assert(max >= min);
+
+  unsigned long long range = max - min;
+
+  if (range <= 0xFFFFFFFFULL || range == ULLONG_MAX) {
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = (size_t)(min + hlc_random_draw(random, range));
+    }
+  } else {
+    uint64_t bound = range + 1;
+    uint64_t threshold = -bound % bound;
+
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = (size_t)(min + hlc_random_bounded64(random, bound, threshold));
+    }
+  }
+}
+
+
+/// @brief Produces a random double in the range (0, 1], whose logarithm is finite.
+static inline double hlc_random_double_open(hlc_Random* random) {
+  return (double)((hlc_random_next64(random) >> 11) + 1) * 0x1.0p-53;
+}
+
+
+double hlc_random_double(hlc_Random* random) {
+  assert(random != NULL);
+  return (double)(hlc_random_next64(random) >> 11) * 0x1.0p-53;
+}
+
+
+void hlc_random_shuffle(hlc_Random* random, void* array, size_t count, hlc_Layout layout) {
+  assert(random != NULL);
+  assert(array != NULL || count == 0);
+
+  unsigned char* elements = array;
+
+  // Fisher-Yates, swapping elements through a small buffer so that any element size works without allocating.
+
+  for (size_t i = count; i > 1; --i) {
+    size_t j = (size_t)hlc_random_draw(random, i - 1);
+
+    if (j == i - 1) {
+      continue;
+    }
+
+    unsigned char* x = elements + (i - 1) * layout.size;
+    unsigned char* y = elements + j * layout.size;
+
+    for (size_t offset = 0; offset < layout.size; offset += 64) {
+      unsigned char buffer[64];
+      size_t size = layout.size - offset < sizeof(buffer) ? layout.size - offset : sizeof(buffer);
+      memcpy(buffer, x + offset, size);
+      memcpy(x + offset, y + offset, size);
+      memcpy(y + offset, buffer, size);
+    }
+  }
+}
+
+
+/// @brief Draws k indices out of n, in increasing order, by Vitter's method A ("An efficient algorithm for sequential
+/// random sampling", 1987). Each step draws the number of skipped indices by walking down its distribution, which takes
+/// O(n) time overall and suits samples of a large fraction of the population.
+static void hlc_random_sample_a(hlc_Random* random, size_t* indices, size_t k, size_t n, size_t position) {
+  while (k >= 2) {
+    double v = hlc_random_double(random);
+    double top = (double)(n - k);
+    double remaining = (double)n;
+    double quotient = top / remaining;
+    size_t skip = 0;
+
+    while (quotient > v) {
+      skip += 1;
+      top -= 1;
+      remaining -= 1;
+      quotient *= top / remaining;
+    }
+
+    *indices++ = position + skip;
+    position += skip + 1;
+    n -= skip + 1;
+    k -= 1;
+  }
+
+  if (k == 1) {
+    *indices = position + (size_t)hlc_random_draw(random, n - 1);
+  }
+}
+
+
+void hlc_random_sample(hlc_Random* random, size_t* indices, size_t k, size_t n) {
+  assert(random != NULL);
+  assert(indices != NULL || k == 0);
+  assert(k <= n);
+
+  // Vitter's method D draws the number of skipped indices directly, by rejection from a continuous approximation, so
+  // that sampling takes O(k) expected time. It hands over to method A once the sample is a large fraction of what's
+  // left, since A is faster then.
+
+  const size_t alpha = 13;
+  size_t position = 0;
+
+  if (k <= 1 || n / alpha <= k) {
+    hlc_random_sample_a(random, indices, k, n, position);
+    return;
+  }
+
+  double v = exp(log(hlc_random_double_open(random)) / (double)k);
+  size_t qu1 = n - k + 1;
+
+  while (k > 1 && n / alpha > k) {
+    double k1_inverse = 1.0 / (double)(k - 1);
+    double real_n = (double)n;
+    size_t skip;
+
+    while (true) {
+      double x;
+
+      while (true) {
+        x = real_n * (1 - v);
+        skip = (size_t)x;
+
+        if (skip < qu1)
+          break;
+
+        v = exp(log(hlc_random_double_open(random)) / (double)k);
+      }
+
+      double u = hlc_random_double_open(random);
+      double y1 = exp(log(u * real_n / (double)qu1) * k1_inverse);
+      v = y1 * (1 - x / real_n) * ((double)qu1 / (double)(qu1 - skip));
+
+      // The quick acceptance test also leaves in v a correctly distributed value for the next step.
+      if (v <= 1)
+        break;
+
+      double y2 = 1;
+      double top = real_n - 1;
+      double bottom;
+      size_t limit;
+
+      if (k - 1 > skip) {
+        bottom = (double)(n - k);
+        limit = n - skip;
+      } else {
+        bottom = (double)(n - skip - 1);
+        limit = qu1;
+      }
+
+      for (size_t t = n - 1; t >= limit; --t) {
+        y2 = y2 * top / bottom;
+        top -= 1;
+        bottom -= 1;
+      }
+
+      if (real_n / (real_n - x) >= y1 * exp(log(y2) * k1_inverse)) {
+        v = exp(log(hlc_random_double_open(random)) * k1_inverse);
+        break;
+      }
+
+      v = exp(log(hlc_random_double_open(random)) / (double)k);
+    }
+
+    *indices++ = position + skip;
+    position += skip + 1;
+    n -= skip + 1;
+    k -= 1;
+    qu1 -= skip;
+  }
+
+  hlc_random_sample_a(random, indices, k, n, position);
+}
+
+
+/// @brief Returns log(1 + x) / x, which is continuous at 0.
+static double hlc_random_zipf_helper1(double x) {
+  return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+
+/// @brief Returns (exp(x) - 1) / x, which is continuous at 0.
+static double hlc_random_zipf_helper2(double x) {
+  return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x));
+}
+
+
+static double hlc_random_zipf_h(const hlc_Random_zipf* zipf, double x) {
+  return exp(-zipf->exponent * log(x));
+}
+
+
+static double hlc_random_zipf_h_integral(const hlc_Random_zipf* zipf, double x) {
+  double log_x = log(x);
+  return hlc_random_zipf_helper2((1 - zipf->exponent) * log_x) * log_x;
+}
+
+
+static double hlc_random_zipf_h_integral_inverse(const hlc_Random_zipf* zipf, double x) {
+  double t = fmax(x * (1 - zipf->exponent), -1);
+  return exp(hlc_random_zipf_helper1(t) * x);
+}
+
+
+void hlc_random_zipf_create(hlc_Random_zipf* zipf, size_t count, double exponent) {
+  assert(zipf != NULL);
+  assert(count >= 1);
+  assert(exponent > 0 && isfinite(exponent));
+
+  zipf->exponent = exponent;
+  zipf->count = (double)count;
+  zipf->h_integral_x1 = hlc_random_zipf_h_integral(zipf, 1.5) - 1;
+  zipf->h_integral_count = hlc_random_zipf_h_integral(zipf, zipf->count + 0.5);
+  zipf->s = 2 - hlc_random_zipf_h_integral_inverse(
+    zipf,
+    hlc_random_zipf_h_integral(zipf, 2.5) - hlc_random_zipf_h(zipf, 2)
+  );
+}
+
+
+size_t hlc_random_zipf_next(const hlc_Random_zipf* zipf, hlc_Random* random) {
+  assert(zipf != NULL);
+  assert(random != NULL);
+
+  while (true) {
+    double u = zipf->h_integral_count + hlc_random_double(random) * (zipf->h_integral_x1 - zipf->h_integral_count);
+    double x = hlc_random_zipf_h_integral_inverse(zipf, u);
+    double k = fmin(fmax(floor(x + 0.5), 1), zipf->count);
+
+    // Most draws fall where the histogram of h is known to cover the density, and need no further test.
+    if (k - x <= zipf->s || u >= hlc_random_zipf_h_integral(zipf, k + 0.5) - hlc_random_zipf_h(zipf, k)) {
+      return (size_t)k - 1;
+    }
+  }
+}
@@ -1,6 +1,7 @@
 #ifndef HLC_RANDOM_H
 #define HLC_RANDOM_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
 #include "api.h"
@@ -10,19 +11,70 @@ HLC_DECLARATIONS_BEGIN
 
 typedef struct hlc_Random hlc_Random;
 
+/// @brief A Zipf distribution over ranks, from which hlc_random_zipf_next draws in constant expected time.
+typedef struct hlc_Random_zipf hlc_Random_zipf;
+
+/// @brief The algorithms which a hlc_Random can produce numbers with.
+typedef enum hlc_Random_engine {
+  /// @brief The 32-bit Mersenne Twister. Its state takes 5 KB.
+  HLC_RANDOM_MT19937,
+
+  /// @brief The 64-bit Mersenne Twister. Its state takes 5 KB.
+  HLC_RANDOM_MT19937_64,
+
+  /// @brief xoshiro256**, with a 32 bytes state. This is the fastest engine.
+  HLC_RANDOM_XOSHIRO256,
+
+  /// @brief PCG XSL RR 128/64, with a 32 bytes state.
+  HLC_RANDOM_PCG64,
+} hlc_Random_engine;
+
 /// @memberof hlc_Random
+/// @brief The layout of generators of any engine.
 extern HLC_API const hlc_Layout hlc_random_layout;
 
 /// @memberof hlc_Random
-/// @brief Creates a new random number generator.
+/// @brief Returns the layout of generators of the given engine, which may be smaller than hlc_random_layout.
+HLC_API hlc_Layout hlc_random_engine_layout(hlc_Random_engine engine);
+
+/// @memberof hlc_Random
+/// @brief Creates a new MT19937 random number generator, seeded from the current time. Generators created at the same
+/// time, even by different threads, get different seeds.
 /// @pre random != NULL
 HLC_API void hlc_random_create(hlc_Random* random);
 
 /// @memberof hlc_Random
-/// @brief Creates a new random number generator.
+/// @brief Creates a new MT19937 random number generator.
 /// @pre random != NULL
 HLC_API void hlc_random_create_with(hlc_Random* random, unsigned long seed);
 
+/// @memberof hlc_Random
+/// @brief Creates a new random number generator using the given engine. MT19937 uses init_genrand for seeds of 32 bits,
+/// like hlc_random_create_with, and init_by_array for wider ones.
+/// @pre random != NULL, and random points to at least hlc_random_engine_layout(engine).size bytes
+HLC_API void hlc_random_create_with_engine(hlc_Random* random, hlc_Random_engine engine, unsigned long long seed);
+
+/// @memberof hlc_Random
+/// @brief Returns the engine of this random number generator.
+/// @pre random != NULL
+HLC_API hlc_Random_engine hlc_random_engine(const hlc_Random* random);
+
+/// @memberof hlc_Random
+/// @brief Advances this random number generator as if it had produced 2^192 outputs for xoshiro256**, or 2^64 for
+/// PCG64, which is far more than any computation draws. The skipped outputs can then be drawn by a copy taken before.
+/// @return true on success, or false if the engine can't jump (MT19937 and MT19937-64).
+/// @pre random != NULL
+HLC_API bool hlc_random_jump(hlc_Random* random);
+
+/// @memberof hlc_Random
+/// @brief Creates independent random number generators from this one, for instance one per worker thread. The results
+/// only depend on the state of this generator, which is advanced past them.
+/// @details Children of xoshiro256** and PCG64 generators take consecutive jumps of the stream, so they never overlap.
+/// Children of MT19937 generators are seeded from 128 bits of it, and those of MT19937-64 generators from 64 bits.
+/// @pre random != NULL && (children != NULL || count == 0), and each children[i] is distinct from random and points to
+/// at least hlc_random_engine_layout(hlc_random_engine(random)).size bytes
+HLC_API void hlc_random_split(hlc_Random* random, hlc_Random* const* children, size_t count);
+
 /// @memberof hlc_Random
 /// @brief Produces a random unsigned char in the range [min, max].
 /// @pre random != NULL && min <= max
@@ -53,6 +105,48 @@ HLC_API unsigned long long hlc_random_ullong_in(hlc_Random* random, unsigned lon
 /// @pre random != NULL && min <= max
 HLC_API size_t hlc_random_size_in(hlc_Random* random, size_t min, size_t max);
 
+/// @memberof hlc_Random
+/// @brief Fills a buffer with random bytes.
+/// @pre random != NULL && (buffer != NULL || size == 0)
+HLC_API void hlc_random_fill(hlc_Random* random, void* buffer, size_t size);
+
+/// @memberof hlc_Random
+/// @brief Fills an array with random size_t values in the range [min, max]. This produces the same values as count
+/// calls to hlc_random_size_in, but prepares the range only once.
+/// @pre random != NULL && (values != NULL || count == 0) && min <= max
+HLC_API void hlc_random_fill_size_in(hlc_Random* random, size_t* values, size_t count, size_t min, size_t max);
+
+/// @memberof hlc_Random
+/// @brief Produces a random double in the range [0, 1), a multiple of 2^-53.
+/// @pre random != NULL
+HLC_API double hlc_random_double(hlc_Random* random);
+
+/// @memberof hlc_Random
+/// @brief Shuffles an array in place, such that all permutations are equally likely.
+/// @pre random != NULL && (array != NULL || count == 0)
+HLC_API void hlc_random_shuffle(hlc_Random* random, void* array, size_t count, hlc_Layout layout);
+
+/// @memberof hlc_Random
+/// @brief Draws k distinct indices in the range [0, n), such that all subsets are equally likely, and stores them in
+/// increasing order. This takes O(k) expected time and no memory besides the indices.
+/// @pre random != NULL && (indices != NULL || k == 0) && k <= n, and n <= 2^53
+HLC_API void hlc_random_sample(hlc_Random* random, size_t* indices, size_t k, size_t n);
+
+/// @memberof hlc_Random_zipf
+extern HLC_API const hlc_Layout hlc_random_zipf_layout;
+
+/// @memberof hlc_Random_zipf
+/// @brief Creates a Zipf distribution over count ranks, where rank r is drawn with a probability proportional to
+/// (r + 1)^-exponent. The distribution holds no resources and needs no destruction.
+/// @pre zipf != NULL && count >= 1 && exponent > 0, and exponent is finite
+HLC_API void hlc_random_zipf_create(hlc_Random_zipf* zipf, size_t count, double exponent);
+
+/// @memberof hlc_Random_zipf
+/// @brief Draws a rank in the range [0, count), rank 0 being the most likely. Each draw takes constant expected time,
+/// regardless of count and exponent.
+/// @pre zipf != NULL && random != NULL
+HLC_API size_t hlc_random_zipf_next(const hlc_Random_zipf* zipf, hlc_Random* random);
+
 HLC_DECLARATIONS_END
 
 #endif
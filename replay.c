@@ -0,0 +1,496 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "layout.h"
+#include "map.h"
+#include "set.h"
+#include "trace.h"
+#include "traits/assign.h"
+#include "traits/compare.h"
+#include "traits/destroy.h"
+
+
+static const char* const replay_operation_names[] = {
+  [HLC_TRACE_CREATE] = "create",
+  [HLC_TRACE_DESTROY] = "destroy",
+  [HLC_TRACE_CLONE] = "clone",
+  [HLC_TRACE_INSERT] = "insert",
+  [HLC_TRACE_REMOVE] = "remove",
+  [HLC_TRACE_LOOKUP] = "lookup",
+  [HLC_TRACE_ITERATE] = "iterate",
+};
+
+#define REPLAY_OPERATIONS (HLC_TRACE_ITERATE + 1)
+
+
+typedef struct Replay_options {
+  const char* path;
+  hlc_Trace_container as;
+  size_t value_size;
+  size_t repeat;
+  bool json;
+} Replay_options;
+
+
+typedef struct Replay_container {
+  bool live;
+  hlc_Trace_container kind;
+  void* container;
+} Replay_container;
+
+
+typedef struct Replay {
+  const Replay_options* options;
+  hlc_Map* slots;
+  Replay_container* containers;
+  size_t container_count;
+  size_t container_capacity;
+
+  hlc_Layout value_layout;
+  hlc_Assign_instance value_assign_instance;
+  unsigned char* value;
+  size_t sink;
+
+  size_t counts[REPLAY_OPERATIONS];
+  double seconds[REPLAY_OPERATIONS];
+} Replay;
+
+
+/// @brief Assigns values of the size given by the context, since the replayed values are opaque bytes.
+static bool replay_value_assign(void* target, const void* source, const hlc_Assign_trait* trait, void* context) {
+  (void)trait;
+  memcpy(target, source, *(const size_t*)context);
+  return true;
+}
+
+static const hlc_Assign_trait replay_value_assign_trait = {
+  .assign = replay_value_assign,
+  .reassign = replay_value_assign,
+};
+
+
+static double replay_seconds(void) {
+  struct timespec t;
+  timespec_get(&t, TIME_UTC);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+
+static void replay_destroy(Replay_container* container) {
+  if (!container->live)
+    return;
+
+  if (container->kind == HLC_TRACE_SET) {
+    hlc_set_destroy(container->container);
+  } else {
+    hlc_map_destroy(container->container);
+  }
+
+  container->live = false;
+}
+
+
+static void replay_create(Replay* replay, Replay_container* container, hlc_Trace_container kind) {
+  replay_destroy(container);
+  container->kind = replay->options->as != 0 ? replay->options->as : kind;
+  container->live = true;
+
+  if (container->kind == HLC_TRACE_SET) {
+    hlc_set_create(
+      container->container,
+      HLC_LAYOUT_OF(unsigned long long),
+      hlc_ullong_compare_instance,
+      hlc_no_destroy_instance
+    );
+  } else {
+    hlc_map_create(
+      container->container,
+      HLC_LAYOUT_OF(unsigned long long),
+      replay->value_layout,
+      hlc_ullong_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance
+    );
+  }
+}
+
+
+/// @brief Returns the container with the given identifier, creating it if the trace started after its creation.
+/// @details Identifiers are global to the recording process, so they are mapped to consecutive slots rather than used
+/// as indices, which would size the containers by the largest identifier instead of by their number.
+static Replay_container* replay_container(Replay* replay, unsigned long id, hlc_Trace_container kind) {
+  const size_t* slot = hlc_map_lookup(replay->slots, &id);
+
+  if (slot == NULL) {
+    if (replay->container_count == replay->container_capacity) {
+      size_t capacity = replay->container_capacity > 0 ? 2 * replay->container_capacity : 16;
+      Replay_container* containers = realloc(replay->containers, capacity * sizeof(Replay_container));
+
+      if (containers == NULL)
+        return NULL;
+
+      replay->containers = containers;
+      replay->container_capacity = capacity;
+    }
+
+    size_t size = hlc_set_layout.size > hlc_map_layout.size ? hlc_set_layout.size : hlc_map_layout.size;
+    Replay_container container = {.live = false, .kind = kind, .container = malloc(size)};
+
+    if (container.container == NULL)
+      return NULL;
+
+    bool inserted = hlc_map_insert(
+      replay->slots,
+      &id,
+      &replay->container_count,
+      hlc_ulong_assign_instance,
+      hlc_size_assign_instance
+    );
+
+    if (!inserted) {
+      free(container.container);
+      return NULL;
+    }
+
+    slot = hlc_map_lookup(replay->slots, &id);
+    replay->containers[replay->container_count] = container;
+    replay->container_count += 1;
+  }
+
+  Replay_container* container = &replay->containers[*slot];
+
+  if (!container->live) {
+    replay_create(replay, container, kind);
+  }
+
+  return container;
+}
+
+
+static size_t replay_iterate(Replay_container* container) {
+  size_t count = 0;
+
+  if (container->kind == HLC_TRACE_SET) {
+    hlc_Set_iterator* iterator = malloc(hlc_set_iterator_layout.size);
+
+    if (iterator == NULL)
+      return 0;
+
+    hlc_set_iterator(container->container, iterator);
+
+    while (hlc_set_iterator_next(iterator) != NULL) {
+      count += 1;
+    }
+
+    free(iterator);
+  } else {
+    hlc_Map_iterator* iterator = malloc(hlc_map_iterator_layout.size);
+
+    if (iterator == NULL)
+      return 0;
+
+    hlc_map_iterator(container->container, iterator);
+
+    while (hlc_map_iterator_next(iterator).key != NULL) {
+      count += 1;
+    }
+
+    free(iterator);
+  }
+
+  return count;
+}
+
+
+static bool replay_execute(Replay* replay, const hlc_Trace_record* record) {
+  Replay_container* container = replay_container(replay, record->container_id, record->container);
+
+  if (container == NULL)
+    return false;
+
+  const unsigned long long* key = &record->key;
+  bool set = container->kind == HLC_TRACE_SET;
+
+  switch (record->operation) {
+    case HLC_TRACE_CREATE:
+      replay_create(replay, container, record->container);
+      return true;
+    case HLC_TRACE_DESTROY:
+      replay_destroy(container);
+      return true;
+    case HLC_TRACE_CLONE: {
+      if (record->key > 0xFFFFFFFFULL)
+        return false;
+
+      // Sources the trace never mentioned are created empty. Creating them may move the containers, so look the clone
+      // up again afterwards.
+      Replay_container* source = replay_container(replay, (unsigned long)record->key, record->container);
+
+      if (source == NULL)
+        return false;
+
+      container = replay_container(replay, record->container_id, record->container);
+      replay_destroy(container);
+      container->kind = source->kind;
+      container->live = true;
+
+      if (source->kind == HLC_TRACE_SET)
+        return hlc_set_clone(source->container, container->container, hlc_ullong_assign_instance);
+
+      return hlc_map_clone(
+        source->container,
+        container->container,
+        hlc_ullong_assign_instance,
+        replay->value_assign_instance
+      );
+    }
+    case HLC_TRACE_INSERT:
+      if (set)
+        return hlc_set_insert(container->container, key, hlc_ullong_assign_instance);
+
+      return hlc_map_insert(
+        container->container,
+        key,
+        replay->value,
+        hlc_ullong_assign_instance,
+        replay->value_assign_instance
+      );
+    case HLC_TRACE_REMOVE:
+      replay->sink += set ? hlc_set_remove(container->container, key) : hlc_map_remove(container->container, key);
+      return true;
+    case HLC_TRACE_LOOKUP:
+      replay->sink += set ? hlc_set_contains(container->container, key) : hlc_map_contains(container->container, key);
+      return true;
+    case HLC_TRACE_ITERATE:
+      replay->sink += replay_iterate(container);
+      return true;
+  }
+
+  return false;
+}
+
+
+/// @brief Replays records, timing each run of consecutive records with the same operation as a whole, so that reading
+/// the clock doesn't dominate short operations.
+static bool replay_run(Replay* replay, const hlc_Trace_record* records, size_t count) {
+  size_t i = 0;
+
+  while (i < count) {
+    hlc_Trace_operation operation = records[i].operation;
+    double start = replay_seconds();
+    size_t j = i;
+
+    for (; j < count && records[j].operation == operation; ++j) {
+      if (!replay_execute(replay, &records[j]))
+        return false;
+    }
+
+    replay->seconds[operation] += replay_seconds() - start;
+    replay->counts[operation] += j - i;
+    i = j;
+  }
+
+  for (size_t k = 0; k < replay->container_count; ++k) {
+    replay_destroy(&replay->containers[k]);
+  }
+
+  return true;
+}
+
+
+static hlc_Trace_record* replay_load(const char* path, size_t* count) {
+  FILE* file = fopen(path, "rb");
+
+  if (file == NULL)
+    return NULL;
+
+  unsigned char header[HLC_TRACE_HEADER_SIZE];
+  hlc_Trace_record* records = NULL;
+  size_t capacity = 0;
+  *count = 0;
+
+  if (fread(header, sizeof(header), 1, file) != 1 || !hlc_trace_decode_header(header)) {
+    fclose(file);
+    return NULL;
+  }
+
+  unsigned char bytes[HLC_TRACE_RECORD_SIZE];
+
+  while (fread(bytes, sizeof(bytes), 1, file) == 1) {
+    if (*count == capacity) {
+      capacity = capacity > 0 ? 2 * capacity : 4096;
+      hlc_Trace_record* grown = realloc(records, capacity * sizeof(hlc_Trace_record));
+
+      if (grown == NULL) {
+        free(records);
+        fclose(file);
+        return NULL;
+      }
+
+      records = grown;
+    }
+
+    if (!hlc_trace_decode_record(bytes, &records[*count])) {
+      free(records);
+      fclose(file);
+      return NULL;
+    }
+
+    *count += 1;
+  }
+
+  fclose(file);
+
+  // An empty trace is valid, but must be distinguished from a failure.
+  return records != NULL ? records : malloc(sizeof(hlc_Trace_record));
+}
+
+
+static bool replay_parse(int argc, char** argv, Replay_options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* argument = argv[i];
+
+    if (strcmp(argument, "--as=set") == 0) {
+      options->as = HLC_TRACE_SET;
+    } else if (strcmp(argument, "--as=map") == 0) {
+      options->as = HLC_TRACE_MAP;
+    } else if (strcmp(argument, "--as=recorded") == 0) {
+      options->as = 0;
+    } else if (strncmp(argument, "--value-size=", 13) == 0) {
+      options->value_size = strtoul(argument + 13, NULL, 10);
+    } else if (strncmp(argument, "--repeat=", 9) == 0) {
+      options->repeat = strtoul(argument + 9, NULL, 10);
+    } else if (strcmp(argument, "--csv") == 0) {
+      options->json = false;
+    } else if (strcmp(argument, "--json") == 0) {
+      options->json = true;
+    } else if (argument[0] != '-' && options->path == NULL) {
+      options->path = argument;
+    } else {
+      return false;
+    }
+  }
+
+  return options->path != NULL && options->value_size >= 1 && options->repeat >= 1;
+}
+
+
+static void replay_report(const Replay_options* options, const Replay* replay) {
+  if (options->json) {
+    fputs("[", stdout);
+  } else {
+    puts("operation,count,seconds,ns_per_op");
+  }
+
+  bool first = true;
+
+  for (size_t operation = HLC_TRACE_CREATE; operation < REPLAY_OPERATIONS; ++operation) {
+    size_t count = replay->counts[operation];
+    double seconds = replay->seconds[operation];
+    double ns_per_op = count != 0 ? seconds * 1e9 / (double)count : 0;
+
+    if (options->json) {
+      printf(
+        "%s\n  {\"operation\": \"%s\", \"count\": %zu, \"seconds\": %.6f, \"ns_per_op\": %.2f}",
+        first ? "" : ",",
+        replay_operation_names[operation],
+        count,
+        seconds,
+        ns_per_op
+      );
+    } else {
+      printf("%s,%zu,%.6f,%.2f\n", replay_operation_names[operation], count, seconds, ns_per_op);
+    }
+
+    first = false;
+  }
+
+  if (options->json) {
+    puts("\n]");
+  }
+}
+
+
+int main(int argc, char** argv) {
+  Replay_options options = {
+    .path = NULL,
+    .as = 0,
+    .value_size = sizeof(unsigned long long),
+    .repeat = 1,
+    .json = false,
+  };
+
+  if (!replay_parse(argc, argv, &options)) {
+    fprintf(
+      stderr,
+      "Usage: %s TRACE [--as=recorded|set|map] [--value-size=BYTES] [--repeat=COUNT] [--csv | --json]\n"
+      "Replays a trace recorded by a build with HLC_TRACE defined, using the recorded key hashes as keys.\n",
+      argv[0]
+    );
+    return EXIT_FAILURE;
+  }
+
+  size_t count;
+  hlc_Trace_record* records = replay_load(options.path, &count);
+
+  if (records == NULL) {
+    fprintf(stderr, "Cannot read the trace %s\n", options.path);
+    return EXIT_FAILURE;
+  }
+
+  Replay replay = {
+    .options = &options,
+    .slots = malloc(hlc_map_layout.size),
+    .containers = NULL,
+    .container_count = 0,
+    .container_capacity = 0,
+    .value_layout = {.size = options.value_size, .alignment = 1},
+    .value_assign_instance = {.trait = &replay_value_assign_trait, .context = &options.value_size},
+    .value = calloc(options.value_size, 1),
+    .sink = 0,
+  };
+
+  bool success = replay.value != NULL && replay.slots != NULL;
+
+  if (replay.slots != NULL) {
+    hlc_map_create(
+      replay.slots,
+      HLC_LAYOUT_OF(unsigned long),
+      HLC_LAYOUT_OF(size_t),
+      hlc_ulong_compare_instance,
+      hlc_no_destroy_instance,
+      hlc_no_destroy_instance
+    );
+  }
+
+  for (size_t i = 0; success && i < options.repeat; ++i) {
+    success = replay_run(&replay, records, count);
+  }
+
+  if (success) {
+    replay_report(&options, &replay);
+  } else {
+    fputs("The replay failed: out of memory or malformed trace\n", stderr);
+  }
+
+  for (size_t i = 0; i < replay.container_count; ++i) {
+    replay_destroy(&replay.containers[i]);
+    free(replay.containers[i].container);
+  }
+
+  if (replay.slots != NULL) {
+    hlc_map_destroy(replay.slots);
+  }
+
+  free(replay.slots);
+  free(replay.containers);
+  free(replay.value);
+  free(records);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
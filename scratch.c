@@ -0,0 +1,108 @@
+#include "scratch.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "tls.h"
+
+
+typedef enum hlc_Scratch_origin {
+  HLC_SCRATCH_SMALL,
+  HLC_SCRATCH_BUFFER,
+  HLC_SCRATCH_HEAP,
+} hlc_Scratch_origin;
+
+
+typedef struct hlc_Scratch_buffer {
+  unsigned char* bytes;
+  size_t used;
+} hlc_Scratch_buffer;
+
+
+static HLC_THREAD_LOCAL hlc_Scratch_buffer hlc_scratch_buffer = {.bytes = NULL, .used = 0};
+
+// Thread-local variables have no destructors, so each buffer is also registered with a key whose destructor frees it
+// when its thread exits:
+
+static once_flag hlc_scratch_once = ONCE_FLAG_INIT;
+static tss_t hlc_scratch_key;
+static bool hlc_scratch_key_ok = false;
+
+
+static void hlc_scratch_initialize(void) {
+  hlc_scratch_key_ok = tss_create(&hlc_scratch_key, free) == thrd_success;
+}
+
+
+/// @brief Allocates the buffer of the calling thread.
+/// @return true on success, false on insufficient memory (or if the buffer couldn't be registered to be freed).
+static bool hlc_scratch_buffer_create(hlc_Scratch_buffer* buffer) {
+  call_once(&hlc_scratch_once, hlc_scratch_initialize);
+
+  if (!hlc_scratch_key_ok)
+    return false;
+
+  buffer->bytes = malloc(HLC_SCRATCH_BUFFER_SIZE);
+
+  if (buffer->bytes == NULL)
+    return false;
+
+  if (tss_set(hlc_scratch_key, buffer->bytes) != thrd_success) {
+    free(buffer->bytes);
+    buffer->bytes = NULL;
+    return false;
+  }
+
+  buffer->used = 0;
+  return true;
+}
+
+
+void* hlc_scratch_acquire(hlc_Scratch* scratch, size_t size) {
+  assert(scratch != NULL);
+
+  if (size <= sizeof(scratch->small.bytes)) {
+    scratch->origin = HLC_SCRATCH_SMALL;
+    scratch->memory = scratch->small.bytes;
+    return scratch->memory;
+  }
+
+  // Bumps stay aligned for any type:
+  size_t aligned_size = (size + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t);
+  hlc_Scratch_buffer* buffer = &hlc_scratch_buffer;
+
+  if (aligned_size <= HLC_SCRATCH_BUFFER_SIZE && (buffer->bytes != NULL || hlc_scratch_buffer_create(buffer))) {
+    if (aligned_size <= HLC_SCRATCH_BUFFER_SIZE - buffer->used) {
+      scratch->origin = HLC_SCRATCH_BUFFER;
+      scratch->previous_used = buffer->used;
+      scratch->memory = buffer->bytes + buffer->used;
+      buffer->used += aligned_size;
+      return scratch->memory;
+    }
+  }
+
+  scratch->origin = HLC_SCRATCH_HEAP;
+  scratch->memory = malloc(size);
+  return scratch->memory;
+}
+
+
+void hlc_scratch_release(hlc_Scratch* scratch) {
+  assert(scratch != NULL);
+
+  switch (scratch->origin) {
+  case HLC_SCRATCH_BUFFER:
+    assert(scratch->memory == hlc_scratch_buffer.bytes + scratch->previous_used);
+    hlc_scratch_buffer.used = scratch->previous_used;
+    break;
+  case HLC_SCRATCH_HEAP:
+    free(scratch->memory);
+    break;
+  default:
+    break;
+  }
+}
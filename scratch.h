@@ -0,0 +1,46 @@
+#ifndef HLC_SCRATCH_H
+#define HLC_SCRATCH_H
+
+#include <stddef.h>
+
+#include "api.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief The number of bytes a scratch holds inline, on the stack of its caller.
+#define HLC_SCRATCH_SMALL_SIZE 256
+
+/// @brief The number of bytes of the buffer each thread bumps scratches from when they don't fit inline.
+#define HLC_SCRATCH_BUFFER_SIZE 65536
+
+/// @brief Temporary memory for the duration of an operation, as a bounded replacement for HLC_STACK_ALLOCATE.
+/// @details Small sizes are served by a buffer inside the scratch itself. Larger ones are bumped from a buffer owned by
+/// the calling thread, which is allocated once and freed when the thread exits. Only sizes which don't fit there go to
+/// the heap. Scratches must be released by the thread which acquired them, in the reverse order of acquisition.
+typedef struct hlc_Scratch {
+  void* memory;
+
+  /// @brief Where the memory comes from, and the part of the thread's buffer which was used before it, if it's there.
+  unsigned char origin;
+  size_t previous_used;
+
+  union {
+    max_align_t alignment;
+    unsigned char bytes[HLC_SCRATCH_SMALL_SIZE];
+  } small;
+} hlc_Scratch;
+
+/// @memberof hlc_Scratch
+/// @brief Acquires memory of the given size, suitably aligned for any type, until hlc_scratch_release is called.
+/// @return The memory on success, or NULL on insufficient memory.
+/// @pre scratch != NULL
+HLC_API void* hlc_scratch_acquire(hlc_Scratch* scratch, size_t size);
+
+/// @memberof hlc_Scratch
+/// @brief Releases the memory of a scratch which was successfully acquired.
+/// @pre scratch != NULL
+HLC_API void hlc_scratch_release(hlc_Scratch* scratch);
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -5,26 +5,51 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "avl.h"
+#include "counters.h"
+#include "eytzinger.h"
 #include "layout.h"
 #include "math.h"
+#include "prefetch.h"
+#include "task.h"
+#include "trace.h"
 #include "traits/assign.h"
 #include "traits/compare.h"
 #include "traits/destroy.h"
+#include "traits/reduce.h"
 
 
 struct hlc_Set {
   hlc_AVL* root;
   size_t count;
+
+  // The nodes of the minimum and maximum, kept up to date so that they're reached without a descent.
+  hlc_AVL* leftmost;
+  hlc_AVL* rightmost;
+
   hlc_Layout element_layout;
   hlc_Compare_instance element_compare_instance;
   hlc_Destroy_instance element_destroy_instance;
+
+  #ifdef HLC_COUNTERS
+    hlc_Atomic_counters counters;
+  #endif
+
+  #ifdef HLC_TRACE
+    unsigned long trace_id;
+  #endif
 };
 
 const hlc_Layout hlc_set_layout = {.size = sizeof(hlc_Set), .alignment = alignof(hlc_Set)};
 
 
+/// @brief The number of searches hlc_set_contains_batch advances in lockstep.
+#define HLC_SET_BATCH 8
+
+
 struct hlc_Set_iterator {
   const hlc_AVL* current;
   hlc_Layout element_layout;
@@ -33,6 +58,53 @@ struct hlc_Set_iterator {
 const hlc_Layout hlc_set_iterator_layout = {.size = sizeof(hlc_Set_iterator), .alignment = alignof(hlc_Set_iterator)};
 
 
+struct hlc_Frozen_set {
+  char* elements;
+  size_t count;
+  hlc_Layout element_layout;
+  hlc_Compare_instance element_compare_instance;
+  hlc_Destroy_instance element_destroy_instance;
+};
+
+const hlc_Layout hlc_frozen_set_layout = {.size = sizeof(hlc_Frozen_set), .alignment = alignof(hlc_Frozen_set)};
+
+
+struct hlc_Frozen_set_iterator {
+  const char* elements;
+  size_t count;
+  size_t current;
+  size_t element_size;
+};
+
+const hlc_Layout hlc_frozen_set_iterator_layout = {
+  .size = sizeof(hlc_Frozen_set_iterator),
+  .alignment = alignof(hlc_Frozen_set_iterator),
+};
+
+
+/// @brief Updates the leftmost/rightmost nodes after a node was inserted to the left/right of a node.
+static inline void hlc_set_xmost_after_insertion(hlc_Set* set, hlc_AVL* node, signed char direction) {
+  // A new minimum/maximum can only be inserted to the left/right of the current one, which it then precedes/follows.
+  if (direction < 0 && node == set->leftmost) {
+    set->leftmost = hlc_avl_xcessor(node, -1);
+  } else if (direction > 0 && node == set->rightmost) {
+    set->rightmost = hlc_avl_xcessor(node, +1);
+  }
+}
+
+
+/// @brief Updates the leftmost/rightmost nodes before a node is removed.
+static inline void hlc_set_xmost_before_removal(hlc_Set* set, hlc_AVL* node) {
+  if (node == set->leftmost) {
+    set->leftmost = hlc_avl_xcessor(node, +1);
+  }
+
+  if (node == set->rightmost) {
+    set->rightmost = hlc_avl_xcessor(node, -1);
+  }
+}
+
+
 void hlc_set_create(
   hlc_Set* set,
   hlc_Layout element_layout,
@@ -43,9 +115,21 @@ void hlc_set_create(
 
   set->root = NULL;
   set->count = 0;
+  set->leftmost = NULL;
+  set->rightmost = NULL;
   set->element_layout = element_layout;
   set->element_compare_instance = element_compare_instance;
   set->element_destroy_instance = element_destroy_instance;
+
+  #ifdef HLC_COUNTERS
+    hlc_counters_reset(&set->counters);
+  #endif
+
+  #ifdef HLC_TRACE
+    set->trace_id = HLC_TRACE_NEW_ID();
+  #endif
+
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CREATE, HLC_TRACE_SET, set->trace_id, 0);
 }
 
 
@@ -55,8 +139,27 @@ size_t hlc_set_count(const hlc_Set* set) {
 }
 
 
+hlc_Set_stats hlc_set_stats(const hlc_Set* set) {
+  assert(set != NULL);
+
+  hlc_Layout node_layout = hlc_avl_layout(set->element_layout);
+
+  return (hlc_Set_stats){
+    .count = set->count,
+    .node_size = node_layout.size,
+    .element_size = set->element_layout.size,
+    .total_size = set->count * node_layout.size,
+    .overhead = (double)(node_layout.size - set->element_layout.size) / (double)node_layout.size,
+    .height = hlc_avl_height(set->root),
+    .average_depth = set->count > 0 ? (double)hlc_avl_depth_sum(set->root) / (double)set->count : 0,
+  };
+}
+
+
 bool hlc_set_insert(hlc_Set* set, const void* element, hlc_Assign_instance element_assign_instance) {
   assert(set != NULL);
+  HLC_COUNT(&set->counters, insertions);
+  HLC_TRACE_RECORD(HLC_TRACE_INSERT, HLC_TRACE_SET, set->trace_id, element, set->element_layout.size);
 
   if (set->root != NULL) {
     hlc_AVL* node = set->root;
@@ -64,16 +167,25 @@ bool hlc_set_insert(hlc_Set* set, const void* element, hlc_Assign_instance eleme
     while (true) {
       void* node_element = hlc_avl_element(node, set->element_layout);
       signed char ordering = hlc_compare(element, node_element, set->element_compare_instance);
+      HLC_COUNT(&set->counters, insertion_comparisons);
 
-      if (ordering == 0)
-        return hlc_reassign(node_element, element, element_assign_instance);
+      if (ordering == 0) {
+        HLC_COUNT(&set->counters, reassigns);
+        return hlc_reassign_sized(node_element, element, set->element_layout.size, element_assign_instance);
+      }
 
       hlc_AVL* node_child = hlc_avl_link(node, ordering);
 
       if (node_child == NULL) {
+        hlc_AVL* parent = node;
+
+        HLC_COUNTERS_ENTER(&set->counters);
         node = hlc_avl_insert(node, ordering, element, set->element_layout, element_assign_instance);
+        HLC_COUNTERS_LEAVE();
 
         if (node != NULL){
+          hlc_set_xmost_after_insertion(set, parent, ordering);
+
           if (hlc_avl_link(node, 0) == NULL) {
             set->root = node;
           }
@@ -89,10 +201,14 @@ bool hlc_set_insert(hlc_Set* set, const void* element, hlc_Assign_instance eleme
       node = node_child;
     }
   } else {
+    HLC_COUNTERS_ENTER(&set->counters);
     hlc_AVL* node = hlc_avl_new(element, set->element_layout, element_assign_instance);
+    HLC_COUNTERS_LEAVE();
 
     if (node != NULL) {
       set->root = node;
+      set->leftmost = node;
+      set->rightmost = node;
       set->count += 1;
       return true;
     } else {
@@ -104,15 +220,22 @@ bool hlc_set_insert(hlc_Set* set, const void* element, hlc_Assign_instance eleme
 
 bool hlc_set_remove(hlc_Set* set, const void* element) {
   assert(set != NULL);
+  HLC_COUNT(&set->counters, removals);
+  HLC_TRACE_RECORD(HLC_TRACE_REMOVE, HLC_TRACE_SET, set->trace_id, element, set->element_layout.size);
 
   hlc_AVL* node = set->root;
 
   while (node != NULL) {
     void* node_element = hlc_avl_element(node, set->element_layout);
     signed char ordering = hlc_compare(element, node_element, set->element_compare_instance);
+    HLC_COUNT(&set->counters, removal_comparisons);
 
     if (ordering == 0) {
+      hlc_set_xmost_before_removal(set, node);
+
+      HLC_COUNTERS_ENTER(&set->counters);
       node = hlc_avl_remove(node, set->element_layout, set->element_destroy_instance);
+      HLC_COUNTERS_LEAVE();
 
       if (node == NULL || hlc_avl_link(node, 0) == NULL) {
         set->root = node;
@@ -132,12 +255,15 @@ bool hlc_set_remove(hlc_Set* set, const void* element) {
 
 bool hlc_set_contains(const hlc_Set* set, const void* key) {
   assert(set != NULL);
+  HLC_COUNT(&set->counters, lookups);
+  HLC_TRACE_RECORD(HLC_TRACE_LOOKUP, HLC_TRACE_SET, set->trace_id, key, set->element_layout.size);
 
   hlc_AVL* node = set->root;
 
   while (node != NULL) {
     void* node_element = hlc_avl_element(node, set->element_layout);
     signed char ordering = hlc_compare(key, node_element, set->element_compare_instance);
+    HLC_COUNT(&set->counters, lookup_comparisons);
 
     if (ordering == 0) {
       return true;
@@ -150,18 +276,235 @@ bool hlc_set_contains(const hlc_Set* set, const void* key) {
 }
 
 
+void hlc_set_contains_batch(const hlc_Set* set, const void* keys, size_t count, bool* results) {
+  assert(set != NULL);
+  assert(count == 0 || (keys != NULL && results != NULL));
+
+  const char* key_bytes = keys;
+
+  #ifdef HLC_TRACE
+    for (size_t i = 0; i < count; ++i) {
+      const void* key = key_bytes + i * set->element_layout.size;
+      HLC_TRACE_RECORD(HLC_TRACE_LOOKUP, HLC_TRACE_SET, set->trace_id, key, set->element_layout.size);
+    }
+  #endif
+
+  if (set->root == NULL) {
+    for (size_t i = 0; i < count; ++i) {
+      HLC_COUNT(&set->counters, lookups);
+      results[i] = false;
+    }
+
+    return;
+  }
+
+  // Each slot holds an ongoing search. Every pass advances each search by one node and prefetches the next one, so
+  // that by the time a slot is visited again its node is likely to be cached. Finished slots take the next key.
+
+  size_t slot_keys[HLC_SET_BATCH];
+  const hlc_AVL* slot_nodes[HLC_SET_BATCH];
+  size_t active = HLC_MIN(count, HLC_SET_BATCH);
+  size_t next = active;
+
+  for (size_t j = 0; j < active; ++j) {
+    slot_keys[j] = j;
+    slot_nodes[j] = set->root;
+  }
+
+  for (size_t j = active; j < HLC_SET_BATCH; ++j) {
+    slot_nodes[j] = NULL;
+  }
+
+  while (active > 0) {
+    for (size_t j = 0; j < HLC_SET_BATCH; ++j) {
+      const hlc_AVL* node = slot_nodes[j];
+
+      if (node == NULL)
+        continue;
+
+      size_t i = slot_keys[j];
+      const void* key = key_bytes + i * set->element_layout.size;
+      const void* node_element = hlc_avl_element(node, set->element_layout);
+      signed char ordering = hlc_compare(key, node_element, set->element_compare_instance);
+      HLC_COUNT(&set->counters, lookup_comparisons);
+
+      if (ordering != 0) {
+        node = hlc_avl_link(node, ordering);
+      }
+
+      if (ordering != 0 && node != NULL) {
+        HLC_PREFETCH(node);
+        HLC_PREFETCH(hlc_avl_element(node, set->element_layout));
+      } else {
+        HLC_COUNT(&set->counters, lookups);
+        results[i] = ordering == 0;
+
+        if (next < count) {
+          slot_keys[j] = next;
+          node = set->root;
+          next += 1;
+        } else {
+          node = NULL;
+          active -= 1;
+        }
+      }
+
+      slot_nodes[j] = node;
+    }
+  }
+}
+
+
+const void* hlc_set_min(const hlc_Set* set) {
+  assert(set != NULL);
+  return set->leftmost != NULL ? hlc_avl_element(set->leftmost, set->element_layout) : NULL;
+}
+
+
+const void* hlc_set_max(const hlc_Set* set) {
+  assert(set != NULL);
+  return set->rightmost != NULL ? hlc_avl_element(set->rightmost, set->element_layout) : NULL;
+}
+
+
+/// @brief Removes the minimum/maximum, which is moved to element unless it's NULL.
+static bool hlc_set_pop(hlc_Set* set, signed char direction, void* element) {
+  hlc_AVL* node = direction < 0 ? set->leftmost : set->rightmost;
+
+  if (node == NULL)
+    return false;
+
+  void* node_element = hlc_avl_element(node, set->element_layout);
+  HLC_COUNT(&set->counters, removals);
+  HLC_TRACE_RECORD(HLC_TRACE_REMOVE, HLC_TRACE_SET, set->trace_id, node_element, set->element_layout.size);
+
+  hlc_Destroy_instance element_destroy_instance = set->element_destroy_instance;
+
+  if (element != NULL) {
+    memcpy(element, node_element, set->element_layout.size);
+    element_destroy_instance = hlc_no_destroy_instance;
+  }
+
+  hlc_set_xmost_before_removal(set, node);
+
+  HLC_COUNTERS_ENTER(&set->counters);
+  node = hlc_avl_remove(node, set->element_layout, element_destroy_instance);
+  HLC_COUNTERS_LEAVE();
+
+  if (node == NULL || hlc_avl_link(node, 0) == NULL) {
+    set->root = node;
+  }
+
+  set->count -= 1;
+  assert(set->count == hlc_avl_count(set->root));
+  return true;
+}
+
+
+bool hlc_set_pop_min(hlc_Set* set, void* element) {
+  assert(set != NULL);
+  return hlc_set_pop(set, -1, element);
+}
+
+
+bool hlc_set_pop_max(hlc_Set* set, void* element) {
+  assert(set != NULL);
+  return hlc_set_pop(set, +1, element);
+}
+
+
+/// @brief Searches for the first/last node whose element doesn't precede/follow a key.
+/// @param direction +1 for the first node not preceding the key, -1 for the last node not following it.
+/// @return The node, or NULL if there's none.
+static hlc_AVL* hlc_set_bound(hlc_Set* set, const void* key, signed char direction) {
+  hlc_AVL* node = set->root;
+  hlc_AVL* bound = NULL;
+
+  while (node != NULL) {
+    void* node_element = hlc_avl_element(node, set->element_layout);
+    signed char ordering = hlc_compare(key, node_element, set->element_compare_instance);
+    HLC_COUNT(&set->counters, removal_comparisons);
+
+    if (ordering == 0)
+      return node;
+
+    if (ordering == -direction) {
+      bound = node;
+    }
+
+    node = hlc_avl_link(node, ordering);
+  }
+
+  return bound;
+}
+
+
+size_t hlc_set_remove_range(hlc_Set* set, const void* lo, const void* hi) {
+  assert(set != NULL);
+  HLC_COUNT(&set->counters, removals);
+
+  hlc_AVL* first = hlc_set_bound(set, lo, +1);
+  hlc_AVL* last = hlc_set_bound(set, hi, -1);
+
+  if (first == NULL || last == NULL)
+    return 0;
+
+  if (first != last) {
+    const void* first_element = hlc_avl_element(first, set->element_layout);
+    const void* last_element = hlc_avl_element(last, set->element_layout);
+    HLC_COUNT(&set->counters, removal_comparisons);
+
+    if (hlc_compare(first_element, last_element, set->element_compare_instance) > 0)
+      return 0;
+  }
+
+  #ifdef HLC_TRACE
+    for (const hlc_AVL* node = first; node != hlc_avl_xcessor(last, +1); node = hlc_avl_xcessor(node, +1)) {
+      const void* node_element = hlc_avl_element(node, set->element_layout);
+      HLC_TRACE_RECORD(HLC_TRACE_REMOVE, HLC_TRACE_SET, set->trace_id, node_element, set->element_layout.size);
+    }
+  #endif
+
+  // Nodes outside of the range stay where they are in memory, so the minimum/maximum only changes if it's removed:
+
+  if (first == set->leftmost) {
+    set->leftmost = hlc_avl_xcessor(last, +1);
+  }
+
+  if (last == set->rightmost) {
+    set->rightmost = hlc_avl_xcessor(first, -1);
+  }
+
+  size_t removed_count;
+
+  HLC_COUNTERS_ENTER(&set->counters);
+  set->root = hlc_avl_remove_range(first, last, set->element_layout, set->element_destroy_instance, &removed_count);
+  HLC_COUNTERS_LEAVE();
+
+  set->count -= removed_count;
+  assert(set->count == hlc_avl_count(set->root));
+  return removed_count;
+}
+
+
 void hlc_set_clear(hlc_Set* set) {
   assert(set != NULL);
 
   hlc_set_destroy(set);
   set->root = NULL;
   set->count = 0;
+  set->leftmost = NULL;
+  set->rightmost = NULL;
 }
 
 
 void hlc_set_destroy(hlc_Set* set) {
   assert(set != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_DESTROY, HLC_TRACE_SET, set->trace_id, 0);
+
+  HLC_COUNTERS_ENTER(&set->counters);
   hlc_avl_delete(set->root, set->element_layout, set->element_destroy_instance);
+  HLC_COUNTERS_LEAVE();
 }
 
 
@@ -169,11 +512,121 @@ void hlc_set_move_reassign(hlc_Set* target, hlc_Set* source) {
   assert(target != NULL);
   assert(source != NULL);
 
+  HLC_COUNTERS_ENTER(&target->counters);
   hlc_avl_delete(target->root, target->element_layout, target->element_destroy_instance);
+  HLC_COUNTERS_LEAVE();
+
+  #ifdef HLC_TRACE
+    unsigned long trace_id = target->trace_id;
+  #endif
+
   *target = *source;
 
+  // Each container keeps its own identifier. The move is traced as a clone of the source into the target followed by a
+  // new, empty source, which leaves the same contents under each identifier.
+  #ifdef HLC_TRACE
+    target->trace_id = trace_id;
+  #endif
+
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CLONE, HLC_TRACE_SET, target->trace_id, source->trace_id);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CREATE, HLC_TRACE_SET, source->trace_id, 0);
+
   source->root = NULL;
   source->count = 0;
+  source->leftmost = NULL;
+  source->rightmost = NULL;
+}
+
+
+bool hlc_set_clone(const hlc_Set* set, hlc_Set* clone, hlc_Assign_instance element_assign_instance) {
+  assert(set != NULL);
+  assert(clone != NULL);
+
+  hlc_set_create(clone, set->element_layout, set->element_compare_instance, set->element_destroy_instance);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CLONE, HLC_TRACE_SET, clone->trace_id, set->trace_id);
+
+  HLC_COUNTERS_ENTER(&clone->counters);
+
+  bool success = hlc_avl_clone(
+    set->root,
+    &clone->root,
+    set->element_layout,
+    element_assign_instance,
+    set->element_destroy_instance
+  );
+
+  HLC_COUNTERS_LEAVE();
+
+  if (!success)
+    return false;
+
+  clone->count = set->count;
+
+  if (clone->root != NULL) {
+    clone->leftmost = hlc_avl_xmost(clone->root, -1);
+    clone->rightmost = hlc_avl_xmost(clone->root, +1);
+  }
+
+  return true;
+}
+
+
+bool hlc_set_parallel_clone(
+  const hlc_Set* set,
+  hlc_Set* clone,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Task_pool* pool
+) {
+  assert(set != NULL);
+  assert(clone != NULL);
+  assert(pool != NULL);
+
+  hlc_set_create(clone, set->element_layout, set->element_compare_instance, set->element_destroy_instance);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_CLONE, HLC_TRACE_SET, clone->trace_id, set->trace_id);
+
+  bool success = hlc_avl_parallel_clone(
+    set->root,
+    &clone->root,
+    set->element_layout,
+    element_assign_instance,
+    set->element_destroy_instance,
+    pool
+  );
+
+  if (!success)
+    return false;
+
+  clone->count = set->count;
+
+  if (clone->root != NULL) {
+    clone->leftmost = hlc_avl_xmost(clone->root, -1);
+    clone->rightmost = hlc_avl_xmost(clone->root, +1);
+  }
+
+  return true;
+}
+
+
+hlc_Counters hlc_set_counters(const hlc_Set* set) {
+  assert(set != NULL);
+
+  #ifdef HLC_COUNTERS
+    return hlc_counters_load(&set->counters);
+  #else
+    (void)set;
+    return (hlc_Counters){0};
+  #endif
+}
+
+
+void hlc_set_reset_counters(hlc_Set* set) {
+  assert(set != NULL);
+
+  #ifdef HLC_COUNTERS
+    hlc_counters_reset(&set->counters);
+  #else
+    (void)set;
+  #endif
 }
 
 
@@ -200,11 +653,101 @@ signed char hlc_set_compare(const hlc_Set* set1, const hlc_Set* set2, hlc_Compar
 }
 
 
+bool hlc_set_for_each(const hlc_Set* set, bool (*callback)(const void* element, void* context), void* context) {
+  assert(set != NULL);
+  assert(callback != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_SET, set->trace_id, 0);
+
+  return hlc_avl_for_each(set->root, set->element_layout, callback, context);
+}
+
+
+typedef struct hlc_Set_copy_context {
+  char* array;
+  size_t count;
+  hlc_Layout element_layout;
+  hlc_Assign_instance element_assign_instance;
+} hlc_Set_copy_context;
+
+
+static bool hlc_set_copy(const void* element, void* _context) {
+  hlc_Set_copy_context* context = _context;
+
+  assert(element != NULL);
+  assert(context != NULL);
+
+  void* target = context->array + context->count * context->element_layout.size;
+
+  if (hlc_assign_sized(target, element, context->element_layout.size, context->element_assign_instance)) {
+    context->count += 1;
+    return true;
+  } else {
+    return false;
+  }
+}
+
+
+bool hlc_set_copy_to_array(const hlc_Set* set, void* array, hlc_Assign_instance element_assign_instance) {
+  assert(set != NULL);
+  assert(array != NULL || set->count == 0);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_SET, set->trace_id, 0);
+
+  hlc_Set_copy_context copy_context = {
+    .array = array,
+    .count = 0,
+    .element_layout = set->element_layout,
+    .element_assign_instance = element_assign_instance,
+  };
+
+  if (hlc_avl_for_each(set->root, set->element_layout, hlc_set_copy, &copy_context))
+    return true;
+
+  for (size_t i = 0; i < copy_context.count; ++i) {
+    hlc_destroy(copy_context.array + i * set->element_layout.size, set->element_destroy_instance);
+  }
+
+  return false;
+}
+
+
+bool hlc_set_parallel_for_each(
+  const hlc_Set* set,
+  hlc_Task_pool* pool,
+  bool (*callback)(const void* element, void* context),
+  void* context
+) {
+  assert(set != NULL);
+  assert(pool != NULL);
+  assert(callback != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_SET, set->trace_id, 0);
+
+  return hlc_avl_parallel_for_each(set->root, set->element_layout, pool, callback, context);
+}
+
+
+bool hlc_set_parallel_reduce(
+  const hlc_Set* set,
+  hlc_Task_pool* pool,
+  void* accumulator,
+  hlc_Layout accumulator_layout,
+  hlc_Reduce_instance reduce_instance
+) {
+  assert(set != NULL);
+  assert(pool != NULL);
+  assert(accumulator != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_SET, set->trace_id, 0);
+
+  hlc_Layout element_layout = set->element_layout;
+  return hlc_avl_parallel_reduce(set->root, element_layout, pool, accumulator, accumulator_layout, reduce_instance);
+}
+
+
 void hlc_set_iterator(const hlc_Set* set, hlc_Set_iterator* iterator) {
   assert(set != NULL);
   assert(iterator != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_SET, set->trace_id, 0);
 
-  iterator->current = set->root != NULL ? hlc_avl_xmost(set->root, -1) : NULL;
+  iterator->current = set->leftmost;
   iterator->element_layout = set->element_layout;
 }
 
@@ -220,3 +763,117 @@ const void* hlc_set_iterator_next(hlc_Set_iterator* iterator) {
     return NULL;
   }
 }
+
+
+bool hlc_set_freeze(const hlc_Set* set, hlc_Frozen_set* frozen, hlc_Assign_instance element_assign_instance) {
+  assert(set != NULL);
+  assert(frozen != NULL);
+  HLC_TRACE_RECORD_NUMBER(HLC_TRACE_ITERATE, HLC_TRACE_SET, set->trace_id, 0);
+
+  hlc_Layout element_layout = set->element_layout;
+  hlc_layout_pad(&element_layout);
+
+  frozen->elements = NULL;
+  frozen->count = set->count;
+  frozen->element_layout = element_layout;
+  frozen->element_compare_instance = set->element_compare_instance;
+  frozen->element_destroy_instance = set->element_destroy_instance;
+
+  if (set->count == 0)
+    return true;
+
+  // Zero-sized elements still take a byte, so that the iterator finds them at a valid address:
+  frozen->elements = malloc(HLC_MAX(set->count * element_layout.size, 1));
+
+  if (frozen->elements == NULL)
+    return false;
+
+  // Visiting the Eytzinger indices in-order while walking the tree in-order places each element where it belongs:
+
+  hlc_Set_iterator iterator;
+  hlc_set_iterator(set, &iterator);
+
+  size_t index = hlc_eytzinger_first(set->count);
+
+  while (index != 0) {
+    const void* element = hlc_set_iterator_next(&iterator);
+    assert(element != NULL);
+
+    void* target = frozen->elements + (index - 1) * element_layout.size;
+
+    if (!hlc_assign_sized(target, element, set->element_layout.size, element_assign_instance)) {
+      for (size_t i = hlc_eytzinger_first(set->count); i != index; i = hlc_eytzinger_next(i, set->count)) {
+        hlc_destroy(frozen->elements + (i - 1) * element_layout.size, set->element_destroy_instance);
+      }
+
+      free(frozen->elements);
+      frozen->elements = NULL;
+      frozen->count = 0;
+      return false;
+    }
+
+    index = hlc_eytzinger_next(index, set->count);
+  }
+
+  return true;
+}
+
+
+size_t hlc_frozen_set_count(const hlc_Frozen_set* frozen) {
+  assert(frozen != NULL);
+  return frozen->count;
+}
+
+
+bool hlc_frozen_set_contains(const hlc_Frozen_set* frozen, const void* key) {
+  assert(frozen != NULL);
+
+  size_t index = hlc_eytzinger_search(
+    frozen->elements,
+    frozen->count,
+    frozen->element_layout,
+    key,
+    frozen->element_compare_instance
+  );
+
+  if (index == 0)
+    return false;
+
+  const void* element = frozen->elements + (index - 1) * frozen->element_layout.size;
+  return hlc_compare(key, element, frozen->element_compare_instance) == 0;
+}
+
+
+void hlc_frozen_set_destroy(hlc_Frozen_set* frozen) {
+  assert(frozen != NULL);
+
+  for (size_t i = 0; i < frozen->count; ++i) {
+    hlc_destroy(frozen->elements + i * frozen->element_layout.size, frozen->element_destroy_instance);
+  }
+
+  free(frozen->elements);
+}
+
+
+void hlc_frozen_set_iterator(const hlc_Frozen_set* frozen, hlc_Frozen_set_iterator* iterator) {
+  assert(frozen != NULL);
+  assert(iterator != NULL);
+
+  iterator->elements = frozen->elements;
+  iterator->count = frozen->count;
+  iterator->current = hlc_eytzinger_first(frozen->count);
+  iterator->element_size = frozen->element_layout.size;
+}
+
+
+const void* hlc_frozen_set_iterator_next(hlc_Frozen_set_iterator* iterator) {
+  assert(iterator != NULL);
+
+  if (iterator->current != 0) {
+    const void* element = iterator->elements + (iterator->current - 1) * iterator->element_size;
+    iterator->current = hlc_eytzinger_next(iterator->current, iterator->count);
+    return element;
+  } else {
+    return NULL;
+  }
+}
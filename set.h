@@ -6,10 +6,13 @@
 #include <stdio.h>
 
 #include "api.h"
+#include "counters.h"
 #include "layout.h"
+#include "task.h"
 #include "traits/assign.h"
 #include "traits/compare.h"
 #include "traits/destroy.h"
+#include "traits/reduce.h"
 
 HLC_DECLARATIONS_BEGIN
 
@@ -24,6 +27,44 @@ typedef struct hlc_Set_iterator hlc_Set_iterator;
 /// @memberof hlc_Set_iterator
 extern HLC_API const hlc_Layout hlc_set_iterator_layout;
 
+/// @brief A read-only set stored contiguously in Eytzinger (breadth-first) order.
+typedef struct hlc_Frozen_set hlc_Frozen_set;
+
+/// @memberof hlc_Frozen_set
+extern HLC_API const hlc_Layout hlc_frozen_set_layout;
+
+/// @relates hlc_Frozen_set
+typedef struct hlc_Frozen_set_iterator hlc_Frozen_set_iterator;
+
+/// @memberof hlc_Frozen_set_iterator
+extern HLC_API const hlc_Layout hlc_frozen_set_iterator_layout;
+
+/// @relates hlc_Set
+/// @brief Memory usage and shape of a set.
+typedef struct hlc_Set_stats {
+  /// @brief The number of elements, and thus of nodes.
+  size_t count;
+
+  /// @brief The size of a node, including its header, the element and padding.
+  size_t node_size;
+
+  /// @brief The size of an element.
+  size_t element_size;
+
+  /// @brief The memory taken by all nodes, not counting allocator overhead.
+  size_t total_size;
+
+  /// @brief The fraction of each node not taken by the element: (node_size - element_size) / node_size.
+  double overhead;
+
+  /// @brief The height of the tree.
+  size_t height;
+
+  /// @brief The average number of nodes from the root to a node, that is, the average number of comparisons done by
+  /// a successful search.
+  double average_depth;
+} hlc_Set_stats;
+
 /// @memberof hlc_Set
 /// @brief Creates an empty set.
 /// @pre set != NULL
@@ -39,6 +80,12 @@ HLC_API void hlc_set_create(
 /// @pre set != NULL
 HLC_API size_t hlc_set_count(const hlc_Set* set);
 
+/// @memberof hlc_Set
+/// @brief Computes memory usage and shape statistics of this set.
+/// @details Takes time proportional to the number of elements, because of average_depth.
+/// @pre set != NULL
+HLC_API hlc_Set_stats hlc_set_stats(const hlc_Set* set);
+
 /// @memberof hlc_Set
 /// @brief Inserts an element into this set.
 /// @return true on success, false on insufficient memory.
@@ -56,6 +103,48 @@ HLC_API bool hlc_set_remove(hlc_Set* set, const void* element);
 /// @pre set != NULL
 HLC_API bool hlc_set_contains(const hlc_Set* set, const void* key);
 
+/// @memberof hlc_Set
+/// @brief Checks if this set contains each of the given keys. The results match those of repeated hlc_set_contains.
+/// @details Several searches are advanced in lockstep, so that the memory accesses of each can overlap.
+/// @param keys An array of count keys, each taking element_layout.size bytes.
+/// @param results An array of count booleans, receiving the results.
+/// @pre set != NULL && (count == 0 || (keys != NULL && results != NULL))
+HLC_API void hlc_set_contains_batch(const hlc_Set* set, const void* keys, size_t count, bool* results);
+
+/// @memberof hlc_Set
+/// @brief Returns the minimum of this set, in O(1).
+/// @return The minimum, or NULL if this set is empty.
+/// @pre set != NULL
+HLC_API const void* hlc_set_min(const hlc_Set* set);
+
+/// @memberof hlc_Set
+/// @brief Returns the maximum of this set, in O(1).
+/// @return The maximum, or NULL if this set is empty.
+/// @pre set != NULL
+HLC_API const void* hlc_set_max(const hlc_Set* set);
+
+/// @memberof hlc_Set
+/// @brief Removes the minimum of this set, without searching for it.
+/// @param element Receives the minimum, which is then moved out of this set rather than destroyed, unless it's NULL.
+/// @return true on success, false if this set is empty.
+/// @pre set != NULL
+HLC_API bool hlc_set_pop_min(hlc_Set* set, void* element);
+
+/// @memberof hlc_Set
+/// @brief Removes the maximum of this set, without searching for it.
+/// @param element Receives the maximum, which is then moved out of this set rather than destroyed, unless it's NULL.
+/// @return true on success, false if this set is empty.
+/// @pre set != NULL
+HLC_API bool hlc_set_pop_max(hlc_Set* set, void* element);
+
+/// @memberof hlc_Set
+/// @brief Removes the elements from lo to hi, inclusive, without searching for each of them.
+/// @details Two descents find the ends of the range, which is then cut out of the tree as a whole, so that this takes
+/// O(log n + k) time to remove k elements.
+/// @return The number of removed elements, which is 0 if lo follows hi.
+/// @pre set != NULL
+HLC_API size_t hlc_set_remove_range(hlc_Set* set, const void* lo, const void* hi);
+
 /// @memberof hlc_Set
 /// @brief Clears this set.
 /// @pre set != NULL
@@ -70,11 +159,79 @@ HLC_API void hlc_set_destroy(hlc_Set* set);
 /// @pre target != NULL && source != NULL
 HLC_API void hlc_set_move_reassign(hlc_Set* target, hlc_Set* source);
 
+/// @memberof hlc_Set
+/// @brief Creates a copy of this set with the same tree shape, without any comparison or rebalancing.
+/// @return true on success, false on insufficient memory.
+/// @pre set != NULL && clone != NULL
+HLC_API bool hlc_set_clone(const hlc_Set* set, hlc_Set* clone, hlc_Assign_instance element_assign_instance);
+
+/// @memberof hlc_Set
+/// @brief Creates a copy of this set with the same tree shape, copying sibling subtrees in parallel.
+/// @details The assign instance may be called concurrently from several threads.
+/// @return true on success, false on insufficient memory.
+/// @pre set != NULL && clone != NULL && pool != NULL
+HLC_API bool hlc_set_parallel_clone(
+  const hlc_Set* set,
+  hlc_Set* clone,
+  hlc_Assign_instance element_assign_instance,
+  hlc_Task_pool* pool
+);
+
+/// @memberof hlc_Set
+/// @brief Returns the operations counted for this set. All counters are zero unless HLC_COUNTERS is defined.
+/// @pre set != NULL
+HLC_API hlc_Counters hlc_set_counters(const hlc_Set* set);
+
+/// @memberof hlc_Set
+/// @brief Resets the operations counted for this set.
+/// @pre set != NULL
+HLC_API void hlc_set_reset_counters(hlc_Set* set);
+
 /// @brief hlc_Set
 /// @brief Compares two sets.
 /// @pre set1 != NULL && set2 != NULL
 HLC_API signed char hlc_set_compare(const hlc_Set* set1, const hlc_Set* set2, hlc_Compare_instance compare_instance);
 
+/// @memberof hlc_Set
+/// @brief Calls the callback on each element of this set in order, until the callback returns false.
+/// @details Faster than a hlc_Set_iterator when the whole set is scanned.
+/// @return true if all elements were visited, false if the callback stopped the iteration.
+/// @pre set != NULL && callback != NULL
+HLC_API bool hlc_set_for_each(const hlc_Set* set, bool (*callback)(const void* element, void* context), void* context);
+
+/// @memberof hlc_Set
+/// @brief Copies the elements of this set, in order, to an array.
+/// @param array An array of hlc_set_count(set) elements, each taking element_layout.size bytes.
+/// @return true on success, false on insufficient memory (in which case no element is left in the array).
+/// @pre set != NULL && (array != NULL || hlc_set_count(set) == 0)
+HLC_API bool hlc_set_copy_to_array(const hlc_Set* set, void* array, hlc_Assign_instance element_assign_instance);
+
+/// @memberof hlc_Set
+/// @brief Calls the callback on each element of this set, in parallel and in no particular order.
+/// @details The callback may be called concurrently from several threads. Once it returns false, no new calls start.
+/// @return true if all elements were visited, false if the callback stopped the iteration.
+/// @pre set != NULL && pool != NULL && callback != NULL
+HLC_API bool hlc_set_parallel_for_each(
+  const hlc_Set* set,
+  hlc_Task_pool* pool,
+  bool (*callback)(const void* element, void* context),
+  void* context
+);
+
+/// @memberof hlc_Set
+/// @brief Reduces the elements of this set in parallel. Partial results are combined in element order, and the way
+/// the set is split doesn't depend on the number of threads.
+/// @param accumulator Uninitialized memory for an accumulator, which receives the result.
+/// @return true on success, false if the accumulator couldn't be initialized.
+/// @pre set != NULL && pool != NULL && accumulator != NULL
+HLC_API bool hlc_set_parallel_reduce(
+  const hlc_Set* set,
+  hlc_Task_pool* pool,
+  void* accumulator,
+  hlc_Layout accumulator_layout,
+  hlc_Reduce_instance reduce_instance
+);
+
 /// @memberof hlc_Set
 /// @relates hlc_Set_iterator
 /// @brief Creates an iterator for this set.
@@ -87,6 +244,40 @@ HLC_API void hlc_set_iterator(const hlc_Set* set, hlc_Set_iterator* iterator);
 /// @pre iterator != NULL
 HLC_API const void* hlc_set_iterator_next(hlc_Set_iterator* iterator);
 
+/// @memberof hlc_Set
+/// @relates hlc_Frozen_set
+/// @brief Creates a frozen copy of this set. The set itself is left unchanged.
+/// @return true on success, false on insufficient memory.
+/// @pre set != NULL && frozen != NULL
+HLC_API bool hlc_set_freeze(const hlc_Set* set, hlc_Frozen_set* frozen, hlc_Assign_instance element_assign_instance);
+
+/// @memberof hlc_Frozen_set
+/// @brief Returns the number of elements in this frozen set.
+/// @pre frozen != NULL
+HLC_API size_t hlc_frozen_set_count(const hlc_Frozen_set* frozen);
+
+/// @memberof hlc_Frozen_set
+/// @brief Checks if this frozen set contains the given key.
+/// @pre frozen != NULL
+HLC_API bool hlc_frozen_set_contains(const hlc_Frozen_set* frozen, const void* key);
+
+/// @memberof hlc_Frozen_set
+/// @brief Destroys this frozen set.
+/// @pre frozen != NULL
+HLC_API void hlc_frozen_set_destroy(hlc_Frozen_set* frozen);
+
+/// @memberof hlc_Frozen_set
+/// @relates hlc_Frozen_set_iterator
+/// @brief Creates an iterator for this frozen set.
+/// @pre frozen != NULL && iterator != NULL
+HLC_API void hlc_frozen_set_iterator(const hlc_Frozen_set* frozen, hlc_Frozen_set_iterator* iterator);
+
+/// @memberof hlc_Frozen_set_iterator
+/// @brief Returns the current element and advances the iterator.
+/// @return The current element, or NULL if the last element of the frozen set was reached.
+/// @pre iterator != NULL
+HLC_API const void* hlc_frozen_set_iterator_next(hlc_Frozen_set_iterator* iterator);
+
 HLC_DECLARATIONS_END
 
 #endif
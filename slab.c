@@ -0,0 +1,103 @@
+#include "slab.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "layout.h"
+#include "math.h"
+
+
+/// @brief The number of slots in the first block.
+#define HLC_SLAB_MIN_CAPACITY 8
+
+/// @brief The size above which blocks stop growing. Blocks of large slots stay at HLC_SLAB_MIN_CAPACITY slots.
+#define HLC_SLAB_MAX_BLOCK_SIZE 65536
+
+
+void hlc_slab_create(hlc_Slab* slab, hlc_Layout layout) {
+  assert(slab != NULL);
+  assert(layout.alignment <= alignof(max_align_t));
+
+  // Free slots hold the link to the next free slot, so slots must be able to hold a pointer.
+
+  hlc_Layout slot_layout = {
+    .size = HLC_MAX(layout.size, sizeof(void*)),
+    .alignment = HLC_MAX(layout.alignment, alignof(void*)),
+  };
+
+  hlc_layout_pad(&slot_layout);
+
+  hlc_Layout block_header_layout = HLC_LAYOUT_OF(void*);
+
+  slab->blocks = NULL;
+  slab->free_slots = NULL;
+  slab->next_slot = NULL;
+  slab->end = NULL;
+  slab->slot_layout = slot_layout;
+  slab->slot_offset = hlc_layout_add(&block_header_layout, slot_layout);
+  slab->block_capacity = HLC_SLAB_MIN_CAPACITY;
+  slab->reserved = 0;
+}
+
+
+void* hlc_slab_allocate(hlc_Slab* slab) {
+  assert(slab != NULL);
+
+  if (slab->free_slots != NULL) {
+    void* slot = slab->free_slots;
+    slab->free_slots = *(void**)slot;
+    return slot;
+  }
+
+  if (slab->next_slot == slab->end) {
+    size_t block_size = slab->slot_offset + slab->block_capacity * slab->slot_layout.size;
+    void* block = malloc(block_size);
+
+    if (block == NULL)
+      return NULL;
+
+    *(void**)block = slab->blocks;
+    slab->blocks = block;
+    slab->next_slot = (char*)block + slab->slot_offset;
+    slab->end = (char*)block + block_size;
+    slab->reserved += block_size;
+
+    if (slab->block_capacity * slab->slot_layout.size * 2 <= HLC_SLAB_MAX_BLOCK_SIZE) {
+      slab->block_capacity *= 2;
+    }
+  }
+
+  void* slot = slab->next_slot;
+  slab->next_slot += slab->slot_layout.size;
+  return slot;
+}
+
+
+void hlc_slab_free(hlc_Slab* slab, void* slot) {
+  assert(slab != NULL);
+  assert(slot != NULL);
+
+  *(void**)slot = slab->free_slots;
+  slab->free_slots = slot;
+}
+
+
+size_t hlc_slab_reserved(const hlc_Slab* slab) {
+  assert(slab != NULL);
+  return slab->reserved;
+}
+
+
+void hlc_slab_destroy(hlc_Slab* slab) {
+  assert(slab != NULL);
+
+  void* block = slab->blocks;
+
+  while (block != NULL) {
+    void* previous = *(void**)block;
+    free(block);
+    block = previous;
+  }
+}
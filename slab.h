@@ -0,0 +1,62 @@
+#ifndef HLC_SLAB_H
+#define HLC_SLAB_H
+
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief An allocator of fixed-size slots, carved out of larger blocks. Freed slots are kept in a free list and
+/// reused by later allocations, and blocks are only returned to the system when the allocator is destroyed.
+/// @details Blocks double in size, from 8 slots up to about 64 KB, so that small allocators stay small while large
+/// ones make few calls to malloc. Slots of consecutive allocations are adjacent in memory until slots get freed.
+/// The slab allocator is a helper of the containers, which embed it, rather than part of the library's interface: its
+/// functions aren't exported.
+typedef struct hlc_Slab {
+  /// @brief The most recently allocated block, whose first bytes link to the previous one.
+  void* blocks;
+
+  /// @brief The first free slot, whose first bytes link to the next one.
+  void* free_slots;
+
+  /// @brief The next slot of the current block which was never allocated, and the end of that block.
+  char* next_slot;
+  char* end;
+
+  hlc_Layout slot_layout;
+  size_t slot_offset;
+  size_t block_capacity;
+  size_t reserved;
+} hlc_Slab;
+
+/// @memberof hlc_Slab
+/// @brief Creates an empty slab allocator, for slots of the given layout.
+/// @pre slab != NULL && layout.alignment <= alignof(max_align_t)
+void hlc_slab_create(hlc_Slab* slab, hlc_Layout layout);
+
+/// @memberof hlc_Slab
+/// @brief Allocates an uninitialized slot.
+/// @return The slot on success, or NULL on insufficient memory.
+/// @pre slab != NULL
+void* hlc_slab_allocate(hlc_Slab* slab);
+
+/// @memberof hlc_Slab
+/// @brief Frees a slot, which must have been allocated by this allocator.
+/// @pre slab != NULL && slot != NULL
+void hlc_slab_free(hlc_Slab* slab, void* slot);
+
+/// @memberof hlc_Slab
+/// @brief Returns the number of bytes this allocator took from the system, including free slots.
+/// @pre slab != NULL
+size_t hlc_slab_reserved(const hlc_Slab* slab);
+
+/// @memberof hlc_Slab
+/// @brief Destroys this allocator, freeing all its slots at once. The slots themselves aren't destroyed.
+/// @pre slab != NULL
+void hlc_slab_destroy(hlc_Slab* slab);
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -0,0 +1,347 @@
+#include "task.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#ifdef __has_include
+  #if __has_include(<unistd.h>)
+    #include <unistd.h>
+  #elif __has_include(<windows.h>)
+    #include <windows.h>
+  #endif
+#endif
+
+#include "layout.h"
+
+
+/// @brief The maximum number of pending jobs per worker. Joins beyond this depth run their tasks sequentially.
+#define HLC_TASK_DEQUE_CAPACITY 256
+
+
+typedef struct hlc_Task_job {
+  void (*task)(hlc_Task_worker* worker, void* context);
+  void* context;
+  atomic_bool done;
+} hlc_Task_job;
+
+
+struct hlc_Task_worker {
+  hlc_Task_pool* pool;
+  unsigned long seed;
+  thrd_t thread;
+
+  // The owner pushes and pops jobs at the bottom of its deque, while thieves take the oldest ones from the top. Jobs
+  // forked early are the ones representing the most work, so stealing those keeps the number of steals low.
+
+  mtx_t mutex;
+  size_t top;
+  size_t bottom;
+  hlc_Task_job* jobs[HLC_TASK_DEQUE_CAPACITY];
+};
+
+
+struct hlc_Task_pool {
+  hlc_Task_worker* workers;
+  size_t thread_count;
+
+  mtx_t mutex;
+  cnd_t condition;
+  atomic_bool running;
+  bool stopping;
+};
+
+const hlc_Layout hlc_task_pool_layout = {.size = sizeof(hlc_Task_pool), .alignment = alignof(hlc_Task_pool)};
+
+
+static size_t hlc_task_processor_count(void) {
+  #if defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+  #elif defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+  #else
+    return 1;
+  #endif
+}
+
+
+static bool hlc_task_worker_push(hlc_Task_worker* worker, hlc_Task_job* job) {
+  mtx_lock(&worker->mutex);
+
+  bool pushed = worker->bottom < HLC_TASK_DEQUE_CAPACITY;
+
+  if (pushed) {
+    worker->jobs[worker->bottom++] = job;
+  }
+
+  mtx_unlock(&worker->mutex);
+  return pushed;
+}
+
+
+static hlc_Task_job* hlc_task_worker_pop(hlc_Task_worker* worker) {
+  mtx_lock(&worker->mutex);
+
+  hlc_Task_job* job = NULL;
+
+  if (worker->bottom > worker->top) {
+    job = worker->jobs[--worker->bottom];
+  }
+
+  if (worker->bottom == worker->top) {
+    worker->top = 0;
+    worker->bottom = 0;
+  }
+
+  mtx_unlock(&worker->mutex);
+  return job;
+}
+
+
+static hlc_Task_job* hlc_task_worker_steal_from(hlc_Task_worker* victim) {
+  mtx_lock(&victim->mutex);
+
+  hlc_Task_job* job = NULL;
+
+  if (victim->bottom > victim->top) {
+    job = victim->jobs[victim->top++];
+  }
+
+  if (victim->bottom == victim->top) {
+    victim->top = 0;
+    victim->bottom = 0;
+  }
+
+  mtx_unlock(&victim->mutex);
+  return job;
+}
+
+
+/// @brief Steals a job from another worker, starting from a random victim, and runs it.
+/// @return true if a job was run, false if no other worker had pending jobs.
+static bool hlc_task_worker_steal(hlc_Task_worker* worker) {
+  hlc_Task_pool* pool = worker->pool;
+
+  worker->seed = worker->seed * 1103515245 + 12345;
+  size_t start = (size_t)(worker->seed >> 16) % pool->thread_count;
+
+  for (size_t i = 0; i < pool->thread_count; ++i) {
+    hlc_Task_worker* victim = &pool->workers[(start + i) % pool->thread_count];
+
+    if (victim == worker)
+      continue;
+
+    hlc_Task_job* job = hlc_task_worker_steal_from(victim);
+
+    if (job != NULL) {
+      job->task(worker, job->context);
+
+      // The job lives on the stack of the joining worker, which may return as soon as it sees it done: it must not be
+      // touched afterwards.
+      atomic_store_explicit(&job->done, true, memory_order_release);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+static int hlc_task_worker_main(void* _worker) {
+  hlc_Task_worker* worker = _worker;
+  hlc_Task_pool* pool = worker->pool;
+
+  while (true) {
+    mtx_lock(&pool->mutex);
+
+    while (!atomic_load(&pool->running) && !pool->stopping) {
+      cnd_wait(&pool->condition, &pool->mutex);
+    }
+
+    bool stopping = pool->stopping;
+    mtx_unlock(&pool->mutex);
+
+    if (stopping)
+      return 0;
+
+    while (atomic_load_explicit(&pool->running, memory_order_acquire)) {
+      if (!hlc_task_worker_steal(worker)) {
+        thrd_yield();
+      }
+    }
+  }
+}
+
+
+bool hlc_task_pool_create(hlc_Task_pool* pool, size_t thread_count) {
+  assert(pool != NULL);
+
+  if (thread_count == 0) {
+    thread_count = hlc_task_processor_count();
+  }
+
+  pool->workers = malloc(sizeof(hlc_Task_worker) * thread_count);
+  pool->thread_count = thread_count;
+  atomic_init(&pool->running, false);
+  pool->stopping = false;
+
+  if (pool->workers == NULL)
+    return false;
+
+  if (mtx_init(&pool->mutex, mtx_plain) != thrd_success) {
+    free(pool->workers);
+    pool->workers = NULL;
+    return false;
+  }
+
+  if (cnd_init(&pool->condition) != thrd_success) {
+    mtx_destroy(&pool->mutex);
+    free(pool->workers);
+    pool->workers = NULL;
+    return false;
+  }
+
+  size_t initialized = 0;
+  size_t started = 1;
+
+  for (; initialized < thread_count; ++initialized) {
+    hlc_Task_worker* worker = &pool->workers[initialized];
+    worker->pool = pool;
+    worker->seed = (unsigned long)initialized * 2654435761UL + 1;
+    worker->top = 0;
+    worker->bottom = 0;
+
+    if (mtx_init(&worker->mutex, mtx_plain) != thrd_success)
+      break;
+  }
+
+  // Worker 0 has no thread of its own: it stands for the thread calling hlc_task_pool_run.
+
+  if (initialized == thread_count) {
+    for (; started < thread_count; ++started) {
+      hlc_Task_worker* worker = &pool->workers[started];
+
+      if (thrd_create(&worker->thread, hlc_task_worker_main, worker) != thrd_success)
+        break;
+    }
+
+    if (started == thread_count)
+      return true;
+  }
+
+  mtx_lock(&pool->mutex);
+  pool->stopping = true;
+  cnd_broadcast(&pool->condition);
+  mtx_unlock(&pool->mutex);
+
+  for (size_t i = 1; i < started; ++i) {
+    thrd_join(pool->workers[i].thread, NULL);
+  }
+
+  for (size_t i = 0; i < initialized; ++i) {
+    mtx_destroy(&pool->workers[i].mutex);
+  }
+
+  cnd_destroy(&pool->condition);
+  mtx_destroy(&pool->mutex);
+  free(pool->workers);
+  pool->workers = NULL;
+  return false;
+}
+
+
+size_t hlc_task_pool_thread_count(const hlc_Task_pool* pool) {
+  assert(pool != NULL);
+  return pool->thread_count;
+}
+
+
+void hlc_task_pool_run(hlc_Task_pool* pool, void (*task)(hlc_Task_worker* worker, void* context), void* context) {
+  assert(pool != NULL);
+  assert(task != NULL);
+
+  mtx_lock(&pool->mutex);
+  assert(!atomic_load(&pool->running));
+  atomic_store(&pool->running, true);
+  cnd_broadcast(&pool->condition);
+  mtx_unlock(&pool->mutex);
+
+  task(&pool->workers[0], context);
+
+  // Every join waits for both of its tasks, so once the root task returns no job is pending anymore:
+
+  atomic_store_explicit(&pool->running, false, memory_order_release);
+}
+
+
+void hlc_task_pool_destroy(hlc_Task_pool* pool) {
+  assert(pool != NULL);
+  assert(pool->workers != NULL);
+
+  mtx_lock(&pool->mutex);
+  pool->stopping = true;
+  cnd_broadcast(&pool->condition);
+  mtx_unlock(&pool->mutex);
+
+  for (size_t i = 1; i < pool->thread_count; ++i) {
+    thrd_join(pool->workers[i].thread, NULL);
+  }
+
+  for (size_t i = 0; i < pool->thread_count; ++i) {
+    mtx_destroy(&pool->workers[i].mutex);
+  }
+
+  cnd_destroy(&pool->condition);
+  mtx_destroy(&pool->mutex);
+  free(pool->workers);
+  pool->workers = NULL;
+}
+
+
+void hlc_task_join(
+  hlc_Task_worker* worker,
+  void (*task1)(hlc_Task_worker* worker, void* context),
+  void* context1,
+  void (*task2)(hlc_Task_worker* worker, void* context),
+  void* context2
+) {
+  assert(worker != NULL);
+  assert(task1 != NULL);
+  assert(task2 != NULL);
+
+  hlc_Task_job job2 = {.task = task2, .context = context2};
+  atomic_init(&job2.done, false);
+
+  if (!hlc_task_worker_push(worker, &job2)) {
+    task1(worker, context1);
+    task2(worker, context2);
+    return;
+  }
+
+  task1(worker, context1);
+
+  // Nested joins pop everything they push, so if the second job wasn't stolen, it's still at the bottom:
+
+  hlc_Task_job* job = hlc_task_worker_pop(worker);
+
+  if (job != NULL) {
+    assert(job == &job2);
+    task2(worker, context2);
+    return;
+  }
+
+  // The second job was stolen: help with other pending jobs until the thief is done with it.
+
+  while (!atomic_load_explicit(&job2.done, memory_order_acquire)) {
+    if (!hlc_task_worker_steal(worker)) {
+      thrd_yield();
+    }
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef HLC_TASK_H
+#define HLC_TASK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+#include "layout.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief A fixed set of worker threads executing fork/join tasks, balanced by work stealing.
+typedef struct hlc_Task_pool hlc_Task_pool;
+
+/// @memberof hlc_Task_pool
+extern HLC_API const hlc_Layout hlc_task_pool_layout;
+
+/// @relates hlc_Task_pool
+/// @brief The worker executing a task. Tasks may only fork through the worker which is executing them.
+typedef struct hlc_Task_worker hlc_Task_worker;
+
+/// @memberof hlc_Task_pool
+/// @brief Creates a task pool.
+/// @param thread_count The number of workers, including the thread calling hlc_task_pool_run, or 0 to use one worker
+/// per processor.
+/// @return true on success, false on insufficient resources.
+/// @pre pool != NULL
+HLC_API bool hlc_task_pool_create(hlc_Task_pool* pool, size_t thread_count);
+
+/// @memberof hlc_Task_pool
+/// @brief Returns the number of workers of this pool, including the thread calling hlc_task_pool_run.
+/// @pre pool != NULL
+HLC_API size_t hlc_task_pool_thread_count(const hlc_Task_pool* pool);
+
+/// @memberof hlc_Task_pool
+/// @brief Runs a task on this pool, and waits for it and all the tasks it forked to complete.
+/// @details The calling thread takes part in the execution. Only one thread at a time may run tasks on a pool.
+/// @pre pool != NULL && task != NULL
+HLC_API void hlc_task_pool_run(
+  hlc_Task_pool* pool,
+  void (*task)(hlc_Task_worker* worker, void* context),
+  void* context
+);
+
+/// @memberof hlc_Task_pool
+/// @brief Destroys this task pool, stopping its threads.
+/// @pre pool != NULL
+HLC_API void hlc_task_pool_destroy(hlc_Task_pool* pool);
+
+/// @memberof hlc_Task_worker
+/// @brief Runs two tasks, potentially in parallel, and waits for both to complete.
+/// @details The first task runs on the calling worker, while the second is made available for idle workers to steal.
+/// If no worker steals it by the time the first task completes, the calling worker runs it as well.
+/// @pre worker != NULL && task1 != NULL && task2 != NULL
+HLC_API void hlc_task_join(
+  hlc_Task_worker* worker,
+  void (*task1)(hlc_Task_worker* worker, void* context),
+  void* context1,
+  void (*task2)(hlc_Task_worker* worker, void* context),
+  void* context2
+);
+
+HLC_DECLARATIONS_END
+
+#endif
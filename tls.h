@@ -0,0 +1,10 @@
+#ifndef HLC_TLS_H
+#define HLC_TLS_H
+
+#if defined(_MSC_VER) && !defined(__clang__)
+  #define HLC_THREAD_LOCAL __declspec(thread)
+#else
+  #define HLC_THREAD_LOCAL _Thread_local
+#endif
+
+#endif
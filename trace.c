@@ -0,0 +1,238 @@
+#include "trace.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HLC_TRACE
+  #include <stdatomic.h>
+  #include <threads.h>
+#endif
+
+
+static const unsigned char hlc_trace_magic[8] = {'H', 'L', 'C', 'T', 'R', 'A', 'C', 'E'};
+
+
+static unsigned long hlc_trace_decode_u32(const unsigned char* bytes) {
+  unsigned long value = 0;
+
+  for (size_t i = 0; i < 4; ++i) {
+    value |= (unsigned long)bytes[i] << (8 * i);
+  }
+
+  return value;
+}
+
+
+static unsigned long long hlc_trace_decode_u64(const unsigned char* bytes) {
+  unsigned long long value = 0;
+
+  for (size_t i = 0; i < 8; ++i) {
+    value |= (unsigned long long)bytes[i] << (8 * i);
+  }
+
+  return value;
+}
+
+
+bool hlc_trace_decode_header(const unsigned char bytes[HLC_TRACE_HEADER_SIZE]) {
+  assert(bytes != NULL);
+  return memcmp(bytes, hlc_trace_magic, sizeof(hlc_trace_magic)) == 0
+    && hlc_trace_decode_u32(bytes + 8) == HLC_TRACE_VERSION;
+}
+
+
+bool hlc_trace_decode_record(const unsigned char bytes[HLC_TRACE_RECORD_SIZE], hlc_Trace_record* record) {
+  assert(bytes != NULL);
+  assert(record != NULL);
+
+  if (bytes[0] < HLC_TRACE_CREATE || bytes[0] > HLC_TRACE_ITERATE)
+    return false;
+
+  if (bytes[1] < HLC_TRACE_SET || bytes[1] > HLC_TRACE_MAP)
+    return false;
+
+  record->operation = (hlc_Trace_operation)bytes[0];
+  record->container = (hlc_Trace_container)bytes[1];
+  record->container_id = hlc_trace_decode_u32(bytes + 4);
+  record->key = hlc_trace_decode_u64(bytes + 8);
+  return true;
+}
+
+
+#ifdef HLC_TRACE
+  static void hlc_trace_encode_u32(unsigned char* bytes, unsigned long value) {
+    for (size_t i = 0; i < 4; ++i) {
+      bytes[i] = (unsigned char)(value >> (8 * i));
+    }
+  }
+
+
+  static void hlc_trace_encode_u64(unsigned char* bytes, unsigned long long value) {
+    for (size_t i = 0; i < 8; ++i) {
+      bytes[i] = (unsigned char)(value >> (8 * i));
+    }
+  }
+
+
+  static once_flag hlc_trace_once = ONCE_FLAG_INIT;
+  static mtx_t hlc_trace_mutex;
+  static bool hlc_trace_mutex_ok;
+
+  // Operations check whether a trace is being recorded without taking the mutex, so that untraced runs pay a single
+  // relaxed load per operation.
+  static atomic_bool hlc_trace_active;
+  static atomic_ulong hlc_trace_next_id = 1;
+
+  static FILE* hlc_trace_file;
+  static unsigned long long hlc_trace_salt;
+  static bool hlc_trace_failed;
+
+
+  static void hlc_trace_initialize(void) {
+    hlc_trace_mutex_ok = mtx_init(&hlc_trace_mutex, mtx_plain) == thrd_success;
+  }
+
+
+  unsigned long hlc_trace_new_id(void) {
+    // Identifiers are encoded on 32 bits.
+    return atomic_fetch_add_explicit(&hlc_trace_next_id, 1, memory_order_relaxed) & 0xFFFFFFFFUL;
+  }
+
+
+  /// @brief Hashes bytes with FNV-1a, then mixes the result with the splitmix64 finalizer, since FNV-1a alone leaves
+  /// the high bits of short keys poorly mixed.
+  static unsigned long long hlc_trace_hash(const void* key, size_t key_size, unsigned long long salt) {
+    const unsigned char* bytes = key;
+    unsigned long long hash = 0xCBF29CE484222325ULL ^ salt;
+
+    for (size_t i = 0; i < key_size; ++i) {
+      hash ^= bytes[i];
+      hash *= 0x100000001B3ULL;
+    }
+
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBULL;
+    hash ^= hash >> 31;
+    return hash;
+  }
+
+
+  static void hlc_trace_write(
+    hlc_Trace_operation operation,
+    hlc_Trace_container container,
+    unsigned long container_id,
+    const void* key,
+    size_t key_size,
+    unsigned long long number
+  ) {
+    mtx_lock(&hlc_trace_mutex);
+
+    if (hlc_trace_file != NULL) {
+      unsigned char bytes[HLC_TRACE_RECORD_SIZE] = {(unsigned char)operation, (unsigned char)container, 0, 0};
+      hlc_trace_encode_u32(bytes + 4, container_id);
+      hlc_trace_encode_u64(bytes + 8, key != NULL ? hlc_trace_hash(key, key_size, hlc_trace_salt) : number);
+
+      if (fwrite(bytes, sizeof(bytes), 1, hlc_trace_file) != 1) {
+        hlc_trace_failed = true;
+      }
+    }
+
+    mtx_unlock(&hlc_trace_mutex);
+  }
+
+
+  void hlc_trace_record(
+    hlc_Trace_operation operation,
+    hlc_Trace_container container,
+    unsigned long container_id,
+    const void* key,
+    size_t key_size
+  ) {
+    if (atomic_load_explicit(&hlc_trace_active, memory_order_relaxed)) {
+      hlc_trace_write(operation, container, container_id, key, key_size, 0);
+    }
+  }
+
+
+  void hlc_trace_record_number(
+    hlc_Trace_operation operation,
+    hlc_Trace_container container,
+    unsigned long container_id,
+    unsigned long long key
+  ) {
+    if (atomic_load_explicit(&hlc_trace_active, memory_order_relaxed)) {
+      hlc_trace_write(operation, container, container_id, NULL, 0, key);
+    }
+  }
+#endif
+
+
+bool hlc_trace_start(const char* path, unsigned long long salt) {
+  assert(path != NULL);
+
+  #ifdef HLC_TRACE
+    call_once(&hlc_trace_once, hlc_trace_initialize);
+
+    if (!hlc_trace_mutex_ok)
+      return false;
+
+    mtx_lock(&hlc_trace_mutex);
+    bool success = false;
+
+    if (hlc_trace_file == NULL) {
+      hlc_trace_file = fopen(path, "wb");
+
+      if (hlc_trace_file != NULL) {
+        unsigned char header[HLC_TRACE_HEADER_SIZE] = {0};
+        memcpy(header, hlc_trace_magic, sizeof(hlc_trace_magic));
+        hlc_trace_encode_u32(header + 8, HLC_TRACE_VERSION);
+
+        if (fwrite(header, sizeof(header), 1, hlc_trace_file) == 1) {
+          hlc_trace_salt = salt;
+          hlc_trace_failed = false;
+          atomic_store(&hlc_trace_active, true);
+          success = true;
+        } else {
+          fclose(hlc_trace_file);
+          hlc_trace_file = NULL;
+        }
+      }
+    }
+
+    mtx_unlock(&hlc_trace_mutex);
+    return success;
+  #else
+    (void)path;
+    (void)salt;
+    return false;
+  #endif
+}
+
+
+bool hlc_trace_stop(void) {
+  #ifdef HLC_TRACE
+    call_once(&hlc_trace_once, hlc_trace_initialize);
+
+    if (!hlc_trace_mutex_ok)
+      return false;
+
+    mtx_lock(&hlc_trace_mutex);
+    bool success = false;
+
+    if (hlc_trace_file != NULL) {
+      atomic_store(&hlc_trace_active, false);
+      success = fclose(hlc_trace_file) == 0 && !hlc_trace_failed;
+      hlc_trace_file = NULL;
+    }
+
+    mtx_unlock(&hlc_trace_mutex);
+    return success;
+  #else
+    return false;
+  #endif
+}
@@ -0,0 +1,102 @@
+#ifndef HLC_TRACE_H
+#define HLC_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+
+HLC_DECLARATIONS_BEGIN
+
+/// @brief The size of the header starting every trace: the magic "HLCTRACE" followed by the version as a 32-bit
+/// little endian integer and 4 reserved bytes.
+#define HLC_TRACE_HEADER_SIZE 16
+
+/// @brief The size of an encoded hlc_Trace_record: the operation, the container kind, 2 reserved bytes, the container
+/// identifier as a 32-bit little endian integer and the key as a 64-bit little endian integer.
+#define HLC_TRACE_RECORD_SIZE 16
+
+#define HLC_TRACE_VERSION 1
+
+typedef enum hlc_Trace_operation {
+  HLC_TRACE_CREATE = 1,
+  HLC_TRACE_DESTROY,
+  HLC_TRACE_CLONE,
+  HLC_TRACE_INSERT,
+  HLC_TRACE_REMOVE,
+  HLC_TRACE_LOOKUP,
+  HLC_TRACE_ITERATE,
+} hlc_Trace_operation;
+
+typedef enum hlc_Trace_container {
+  HLC_TRACE_SET = 1,
+  HLC_TRACE_MAP,
+} hlc_Trace_container;
+
+/// @brief An operation performed on a container.
+/// @details The key is a salted hash of the bytes of the key given to the operation, so equal keys map to equal hashes
+/// within a trace while the keys themselves can't be recovered. Keys containing pointers or padding hash by those bytes
+/// as well. For HLC_TRACE_CLONE, the key is the identifier of the cloned container. Iterations are recorded when they
+/// start, so replays walk whole containers.
+typedef struct hlc_Trace_record {
+  hlc_Trace_operation operation;
+  hlc_Trace_container container;
+  unsigned long container_id;
+  unsigned long long key;
+} hlc_Trace_record;
+
+/// @brief Starts recording the operations of all sets and maps into a new trace file.
+/// @param salt The salt mixed into key hashes. Keep it secret to prevent guessing keys from their hashes.
+/// @return true on success, or false if HLC_TRACE is not defined, a trace is already being recorded, or the file can't
+/// be written.
+/// @pre path != NULL
+HLC_API bool hlc_trace_start(const char* path, unsigned long long salt);
+
+/// @brief Stops recording operations and closes the trace file.
+/// @return true on success, or false if no trace was being recorded or some records couldn't be written.
+HLC_API bool hlc_trace_stop(void);
+
+/// @brief Checks the header of a trace.
+/// @pre bytes != NULL
+HLC_API bool hlc_trace_decode_header(const unsigned char bytes[HLC_TRACE_HEADER_SIZE]);
+
+/// @brief Decodes a record of a trace.
+/// @return true on success, or false if the record is malformed.
+/// @pre bytes != NULL && record != NULL
+HLC_API bool hlc_trace_decode_record(const unsigned char bytes[HLC_TRACE_RECORD_SIZE], hlc_Trace_record* record);
+
+#ifdef HLC_TRACE
+  /// @brief Returns a new container identifier, unique within the process.
+  HLC_API unsigned long hlc_trace_new_id(void);
+
+  /// @brief Records an operation, if a trace is being recorded.
+  HLC_API void hlc_trace_record(
+    hlc_Trace_operation operation,
+    hlc_Trace_container container,
+    unsigned long container_id,
+    const void* key,
+    size_t key_size
+  );
+
+  /// @brief Records an operation whose key is a plain number rather than bytes to hash.
+  HLC_API void hlc_trace_record_number(
+    hlc_Trace_operation operation,
+    hlc_Trace_container container,
+    unsigned long container_id,
+    unsigned long long key
+  );
+
+  #define HLC_TRACE_NEW_ID() hlc_trace_new_id()
+  #define HLC_TRACE_RECORD(operation, container, container_id, key, key_size) \
+    hlc_trace_record((operation), (container), (container_id), (key), (key_size))
+  #define HLC_TRACE_RECORD_NUMBER(operation, container, container_id, key) \
+    hlc_trace_record_number((operation), (container), (container_id), (key))
+#else
+  #define HLC_TRACE_NEW_ID() 0UL
+  #define HLC_TRACE_RECORD(operation, container, container_id, key, key_size) ((void)0)
+  #define HLC_TRACE_RECORD_NUMBER(operation, container, container_id, key) ((void)0)
+#endif
+
+HLC_DECLARATIONS_END
+
+#endif
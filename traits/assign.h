@@ -4,6 +4,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 #include <wchar.h>
 
 #include "../api.h"
@@ -13,6 +14,10 @@ HLC_DECLARATIONS_BEGIN
 typedef struct hlc_Assign_trait {
   bool (*assign)(void* target, const void* source, const struct hlc_Assign_trait* trait, void* context);
   bool (*reassign)(void* target, const void* source, const struct hlc_Assign_trait* trait, void* context);
+
+  /// @brief Whether assign and reassign merely copy the bytes of the source, which can't fail. Containers may then copy
+  /// elements with memcpy, see hlc_assign_sized, and reassign them without backing them up first.
+  bool trivial;
 } hlc_Assign_trait;
 
 typedef struct hlc_Assign_instance {
@@ -28,6 +33,27 @@ static inline bool hlc_reassign(void* target, const void* source, hlc_Assign_ins
   return instance.trait->reassign(target, source, instance.trait, instance.context);
 }
 
+/// @brief Assigns like hlc_assign, but copies the given number of bytes instead of calling the trait if it's trivial.
+static inline bool hlc_assign_sized(void* target, const void* source, size_t size, hlc_Assign_instance instance) {
+  if (instance.trait->trivial) {
+    memcpy(target, source, size);
+    return true;
+  }
+
+  return hlc_assign(target, source, instance);
+}
+
+/// @brief Reassigns like hlc_reassign, but copies the given number of bytes instead of calling the trait if it's
+/// trivial.
+static inline bool hlc_reassign_sized(void* target, const void* source, size_t size, hlc_Assign_instance instance) {
+  if (instance.trait->trivial) {
+    memcpy(target, source, size);
+    return true;
+  }
+
+  return hlc_reassign(target, source, instance);
+}
+
 #define HLC_DECLARE_PRIMITIVE_ASSIGN_INSTANCE(t_name, t) const hlc_Assign_instance hlc_##t_name##_assign_instance
 
 #define HLC_DEFINE_PRIMITIVE_ASSIGN_INSTANCE(t_name, t)         \
@@ -68,6 +94,7 @@ static inline bool hlc_reassign(void* target, const void* source, hlc_Assign_ins
   static const hlc_Assign_trait hlc_##t_name##_assign_trait = { \
     .assign = hlc_##t_name##_assign,                            \
     .reassign = hlc_##t_name##_reassign,                        \
+    .trivial = true,                                            \
   };                                                            \
                                                                 \
   const hlc_Assign_instance hlc_##t_name##_assign_instance = {  \
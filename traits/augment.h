@@ -0,0 +1,41 @@
+#ifndef HLC_TRAITS_AUGMENT_H
+#define HLC_TRAITS_AUGMENT_H
+
+#include <stdbool.h>
+
+#include "../api.h"
+
+HLC_DECLARATIONS_BEGIN
+
+typedef struct hlc_Augment_trait {
+  /// @brief Recomputes the data an element holds about its subtree, such as the maximum of some field over it, from
+  /// the element itself and the elements of its children, which are NULL for missing children.
+  /// @details The data must only depend on the element and on the data of its children, so that it can be kept
+  /// current by updating the elements whose subtrees changed, from the bottom up.
+  /// @return true if the data changed, false if it was already current.
+  bool (*update)(
+    void* element,
+    const void* left,
+    const void* right,
+    const struct hlc_Augment_trait* trait,
+    void* context
+  );
+} hlc_Augment_trait;
+
+typedef struct hlc_Augment_instance {
+  const hlc_Augment_trait* trait;
+  void* context;
+} hlc_Augment_instance;
+
+static inline bool hlc_augment_update(
+  void* element,
+  const void* left,
+  const void* right,
+  hlc_Augment_instance instance
+) {
+  return instance.trait->update(element, left, right, instance.trait, instance.context);
+}
+
+HLC_DECLARATIONS_END
+
+#endif
@@ -1,8 +1,134 @@
 #include "compare.h"
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <wchar.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+
+  #define HLC_COMPARE_SSE2
+#endif
+
+#if defined(__SSE4_2__)
+  #include <nmmintrin.h>
+
+  #define HLC_COMPARE_SSE42
+#endif
+
+
+#ifdef HLC_COMPARE_SSE2
+
+/// @brief Returns the position of the lowest clear bit of a mask of 16 bits, which isn't 0xFFFF.
+static size_t hlc_compare_first_clear(unsigned mask) {
+  #if defined(__GNUC__)
+    return (size_t)__builtin_ctz(~mask);
+  #else
+    size_t i = 0;
+
+    while ((mask & 1) != 0) {
+      mask >>= 1;
+      i += 1;
+    }
+
+    return i;
+  #endif
+}
+
+#endif
+
+
+// Each width gets a function, which biases unsigned integers by flipping their sign bit so that all comparisons are
+// signed ones, as SSE2 only has those. Vectors of elements are then compared with the broadcast probe until one of the
+// elements isn't less than it: its lanes are the first clear bits of the mask. The last elements are compared one by
+// one, as are all of them without SSE2 (or 64-bit ones without SSE4.2).
+
+#define HLC_DEFINE_COMPARE_MANY(bits, t, bias_value, vectors, set1, cmpgt)    \
+  static size_t hlc_compare_many_##bits(                                      \
+    const void* x,                                                            \
+    const unsigned char* ys,                                                  \
+    size_t count,                                                             \
+    bool is_signed                                                            \
+  ) {                                                                         \
+    t bias = is_signed ? 0 : (bias_value);                                    \
+    t probe;                                                                  \
+    memcpy(&probe, x, sizeof(probe));                                         \
+    probe ^= bias;                                                            \
+                                                                              \
+    size_t i = 0;                                                             \
+                                                                              \
+    vectors(t, set1, cmpgt)                                                   \
+                                                                              \
+    for (; i < count; ++i) {                                                  \
+      t y;                                                                    \
+      memcpy(&y, ys + i * sizeof(y), sizeof(y));                              \
+                                                                              \
+      if (probe <= (t)(y ^ bias))                                             \
+        return i;                                                             \
+    }                                                                         \
+                                                                              \
+    return count;                                                             \
+  }
+
+#ifdef HLC_COMPARE_SSE2
+  #define HLC_COMPARE_MANY_VECTORS(t, set1, cmpgt)                         \
+    __m128i bias_vector = set1(bias);                                      \
+    __m128i probe_vector = set1(probe);                                    \
+                                                                           \
+    for (; i + 16 / sizeof(t) <= count; i += 16 / sizeof(t)) {             \
+      __m128i y = _mm_loadu_si128((const __m128i*)(ys + i * sizeof(t)));   \
+      y = _mm_xor_si128(y, bias_vector);                                   \
+      unsigned mask = (unsigned)_mm_movemask_epi8(cmpgt(probe_vector, y)); \
+                                                                           \
+      if (mask != 0xFFFF)                                                  \
+        return i + hlc_compare_first_clear(mask) / sizeof(t);              \
+    }
+#else
+  #define HLC_COMPARE_MANY_VECTORS(t, set1, cmpgt)
+#endif
+
+#define HLC_COMPARE_MANY_SCALAR(t, set1, cmpgt)
+
+#ifdef HLC_COMPARE_SSE42
+
+static __m128i hlc_compare_set1_64(int64_t x) {
+  return _mm_set_epi32((int)(x >> 32), (int)x, (int)(x >> 32), (int)x);
+}
+
+#endif
+
+#ifdef HLC_COMPARE_SSE42
+  #define HLC_COMPARE_MANY_VECTORS_64 HLC_COMPARE_MANY_VECTORS
+#else
+  #define HLC_COMPARE_MANY_VECTORS_64 HLC_COMPARE_MANY_SCALAR
+#endif
+
+HLC_DEFINE_COMPARE_MANY(8, int8_t, INT8_MIN, HLC_COMPARE_MANY_VECTORS, _mm_set1_epi8, _mm_cmpgt_epi8)
+HLC_DEFINE_COMPARE_MANY(16, int16_t, INT16_MIN, HLC_COMPARE_MANY_VECTORS, _mm_set1_epi16, _mm_cmpgt_epi16)
+HLC_DEFINE_COMPARE_MANY(32, int32_t, INT32_MIN, HLC_COMPARE_MANY_VECTORS, _mm_set1_epi32, _mm_cmpgt_epi32)
+HLC_DEFINE_COMPARE_MANY(64, int64_t, INT64_MIN, HLC_COMPARE_MANY_VECTORS_64, hlc_compare_set1_64, _mm_cmpgt_epi64)
+
+
+size_t hlc_compare_many_integers(const void* x, const void* ys, size_t count, size_t size, bool is_signed) {
+  assert(x != NULL);
+  assert(ys != NULL || count == 0);
+
+  switch (size) {
+  case 1:
+    return hlc_compare_many_8(x, ys, count, is_signed);
+  case 2:
+    return hlc_compare_many_16(x, ys, count, is_signed);
+  case 4:
+    return hlc_compare_many_32(x, ys, count, is_signed);
+  default:
+    assert(size == 8);
+    return hlc_compare_many_64(x, ys, count, is_signed);
+  }
+}
+
+
 HLC_DEFINE_PRIMITIVE_COMPARE_INSTANCE(schar, signed char);
 HLC_DEFINE_PRIMITIVE_COMPARE_INSTANCE(short, short);
 HLC_DEFINE_PRIMITIVE_COMPARE_INSTANCE(int, int);
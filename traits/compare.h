@@ -2,6 +2,7 @@
 #define HLC_TRAITS_COMPARE_H
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <wchar.h>
 
@@ -11,6 +12,20 @@ HLC_DECLARATIONS_BEGIN
 
 typedef struct hlc_Compare_trait {
   signed char (*compare)(const void* x, const void* y, const struct hlc_Compare_trait* trait, void* context);
+
+  /// @brief Optionally maps elements to 64-bit prefixes, such that prefix(x) < prefix(y) implies compare(x, y) < 0
+  /// (so equal elements have equal prefixes). Containers may cache prefixes and only call compare when they're equal.
+  unsigned long long (*prefix)(const void* x, const struct hlc_Compare_trait* trait, void* context);
+
+  /// @brief Optionally compares an element with count contiguous elements at once, returning the index of the first
+  /// one which is not less than it (compare(x, ys[i]) <= 0), or count if there's none. See hlc_compare_many.
+  size_t (*compare_many)(
+    const void* x,
+    const void* ys,
+    size_t count,
+    const struct hlc_Compare_trait* trait,
+    void* context
+  );
 } hlc_Compare_trait;
 
 typedef struct hlc_Compare_instance {
@@ -22,32 +37,93 @@ static inline signed char hlc_compare(const void* x, const void* y, hlc_Compare_
   return instance.trait->compare(x, y, instance.trait, instance.context);
 }
 
+static inline unsigned long long hlc_compare_prefix(const void* x, hlc_Compare_instance instance) {
+  assert(instance.trait->prefix != NULL);
+  return instance.trait->prefix(x, instance.trait, instance.context);
+}
+
+/// @brief Returns the index of the first of count contiguous elements, each taking y_size bytes, which is not less than
+/// x, or count if there's none. Uses the compare_many hook if there's one, with a single indirect call, and otherwise
+/// calls compare on each element in turn. On sorted elements, this is their lower bound.
+/// @pre ys != NULL || count == 0
+static inline size_t hlc_compare_many(
+  const void* x,
+  const void* ys,
+  size_t count,
+  size_t y_size,
+  hlc_Compare_instance instance
+) {
+  assert(ys != NULL || count == 0);
+
+  if (instance.trait->compare_many != NULL)
+    return instance.trait->compare_many(x, ys, count, instance.trait, instance.context);
+
+  for (size_t i = 0; i < count; ++i) {
+    if (hlc_compare(x, (const char*)ys + i * y_size, instance) <= 0)
+      return i;
+  }
+
+  return count;
+}
+
+/// @brief Implements compare_many for integers of the given size (1, 2, 4 or 8 bytes) and signedness, comparing
+/// 16 bytes of elements at once with SSE2 where available. Used by the primitive instances below.
+/// @pre (ys != NULL || count == 0) && (size == 1 || size == 2 || size == 4 || size == 8)
+HLC_API size_t hlc_compare_many_integers(const void* x, const void* ys, size_t count, size_t size, bool is_signed);
+
+/// @brief Packs the first 8 bytes of a byte string into a prefix ordered like memcmp: the first byte is the most
+/// significant one, and bytes past the end count as 0. This suits prefix hooks of string traits.
+/// @pre bytes != NULL || size == 0
+static inline unsigned long long hlc_compare_bytes_prefix(const void* bytes, size_t size) {
+  const unsigned char* x = bytes;
+  unsigned long long prefix = 0;
+
+  for (size_t i = 0; i < 8; ++i) {
+    prefix = prefix << 8 | (i < size ? x[i] : 0);
+  }
+
+  return prefix;
+}
+
 #define HLC_DECLARE_PRIMITIVE_COMPARE_INSTANCE(t_name, t) const hlc_Compare_instance hlc_##t_name##_compare_instance
 
-#define HLC_DEFINE_PRIMITIVE_COMPARE_INSTANCE(t_name, t)          \
-  static signed char hlc_##t_name##_compare(                      \
-    const void* _x,                                               \
-    const void* _y,                                               \
-    const hlc_Compare_trait* trait,                               \
-    void* context                                                 \
-  ) {                                                             \
-    const t* x = _x;                                              \
-    const t* y = _y;                                              \
-    (void)trait;                                                  \
-    (void)context;                                                \
-                                                                  \
-    assert(x != NULL);                                            \
-    assert(y != NULL);                                            \
-    return *x < *y ? -1 : *x > *y ? +1 : 0;                       \
-  }                                                               \
-                                                                  \
-  static const hlc_Compare_trait hlc_##t_name##_compare_trait = { \
-    .compare = hlc_##t_name##_compare,                            \
-  };                                                              \
-                                                                  \
-  const hlc_Compare_instance hlc_##t_name##_compare_instance = {  \
-    .trait = &hlc_##t_name##_compare_trait,                       \
-    .context = NULL,                                              \
+#define HLC_DEFINE_PRIMITIVE_COMPARE_INSTANCE(t_name, t)                     \
+  static signed char hlc_##t_name##_compare(                                 \
+    const void* _x,                                                          \
+    const void* _y,                                                          \
+    const hlc_Compare_trait* trait,                                          \
+    void* context                                                            \
+  ) {                                                                        \
+    const t* x = _x;                                                         \
+    const t* y = _y;                                                         \
+    (void)trait;                                                             \
+    (void)context;                                                           \
+                                                                             \
+    assert(x != NULL);                                                       \
+    assert(y != NULL);                                                       \
+    return *x < *y ? -1 : *x > *y ? +1 : 0;                                  \
+  }                                                                          \
+                                                                             \
+  static size_t hlc_##t_name##_compare_many(                                 \
+    const void* x,                                                           \
+    const void* ys,                                                          \
+    size_t count,                                                            \
+    const hlc_Compare_trait* trait,                                          \
+    void* context                                                            \
+  ) {                                                                        \
+    (void)trait;                                                             \
+    (void)context;                                                           \
+    return hlc_compare_many_integers(x, ys, count, sizeof(t), (t)-1 < (t)1); \
+  }                                                                          \
+                                                                             \
+  static const hlc_Compare_trait hlc_##t_name##_compare_trait = {            \
+    .compare = hlc_##t_name##_compare,                                       \
+    .compare_many = hlc_##t_name##_compare_many,                             \
+  };                                                                         \
+                                                                             \
+  const hlc_Compare_instance hlc_##t_name##_compare_instance = {             \
+    .trait = &hlc_##t_name##_compare_trait,                                  \
+    .context = NULL,                                                         \
   }
 
 extern HLC_API HLC_DECLARE_PRIMITIVE_COMPARE_INSTANCE(schar, signed char);
@@ -1,5 +1,6 @@
 #include "destroy.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 
 static void hlc_no_destroy(void* target, const struct hlc_Destroy_trait* trait, void* context) {
@@ -10,6 +11,7 @@ static void hlc_no_destroy(void* target, const struct hlc_Destroy_trait* trait,
 
 static const hlc_Destroy_trait hlc_no_destroy_trait = {
   .destroy = hlc_no_destroy,
+  .trivial = true,
 };
 
 const hlc_Destroy_instance hlc_no_destroy_instance = {
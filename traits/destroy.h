@@ -1,12 +1,18 @@
 #ifndef HLC_TRAITS_DESTROY_H
 #define HLC_TRAITS_DESTROY_H
 
+#include <stdbool.h>
+
 #include "../api.h"
 
 HLC_DECLARATIONS_BEGIN
 
 typedef struct hlc_Destroy_trait {
   void (*destroy)(void* target, const struct hlc_Destroy_trait* trait, void* context);
+
+  /// @brief Whether destroy does nothing. hlc_destroy then skips the call, and containers may skip visiting elements
+  /// which they only visit to destroy them.
+  bool trivial;
 } hlc_Destroy_trait;
 
 typedef struct hlc_Destroy_instance {
@@ -15,7 +21,9 @@ typedef struct hlc_Destroy_instance {
 } hlc_Destroy_instance;
 
 static inline void hlc_destroy(void* target, hlc_Destroy_instance instance) {
-  instance.trait->destroy(target, instance.trait, instance.context);
+  if (!instance.trait->trivial) {
+    instance.trait->destroy(target, instance.trait, instance.context);
+  }
 }
 
 extern HLC_API const hlc_Destroy_instance hlc_no_destroy_instance;
@@ -0,0 +1,42 @@
+#ifndef HLC_TRAITS_REDUCE_H
+#define HLC_TRAITS_REDUCE_H
+
+#include <stdbool.h>
+
+#include "../api.h"
+
+HLC_DECLARATIONS_BEGIN
+
+typedef struct hlc_Reduce_trait {
+  /// @brief Initializes an empty accumulator.
+  /// @return true on success, false on insufficient memory.
+  bool (*initialize)(void* accumulator, const struct hlc_Reduce_trait* trait, void* context);
+
+  /// @brief Adds an element to an accumulator.
+  void (*accumulate)(void* accumulator, const void* element, const struct hlc_Reduce_trait* trait, void* context);
+
+  /// @brief Merges other, which covers elements following those covered by accumulator, into accumulator. The other
+  /// accumulator must be left destroyed.
+  void (*combine)(void* accumulator, void* other, const struct hlc_Reduce_trait* trait, void* context);
+} hlc_Reduce_trait;
+
+typedef struct hlc_Reduce_instance {
+  const hlc_Reduce_trait* trait;
+  void* context;
+} hlc_Reduce_instance;
+
+static inline bool hlc_reduce_initialize(void* accumulator, hlc_Reduce_instance instance) {
+  return instance.trait->initialize(accumulator, instance.trait, instance.context);
+}
+
+static inline void hlc_reduce_accumulate(void* accumulator, const void* element, hlc_Reduce_instance instance) {
+  instance.trait->accumulate(accumulator, element, instance.trait, instance.context);
+}
+
+static inline void hlc_reduce_combine(void* accumulator, void* other, hlc_Reduce_instance instance) {
+  instance.trait->combine(accumulator, other, instance.trait, instance.context);
+}
+
+HLC_DECLARATIONS_END
+
+#endif
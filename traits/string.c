@@ -0,0 +1,244 @@
+#include "string.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static signed char hlc_cstring_compare(const void* _x, const void* _y, const hlc_Compare_trait* trait, void* context) {
+  const char* const* x = _x;
+  const char* const* y = _y;
+  (void)trait;
+  (void)context;
+
+  assert(x != NULL && *x != NULL);
+  assert(y != NULL && *y != NULL);
+
+  // Interned strings are equal exactly when they're the same copy.
+  if (*x == *y)
+    return 0;
+
+  int ordering = strcmp(*x, *y);
+  return ordering < 0 ? -1 : ordering > 0 ? +1 : 0;
+}
+
+
+static unsigned long long hlc_cstring_prefix(const void* _x, const hlc_Compare_trait* trait, void* context) {
+  const char* const* x = _x;
+  (void)trait;
+  (void)context;
+
+  assert(x != NULL && *x != NULL);
+
+  size_t size = 0;
+
+  while (size < 8 && (*x)[size] != '\0') {
+    size += 1;
+  }
+
+  return hlc_compare_bytes_prefix(*x, size);
+}
+
+
+static const hlc_Compare_trait hlc_cstring_compare_trait = {
+  .compare = hlc_cstring_compare,
+  .prefix = hlc_cstring_prefix,
+};
+
+const hlc_Compare_instance hlc_cstring_compare_instance = {
+  .trait = &hlc_cstring_compare_trait,
+  .context = NULL,
+};
+
+
+static bool hlc_cstring_assign(void* _target, const void* _source, const hlc_Assign_trait* trait, void* context) {
+  const char** target = _target;
+  const char* const* source = _source;
+  (void)trait;
+  (void)context;
+
+  assert(target != NULL);
+  assert(source != NULL && *source != NULL);
+
+  size_t size = strlen(*source) + 1;
+  char* copy = malloc(size);
+
+  if (copy == NULL)
+    return false;
+
+  memcpy(copy, *source, size);
+  *target = copy;
+  return true;
+}
+
+
+static bool hlc_cstring_reassign(void* _target, const void* _source, const hlc_Assign_trait* trait, void* context) {
+  const char** target = _target;
+  const char* const* source = _source;
+
+  assert(target != NULL && *target != NULL);
+  assert(source != NULL && *source != NULL);
+
+  if (*target == *source || strcmp(*target, *source) == 0)
+    return true;
+
+  const char* old = *target;
+
+  if (!hlc_cstring_assign(target, source, trait, context))
+    return false;
+
+  free((void*)old);
+  return true;
+}
+
+
+static const hlc_Assign_trait hlc_cstring_assign_trait = {
+  .assign = hlc_cstring_assign,
+  .reassign = hlc_cstring_reassign,
+};
+
+const hlc_Assign_instance hlc_cstring_assign_instance = {
+  .trait = &hlc_cstring_assign_trait,
+  .context = NULL,
+};
+
+
+static void hlc_cstring_destroy(void* _target, const hlc_Destroy_trait* trait, void* context) {
+  const char** target = _target;
+  (void)trait;
+  (void)context;
+
+  assert(target != NULL);
+  free((void*)*target);
+}
+
+
+static const hlc_Destroy_trait hlc_cstring_destroy_trait = {
+  .destroy = hlc_cstring_destroy,
+};
+
+const hlc_Destroy_instance hlc_cstring_destroy_instance = {
+  .trait = &hlc_cstring_destroy_trait,
+  .context = NULL,
+};
+
+
+static signed char hlc_bytes_compare(const void* _x, const void* _y, const hlc_Compare_trait* trait, void* context) {
+  const hlc_Bytes* x = _x;
+  const hlc_Bytes* y = _y;
+  (void)trait;
+  (void)context;
+
+  assert(x != NULL && (x->data != NULL || x->size == 0));
+  assert(y != NULL && (y->data != NULL || y->size == 0));
+
+  if (x->data != y->data) {
+    size_t size = x->size < y->size ? x->size : y->size;
+    int ordering = size > 0 ? memcmp(x->data, y->data, size) : 0;
+
+    if (ordering != 0)
+      return ordering < 0 ? -1 : +1;
+  }
+
+  return x->size < y->size ? -1 : x->size > y->size ? +1 : 0;
+}
+
+
+static unsigned long long hlc_bytes_prefix(const void* _x, const hlc_Compare_trait* trait, void* context) {
+  const hlc_Bytes* x = _x;
+  (void)trait;
+  (void)context;
+
+  assert(x != NULL);
+  return hlc_compare_bytes_prefix(x->data, x->size);
+}
+
+
+static const hlc_Compare_trait hlc_bytes_compare_trait = {
+  .compare = hlc_bytes_compare,
+  .prefix = hlc_bytes_prefix,
+};
+
+const hlc_Compare_instance hlc_bytes_compare_instance = {
+  .trait = &hlc_bytes_compare_trait,
+  .context = NULL,
+};
+
+
+static bool hlc_bytes_assign(void* _target, const void* _source, const hlc_Assign_trait* trait, void* context) {
+  hlc_Bytes* target = _target;
+  const hlc_Bytes* source = _source;
+  (void)trait;
+  (void)context;
+
+  assert(target != NULL);
+  assert(source != NULL && (source->data != NULL || source->size == 0));
+
+  void* copy = NULL;
+
+  if (source->size > 0) {
+    copy = malloc(source->size);
+
+    if (copy == NULL)
+      return false;
+
+    memcpy(copy, source->data, source->size);
+  }
+
+  target->size = source->size;
+  target->data = copy;
+  return true;
+}
+
+
+static bool hlc_bytes_reassign(void* _target, const void* _source, const hlc_Assign_trait* trait, void* context) {
+  hlc_Bytes* target = _target;
+  const hlc_Bytes* source = _source;
+
+  assert(target != NULL);
+  assert(source != NULL);
+
+  if (hlc_bytes_compare(target, source, NULL, NULL) == 0)
+    return true;
+
+  const void* old = target->data;
+
+  if (!hlc_bytes_assign(target, source, trait, context))
+    return false;
+
+  free((void*)old);
+  return true;
+}
+
+
+static const hlc_Assign_trait hlc_bytes_assign_trait = {
+  .assign = hlc_bytes_assign,
+  .reassign = hlc_bytes_reassign,
+};
+
+const hlc_Assign_instance hlc_bytes_assign_instance = {
+  .trait = &hlc_bytes_assign_trait,
+  .context = NULL,
+};
+
+
+static void hlc_bytes_destroy(void* _target, const hlc_Destroy_trait* trait, void* context) {
+  hlc_Bytes* target = _target;
+  (void)trait;
+  (void)context;
+
+  assert(target != NULL);
+  free((void*)target->data);
+}
+
+
+static const hlc_Destroy_trait hlc_bytes_destroy_trait = {
+  .destroy = hlc_bytes_destroy,
+};
+
+const hlc_Destroy_instance hlc_bytes_destroy_instance = {
+  .trait = &hlc_bytes_destroy_trait,
+  .context = NULL,
+};
@@ -0,0 +1,44 @@
+#ifndef HLC_TRAITS_STRING_H
+#define HLC_TRAITS_STRING_H
+
+#include <stddef.h>
+
+#include "../api.h"
+#include "assign.h"
+#include "compare.h"
+#include "destroy.h"
+
+HLC_DECLARATIONS_BEGIN
+
+// Strings are stored in containers as pointers, and the instances below own the strings they point to: assigning
+// copies a string to the heap, and destroying frees it. Reassigning a string with an equal one keeps the existing copy,
+// so inserting a key which is already in a container doesn't allocate. See intern.h for instances which share copies.
+
+/// @brief A byte string given by its length, which may contain NUL bytes. Bytes compare like unsigned chars, and a
+/// string which is a prefix of another one compares lower.
+typedef struct hlc_Bytes {
+  size_t size;
+  const void* data;
+} hlc_Bytes;
+
+/// @brief Compares elements of type const char*, pointing to NUL-terminated strings, like strcmp. Has a prefix hook.
+extern HLC_API const hlc_Compare_instance hlc_cstring_compare_instance;
+
+/// @brief Assigns copies of NUL-terminated strings to elements of type const char*.
+extern HLC_API const hlc_Assign_instance hlc_cstring_assign_instance;
+
+/// @brief Frees the strings copied by hlc_cstring_assign_instance.
+extern HLC_API const hlc_Destroy_instance hlc_cstring_destroy_instance;
+
+/// @brief Compares elements of type hlc_Bytes, like memcmp followed by their sizes. Has a prefix hook.
+extern HLC_API const hlc_Compare_instance hlc_bytes_compare_instance;
+
+/// @brief Assigns hlc_Bytes pointing to copies of the given bytes. Copies of empty strings point nowhere.
+extern HLC_API const hlc_Assign_instance hlc_bytes_assign_instance;
+
+/// @brief Frees the bytes copied by hlc_bytes_assign_instance.
+extern HLC_API const hlc_Destroy_instance hlc_bytes_destroy_instance;
+
+HLC_DECLARATIONS_END
+
+#endif